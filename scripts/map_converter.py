@@ -2,13 +2,23 @@
 """
 ENCOM-64 Map Data Converter
 Converts JSON map data from ENCOM API to C header files for N64 ROM.
+
+The input is stream-parsed in two passes (ids and coordinates, then
+connections), so memory and time stay linear in the hexagon count. With
+--blob the hexagon records go to a binary file loaded at runtime by
+map_loader.c, and the header only carries metadata and types.
+
+Lighting is baked here too (bake_corner_light): one byte per hexagon corner,
+so the renderer only looks colours up.
 """
 
 import json
+import os
+import struct
 import sys
 import argparse
-from typing import Dict, List, Any
-import hashlib
+from typing import Dict, Any
+from array import array
 
 
 def hash_string(s: str) -> int:
@@ -32,69 +42,278 @@ def convert_hex_coordinate(hex_data: Dict[str, Any]) -> tuple:
     """Convert hex coordinate to fixed-point position"""
     q = hex_data.get('q', 0)
     r = hex_data.get('r', 0)
-    
+
     # From ENCOM-DUNGEON hexUtils.ts
     HEX_SIZE = 25
     SQRT3_2 = 0.866025404
     SQRT3 = 1.732050808
-    
+
     x = HEX_SIZE * (1.5 * q)
     z = HEX_SIZE * (SQRT3_2 * q + SQRT3 * r)
-    
+
     # Convert to 16.16 fixed-point
     x_fixed = int(x * 65536)
     z_fixed = int(z * 65536)
-    
+
     return x_fixed, z_fixed
 
 
-def analyze_connections(hexagons: List[Dict[str, Any]]) -> Dict[str, int]:
-    """Build connection bitmasks for each hex"""
-    hex_map = {hex_data['id']: hex_data for hex_data in hexagons}
-    coord_map = {f"{hex_data['q']},{hex_data['r']}": hex_data for hex_data in hexagons}
-    
-    # Direction offsets for flat-top hex (from ENCOM-DUNGEON)
-    directions = [
-        (1, 0),   # southeast
-        (1, -1),  # northeast  
-        (0, -1),  # north
-        (-1, 0),  # northwest
-        (-1, 1),  # southwest
-        (0, 1),   # south
-    ]
-    
-    connection_masks = {}
-    
-    for hex_data in hexagons:
+# Direction offsets for flat-top hex (from ENCOM-DUNGEON), indexed by
+# connection bit: southeast, northeast, north, northwest, southwest, south
+DIRECTIONS = [(1, 0), (1, -1), (0, -1), (-1, 0), (-1, 1), (0, 1)]
+DIRECTION_BITS = {offset: i for i, offset in enumerate(DIRECTIONS)}
+
+# Binary map blob: header, then the hexagon fields as columns (big-endian
+# int16 q and r deltas from the previous hexagon, then one byte each for
+# type, height, connections and is_walkable, then the six corner lights).
+# Neighbouring hexagons have small deltas and runs of equal bytes, so the
+# blob compresses well.
+BLOB_MAGIC = b'EHEX'
+BLOB_VERSION = 3
+BLOB_HEADER = struct.Struct('>4sHHI')    # magic, version, bytes per hexagon, hex count
+BLOB_HEX_BYTES = 14
+
+# Game-space layout (hexagon.c): centre spacing; corner v lies between wall
+# directions v and v + 1, so it is shared with the neighbours that way
+HEX_SPACING_X = 75.0
+HEX_SPACING_Z = 86.6
+
+# Baked corner light (255 = full material colour): ambient, plus a light at
+# the centre of each room (connected room hexagons) whose reach grows with
+# the room, times ambient occlusion by the closed edges meeting at the corner
+LIGHT_AMBIENT_ROOM = 0.6
+LIGHT_AMBIENT_CORRIDOR = 0.6
+LIGHT_ROOM_PEAK = 0.55
+LIGHT_ROOM_RADIUS = 120.0
+LIGHT_ROOM_RADIUS_PER_HEX = 60.0        # Times the square root of the room's hexagon count
+LIGHT_OCCLUSION = (1.0, 0.9, 0.8, 0.72)  # By number of closed edges at the corner
+
+
+class JsonStream:
+    """Incremental JSON reader: decodes one value at a time from a file"""
+
+    def __init__(self, f, chunk_size: int = 1 << 16):
+        self.f = f
+        self.chunk_size = chunk_size
+        self.buf = ''
+        self.pos = 0
+        self.eof = False
+        self.decoder = json.JSONDecoder()
+
+    def _fill(self) -> bool:
+        data = self.f.read(self.chunk_size)
+        if not data:
+            self.eof = True
+            return False
+        self.buf = self.buf[self.pos:] + data
+        self.pos = 0
+        return True
+
+    def peek(self) -> str:
+        """Next non-whitespace character ('' at end of input)"""
+        while True:
+            while self.pos < len(self.buf) and self.buf[self.pos] in ' \t\r\n':
+                self.pos += 1
+            if self.pos < len(self.buf) or not self._fill():
+                return self.buf[self.pos] if self.pos < len(self.buf) else ''
+
+    def expect(self, char: str):
+        if self.peek() != char:
+            raise ValueError(f"expected '{char}' in map JSON")
+        self.pos += 1
+
+    def value(self):
+        """Decode the next complete value, reading more input as needed"""
+        self.peek()
+        while True:
+            try:
+                value, end = self.decoder.raw_decode(self.buf, self.pos)
+                # A number ending the buffer may continue in the next chunk
+                if end < len(self.buf) or self.eof or not self._fill():
+                    self.pos = end
+                    return value
+            except json.JSONDecodeError:
+                if not self._fill():
+                    raise
+
+    def items(self, on_hex):
+        """Walk the top-level object: hexagons are passed to on_hex one at a
+        time, everything else is returned as a dict (metadata etc.)"""
+        other = {}
+        self.expect('{')
+        if self.peek() == '}':
+            self.pos += 1
+            return other
+        while True:
+            key = self.value()
+            self.expect(':')
+            if key == 'hexagons':
+                self.expect('[')
+                if self.peek() != ']':
+                    while True:
+                        on_hex(self.value())
+                        if self.peek() != ',':
+                            break
+                        self.pos += 1
+                self.expect(']')
+            else:
+                other[key] = self.value()
+            if self.peek() != ',':
+                break
+            self.pos += 1
+        self.expect('}')
+        return other
+
+
+def stream_map(input_path: str, on_hex) -> Dict[str, Any]:
+    """Stream every hexagon of a map JSON file through on_hex; returns the other top-level keys"""
+    with open(input_path, 'r') as f:
+        return JsonStream(f).items(on_hex)
+
+
+class MapIndex:
+    """First pass: hexagon ids and coordinates in compact arrays"""
+
+    def __init__(self):
+        self.ids = {}           # id -> hexagon index
+        self.q = array('i')
+        self.r = array('i')
+
+    def add(self, hex_data: Dict[str, Any]):
+        self.ids[hex_data.get('id')] = len(self.q)
+        self.q.append(hex_data.get('q', 0))
+        self.r.append(hex_data.get('r', 0))
+
+    def __len__(self):
+        return len(self.q)
+
+    def connection_mask(self, index: int, hex_data: Dict[str, Any]) -> int:
+        """Bit d is set when a connected hexagon sits in direction d"""
         mask = 0
-        q, r = hex_data['q'], hex_data['r']
-        
-        for i, (dq, dr) in enumerate(directions):
-            neighbor_q = q + dq
-            neighbor_r = r + dr
-            neighbor_key = f"{neighbor_q},{neighbor_r}"
-            
-            if neighbor_key in coord_map:
-                neighbor = coord_map[neighbor_key]
-                if neighbor['id'] in hex_data.get('connections', []):
-                    mask |= (1 << i)
-        
-        connection_masks[hex_data['id']] = mask
-    
-    return connection_masks
-
-
-def generate_header(json_data: Dict[str, Any], output_path: str):
-    """Generate C header file from JSON map data"""
-    
-    hexagons = json_data.get('hexagons', [])
-    metadata = json_data.get('metadata', {})
-    
+        q, r = self.q[index], self.r[index]
+        for neighbor_id in hex_data.get('connections', []):
+            neighbor = self.ids.get(neighbor_id)
+            if neighbor is None:
+                continue
+            bit = DIRECTION_BITS.get((self.q[neighbor] - q, self.r[neighbor] - r))
+            if bit is not None:
+                mask |= (1 << bit)
+        return mask
+
+
+def hex_fields(index: int, hex_data: Dict[str, Any], map_index: MapIndex) -> tuple:
+    """Converted per-hex values shared by both output formats"""
+    hex_type = 1 if hex_data.get('type') == 'CORRIDOR' else 0
+    height = min(255, max(0, int(hex_data.get('height', 1) * 12)))  # Scale to 0-255
+    connections = map_index.connection_mask(index, hex_data)
+    is_walkable = 1 if hex_data.get('isWalkable', True) else 0
+    return hex_type, height, connections, is_walkable
+
+
+def hex_center(q: int, r: int) -> tuple:
+    """Game-space centre of a hexagon (as hexagon_init)"""
+    return HEX_SPACING_X * q, -HEX_SPACING_Z * (r + q * 0.5)
+
+
+def level_neighbors(map_index: MapIndex, heights: bytearray, connections: bytearray) -> list:
+    """Neighbour of every hexagon in each direction (None if none), across
+    levels as hexagon_neighbor: a hexagon's level is height / 12 - 1, a ramp
+    (height between levels) rises towards its connected neighbour one level
+    up that connects back, and the hexagon there leads back down onto it"""
+    count = len(map_index)
+    levels = [max(0, min(15, heights[i] // 12 - 1)) for i in range(count)]
+    cells = {(map_index.q[i], map_index.r[i], levels[i]): i for i in range(count)}
+
+    ramp_dir = [-1] * count
+    for i in range(count):
+        if heights[i] % 12 == 0:
+            continue
+        for d, (dq, dr) in enumerate(DIRECTIONS):
+            up = cells.get((map_index.q[i] + dq, map_index.r[i] + dr, levels[i] + 1))
+            if connections[i] & (1 << d) and up is not None and connections[up] & (1 << ((d + 3) % 6)):
+                ramp_dir[i] = d
+                break
+
+    neighbors = []
+    for i in range(count):
+        around = []
+        for d, (dq, dr) in enumerate(DIRECTIONS):
+            q, r = map_index.q[i] + dq, map_index.r[i] + dr
+            level = levels[i] + (ramp_dir[i] == d)
+            n = cells.get((q, r, level))
+            if n is None and level > 0:
+                n = cells.get((q, r, level - 1))
+                if n is not None and ramp_dir[n] != (d + 3) % 6:
+                    n = None
+            around.append(n)
+        neighbors.append(around)
+    return neighbors
+
+
+def bake_corner_light(map_index: MapIndex, types: bytearray, heights: bytearray, connections: bytearray) -> bytearray:
+    """Light of every hexagon corner (6 bytes per hexagon, corner order as
+    hexagon.c). A corner's value depends only on the three cells around it,
+    so every hexagon sharing the corner bakes the same byte (on one level;
+    beside a ramp the cells are taken across levels as the game does)."""
+    count = len(map_index)
+    neighbors = level_neighbors(map_index, heights, connections)
+
+    # Rooms: room hexagons joined through open edges, lit from their centroid
+    room_of = [-1] * count
+    rooms = []
+    for start in range(count):
+        if types[start] != 0 or room_of[start] >= 0:
+            continue
+        room_of[start] = len(rooms)
+        members = [start]
+        for i in members:
+            for d in range(6):
+                n = neighbors[i][d]
+                if n is not None and types[n] == 0 and room_of[n] < 0 and connections[i] & (1 << d):
+                    room_of[n] = len(rooms)
+                    members.append(n)
+        centers = [hex_center(map_index.q[i], map_index.r[i]) for i in members]
+        rooms.append((sum(x for x, _ in centers) / len(members), sum(z for _, z in centers) / len(members),
+                      LIGHT_ROOM_RADIUS + LIGHT_ROOM_RADIUS_PER_HEX * len(members) ** 0.5))
+
+    def is_open(a, b, d):
+        """An edge is open when both cells exist and either connects across it"""
+        if a is None or b is None:
+            return False
+        return bool(connections[a] & (1 << d) or connections[b] & (1 << ((d + 3) % 6)))
+
+    light = bytearray(count * 6)
+    for i in range(count):
+        q, r = map_index.q[i], map_index.r[i]
+        for v in range(6):
+            d1, d2 = v, (v + 1) % 6
+            n1, n2 = neighbors[i][d1], neighbors[i][d2]
+            closed = (not is_open(i, n1, d1)) + (not is_open(i, n2, d2)) + (not is_open(n1, n2, (v + 2) % 6))
+
+            # The corner is the centroid of the three cell centres (summed in
+            # a fixed order, so all three hexagons get the same position)
+            around = sorted([(q, r), (q + DIRECTIONS[d1][0], r + DIRECTIONS[d1][1]),
+                             (q + DIRECTIONS[d2][0], r + DIRECTIONS[d2][1])])
+            points = [hex_center(cq, cr) for cq, cr in around]
+            x = sum(px for px, _ in points) / 3.0
+            z = sum(pz for _, pz in points) / 3.0
+
+            touching = [c for c in (i, n1, n2) if c is not None]
+            value = LIGHT_AMBIENT_ROOM if any(types[c] == 0 for c in touching) else LIGHT_AMBIENT_CORRIDOR
+            lit = 0.0
+            for room in {room_of[c] for c in touching if room_of[c] >= 0}:
+                rx, rz, radius = rooms[room]
+                dist_sq = ((x - rx) ** 2 + (z - rz) ** 2) / (radius * radius)
+                if dist_sq < 1.0:
+                    lit = max(lit, LIGHT_ROOM_PEAK * (1.0 - dist_sq) ** 2)
+            value = min(1.0, (value + lit) * LIGHT_OCCLUSION[closed])
+            light[i * 6 + v] = int(value * 255.0 + 0.5)
+    return light
+
+
+def header_prologue(metadata: Dict[str, Any], hex_count: int, color_index: int) -> str:
     seed = metadata.get('seed', '')
-    color_index = get_color_index(seed)
-    connection_masks = analyze_connections(hexagons)
-    
-    header_content = f'''/*
+    return f'''/*
  * ENCOM-64 Generated Map Data
  * Auto-generated from API response - DO NOT EDIT
  */
@@ -106,9 +325,9 @@ def generate_header(json_data: Dict[str, Any], output_path: str):
 
 // Map metadata
 #define MAP_SEED "{seed}"
-#define MAP_HEX_COUNT {len(hexagons)}
+#define MAP_HEX_COUNT {hex_count}
 #define MAP_COLOR_INDEX {color_index}
-#define MAP_TOTAL_HEXAGONS {metadata.get('totalHexagons', len(hexagons))}
+#define MAP_TOTAL_HEXAGONS {metadata.get('totalHexagons', hex_count)}
 #define MAP_ROOMS {metadata.get('rooms', 0)}
 #define MAP_CORRIDORS {metadata.get('corridors', 0)}
 
@@ -137,37 +356,17 @@ typedef enum {{
 
 // Hex data structure
 typedef struct {{
-    int8_t q, r;              // Hex coordinates
+    int16_t q, r;             // Axial hex coordinates (generated maps exceed int8)
     int32_t x_fixed, z_fixed; // 16.16 fixed-point world position
     uint8_t type;             // hex_type_t
     uint8_t height;           // Height level (0-255)
     uint8_t connections;      // Connection bitmask
     uint8_t is_walkable;      // 0 or 1
 }} hex_t;
-
-// Map data array
-static const hex_t map_hexagons[MAP_HEX_COUNT] = {{
 '''
 
-    # Generate hex data
-    for i, hex_data in enumerate(hexagons):
-        q = hex_data.get('q', 0)
-        r = hex_data.get('r', 0)
-        x_fixed, z_fixed = convert_hex_coordinate(hex_data)
-        
-        hex_type = 1 if hex_data.get('type') == 'CORRIDOR' else 0
-        height = min(255, max(0, int(hex_data.get('height', 1) * 12)))  # Scale to 0-255
-        connections = connection_masks.get(hex_data['id'], 0)
-        is_walkable = 1 if hex_data.get('isWalkable', True) else 0
-        
-        header_content += f'''    {{ {q:2d}, {r:2d}, {x_fixed:8d}, {z_fixed:8d}, {hex_type}, {height:3d}, 0x{connections:02X}, {is_walkable} }}'''
-        
-        if i < len(hexagons) - 1:
-            header_content += ','
-        header_content += f'  // {hex_data.get("id", f"hex-{i}")}\n'
-    
-    header_content += '''};
 
+HEADER_EPILOGUE = '''
 // Color palette data (RGB565 format for N64)
 static const uint16_t color_palettes[5][3] = {
     // Green palette
@@ -189,13 +388,94 @@ static const uint16_t color_palettes[5][3] = {
 
 #endif // MAP_DATA_H
 '''
-    
-    # Write to file
-    with open(output_path, 'w') as f:
-        f.write(header_content)
-    
+
+
+def generate_header(input_path: str, output_path: str, blob_path: str = None):
+    """Generate C header file (and optional binary blob) from a map JSON file"""
+
+    # Pass 1: ids and coordinates (connections need every hexagon's position)
+    map_index = MapIndex()
+    metadata = stream_map(input_path, map_index.add).get('metadata', {})
+    hex_count = len(map_index)
+
+    seed = metadata.get('seed', '')
+    color_index = get_color_index(seed)
+
+    with open(output_path, 'w') as header:
+        header.write(header_prologue(metadata, hex_count, color_index))
+
+        # Pass 2: convert each hexagon (the header array is written straight
+        # out); the fields are also kept as columns for the lighting bake
+        index = 0
+        columns = [bytearray(hex_count) for _ in range(4)]
+
+        def collect_fields(hex_data):
+            nonlocal index
+            for column, value in zip(columns, hex_fields(index, hex_data, map_index)):
+                column[index] = value
+            index += 1
+
+        if blob_path:
+            header.write(f'''
+// Map data is loaded at runtime from the binary blob (see map_loader.h)
+#define MAP_BLOB_FILE "{os.path.basename(blob_path)}"
+extern hex_t map_hexagons[MAP_HEX_COUNT];
+extern uint8_t map_corner_light[MAP_HEX_COUNT][6];
+''')
+            stream_map(input_path, collect_fields)
+            light = bake_corner_light(map_index, columns[0], columns[1], columns[2])
+
+            with open(blob_path, 'wb') as blob:
+                blob.write(BLOB_HEADER.pack(BLOB_MAGIC, BLOB_VERSION, BLOB_HEX_BYTES, hex_count))
+                for coords in (map_index.q, map_index.r):
+                    # Deltas wrap at 16 bits (the loader adds them modulo 2^16)
+                    deltas = array('h', ((coords[i] - (coords[i - 1] if i else 0) + 0x8000) % 0x10000 - 0x8000
+                                         for i in range(hex_count)))
+                    if sys.byteorder == 'little':
+                        deltas.byteswap()
+                    blob.write(deltas.tobytes())
+                for column in columns:
+                    blob.write(column)
+                for corner in range(6):
+                    blob.write(light[corner::6])
+        else:
+            header.write('''
+// Map data array
+static const hex_t map_hexagons[MAP_HEX_COUNT] = {
+''')
+
+            def write_literal(hex_data):
+                i = index
+                collect_fields(hex_data)
+                q = hex_data.get('q', 0)
+                r = hex_data.get('r', 0)
+                x_fixed, z_fixed = convert_hex_coordinate(hex_data)
+                hex_type, height, connections, is_walkable = (column[i] for column in columns)
+
+                line = f'''    {{ {q:2d}, {r:2d}, {x_fixed:8d}, {z_fixed:8d}, {hex_type}, {height:3d}, 0x{connections:02X}, {is_walkable} }}'''
+                if i < hex_count - 1:
+                    line += ','
+                header.write(line + f'  // {hex_data.get("id", f"hex-{i}")}\n')
+
+            stream_map(input_path, write_literal)
+            header.write('};\n')
+
+            light = bake_corner_light(map_index, columns[0], columns[1], columns[2])
+            header.write('''
+// Baked light per hexagon corner (255 = full material colour)
+static const uint8_t map_corner_light[MAP_HEX_COUNT][6] = {
+''')
+            for i in range(hex_count):
+                values = ', '.join(f'{v:3d}' for v in light[i * 6:i * 6 + 6])
+                header.write(f'    {{ {values} }}' + (',\n' if i < hex_count - 1 else '\n'))
+            header.write('};\n')
+
+        header.write(HEADER_EPILOGUE)
+
     print(f"Generated map header: {output_path}")
-    print(f"  Hexagons: {len(hexagons)}")
+    if blob_path:
+        print(f"Generated map blob: {blob_path} ({BLOB_HEADER.size + hex_count * BLOB_HEX_BYTES} bytes)")
+    print(f"  Hexagons: {hex_count}")
     print(f"  Seed: {seed}")
     print(f"  Color Index: {color_index}")
 
@@ -204,17 +484,16 @@ def main():
     parser = argparse.ArgumentParser(description='Convert ENCOM map JSON to C header')
     parser.add_argument('input_json', help='Input JSON file from ENCOM API')
     parser.add_argument('output_header', help='Output C header file')
-    
+    parser.add_argument('--blob', metavar='MAP_BIN',
+                        help='Write hexagon records to this binary file instead of a C array')
+
     args = parser.parse_args()
-    
+
     try:
-        with open(args.input_json, 'r') as f:
-            json_data = json.load(f)
-        
-        generate_header(json_data, args.output_header)
-        
-    except FileNotFoundError:
-        print(f"ERROR: Input file '{args.input_json}' not found")
+        generate_header(args.input_json, args.output_header, args.blob)
+
+    except FileNotFoundError as e:
+        print(f"ERROR: File '{e.filename}' not found")
         sys.exit(1)
     except json.JSONDecodeError as e:
         print(f"ERROR: Invalid JSON in '{args.input_json}': {e}")
@@ -225,4 +504,4 @@ def main():
 
 
 if __name__ == '__main__':
-    main()
\ No newline at end of file
+    main()
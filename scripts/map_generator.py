@@ -0,0 +1,385 @@
+#!/usr/bin/env python3
+"""
+ENCOM-64 Offline Map Generator
+Generates seeded hex-grid dungeons in the ENCOM API JSON format, so large
+maps can be converted and benchmarked without network access.
+
+Layout: hexagonal rooms (ROOM hexes, fully connected inside) linked by
+winding corridors (CORRIDOR hexes, connected along their path). Rooms keep
+a one-hex margin from other geometry; corridors that run into another
+room join it, which creates loops.
+
+With --levels, each level is such a layout stacked on the one below
+(height = level + 1), and consecutive levels are joined by ramps: corridor
+hexes half a level up (height + 0.5), free on both levels, between a hex
+on the lower level and one on the upper level in line with it. Hexagons
+are written level by level, each level's ramps after it, as the game's
+per-level ranges expect.
+"""
+
+import argparse
+import json
+import random
+import sys
+
+# Axial direction offsets in connection-bit order (same as map_converter.py)
+DIRECTIONS = [
+    (1, 0),   # southeast
+    (1, -1),  # northeast
+    (0, -1),  # north
+    (-1, 0),  # northwest
+    (-1, 1),  # southwest
+    (0, 1),   # south
+]
+
+MIN_HEXES = 1
+MAX_HEXES = 100000
+MAX_LEVELS = 16
+RAMPS_PER_LEVEL = 2          # Ramps joining each pair of consecutive levels (at most)
+RAMP_SPACING = 4             # Minimum steps between ramps of one pair
+
+
+def pack(q: int, r: int) -> int:
+    """Pack axial coordinates into one int key"""
+    return ((q + 0x8000) << 16) | (r + 0x8000)
+
+
+def hex_distance(dq: int, dr: int) -> int:
+    """Steps between two axial cells given their offset"""
+    return (abs(dq) + abs(dr) + abs(dq + dr)) // 2
+
+
+def disk_cells(cq: int, cr: int, radius: int) -> list:
+    """Cells of a hex disk (centre, then ring by ring)"""
+    cells = [(cq, cr)]
+    for ring in range(1, radius + 1):
+        # Start at the ring's southwest-most corner and walk its six sides
+        q, r = cq + DIRECTIONS[4][0] * ring, cr + DIRECTIONS[4][1] * ring
+        for side in range(6):
+            dq, dr = DIRECTIONS[side]
+            for _ in range(ring):
+                cells.append((q, r))
+                q, r = q + dq, r + dr
+    return cells
+
+
+class DungeonBuilder:
+    def __init__(self, target: int, room_ratio: float, min_room: int, max_room: int, rng: random.Random):
+        self.target = target
+        self.room_ratio = room_ratio
+        self.min_room = min_room
+        self.max_room = max_room
+        self.rng = rng
+
+        self.coords = []        # Hex index -> (q, r)
+        self.types = []         # Hex index -> 'ROOM' / 'CORRIDOR'
+        self.links = []         # Hex index -> set of connected hex indices
+        self.cell_index = {}    # Packed (q, r) -> hex index
+        self.room_of = {}       # Packed (q, r) -> room id (room hexes only)
+        self.room_cells = []    # Room id -> list of hex indices
+        self.corridor_count = 0
+        self.corridor_hexes = 0
+
+    def remaining(self) -> int:
+        return self.target - len(self.coords)
+
+    def add_hex(self, q: int, r: int, hex_type: str) -> int:
+        index = len(self.coords)
+        self.coords.append((q, r))
+        self.types.append(hex_type)
+        self.links.append(set())
+        self.cell_index[pack(q, r)] = index
+        if hex_type == 'CORRIDOR':
+            self.corridor_hexes += 1
+        return index
+
+    def link(self, a: int, b: int):
+        self.links[a].add(b)
+        self.links[b].add(a)
+
+    def room_fits(self, cells: list, corridor: set) -> bool:
+        """A room needs its cells free plus a one-hex margin from everything else
+        (the pending corridor may touch it only at its entry)"""
+        for q, r in cells:
+            key = pack(q, r)
+            if key in self.cell_index or key in corridor:
+                return False
+            for dq, dr in DIRECTIONS:
+                if pack(q + dq, r + dr) in self.cell_index:
+                    return False
+        return True
+
+    def place_room(self, cells: list, entry: tuple) -> int:
+        """Add room hexes nearest the entry first (any prefix stays connected and
+        contains the entry), truncated to the hex budget; returns the entry hex index"""
+        eq, er = entry
+        cells = sorted(cells, key=lambda c: hex_distance(c[0] - eq, c[1] - er))[:self.remaining()]
+        room_id = len(self.room_cells)
+        members = []
+        for q, r in cells:
+            index = self.add_hex(q, r, 'ROOM')
+            self.room_of[pack(q, r)] = room_id
+            members.append(index)
+        for index in members:
+            q, r = self.coords[index]
+            for dq, dr in DIRECTIONS:
+                neighbor = self.room_of.get(pack(q + dq, r + dr))
+                if neighbor == room_id:
+                    self.link(index, self.cell_index[pack(q + dq, r + dr)])
+        self.room_cells.append(members)
+        return members[0]
+
+    def random_room_size(self) -> int:
+        return self.rng.randint(self.min_room, self.max_room)
+
+    def corridor_length(self, room_radius: int) -> int:
+        """Corridor length that keeps corridor/room hexes near the requested ratio"""
+        room_hexes = 3 * room_radius * (room_radius + 1) + 1
+        ideal = room_hexes * (1.0 - self.room_ratio) / self.room_ratio
+        
+        # Steer back toward the ratio (loops add corridor hexes without rooms)
+        placed = len(self.coords)
+        actual = max(self.corridor_hexes / placed, 0.01)
+        ideal *= min(2.0, max(0.1, (1.0 - self.room_ratio) / actual))
+        return max(2, int(round(ideal * self.rng.uniform(0.6, 1.4))))
+
+    def grow(self, max_attempts: int):
+        """Branch a corridor off a random room edge, ending in a new room or an existing one"""
+        attempts = 0
+        while self.remaining() > 0 and attempts < max_attempts:
+            attempts += 1
+            room_id = self.rng.randrange(len(self.room_cells))
+            start = self.rng.choice(self.room_cells[room_id])
+            direction = self.rng.randrange(6)
+            sq, sr = self.coords[start]
+            dq, dr = DIRECTIONS[direction]
+            q, r = sq + dq, sr + dr
+            if pack(q, r) in self.cell_index:
+                continue
+
+            room_radius = self.random_room_size()
+            length = self.corridor_length(room_radius)
+
+            # Walk the corridor, turning by one direction now and then; running
+            # into another room joins it (a loop), anything else blocks
+            path = []
+            joined = None
+            blocked = False
+            occupied = set()
+            for step in range(length):
+                key = pack(q, r)
+                if key in self.cell_index:
+                    if step > 0 and self.room_of.get(key, room_id) != room_id:
+                        joined = self.cell_index[key]
+                    else:
+                        blocked = True
+                    break
+                path.append((q, r))
+                occupied.add(key)
+                if self.rng.random() < 0.25:
+                    direction = (direction + self.rng.choice((-1, 1))) % 6
+                    dq, dr = DIRECTIONS[direction]
+                q, r = q + dq, r + dr
+                if pack(q, r) in occupied:
+                    blocked = True
+                    break
+
+            if blocked or not path:
+                continue
+
+            # Loops only add corridor hexes, so skip them while over the corridor share
+            if joined is not None and self.corridor_hexes > (1.0 - self.room_ratio) * len(self.coords):
+                continue
+            
+            # A new room must fit at the far end, entered at the cell after the corridor
+            room = None
+            if joined is None:
+                cq, cr = q + dq * room_radius, r + dr * room_radius
+                room = disk_cells(cq, cr, room_radius)
+                if not self.room_fits(room, occupied):
+                    continue
+
+            # Commit the corridor (truncated to the budget), then the room
+            full_path = len(path)
+            path = path[:self.remaining()]
+            previous = start
+            for pq, pr in path:
+                index = self.add_hex(pq, pr, 'CORRIDOR')
+                self.link(previous, index)
+                previous = index
+            self.corridor_count += 1
+            attempts = 0
+
+            if len(path) < full_path or self.remaining() <= 0 and joined is None:
+                break
+            if joined is not None:
+                self.link(previous, joined)
+                continue
+
+            entry = self.place_room(room, (q, r))
+            self.link(previous, entry)
+
+    def build(self):
+        self.place_room(disk_cells(0, 0, self.random_room_size()), (0, 0))
+        self.grow(max_attempts=2000)
+        if self.remaining() > 0:
+            raise RuntimeError(f"layout got stuck with {self.remaining()} hexes left to place")
+
+
+def link_levels(lower: DungeonBuilder, upper: DungeonBuilder, taken: set, rng: random.Random) -> list:
+    """Ramps from one level up to the next: a cell free on both levels (and
+    not a ramp from the level below) beside a lower-level hex, with an
+    upper-level hex one more step on. Returns (lower index, (q, r), upper
+    index) for each, spread apart."""
+    candidates = []
+    for index, (q, r) in enumerate(lower.coords):
+        for dq, dr in DIRECTIONS:
+            key = pack(q + dq, r + dr)
+            if key in lower.cell_index or key in upper.cell_index or key in taken:
+                continue
+            top = upper.cell_index.get(pack(q + 2 * dq, r + 2 * dr))
+            if top is not None:
+                candidates.append((index, (q + dq, r + dr), top))
+
+    rng.shuffle(candidates)
+    chosen = []
+    for candidate in candidates:
+        rq, rr = candidate[1]
+        if all(hex_distance(rq - other[1][0], rr - other[1][1]) >= RAMP_SPACING for other in chosen):
+            chosen.append(candidate)
+            if len(chosen) == RAMPS_PER_LEVEL:
+                break
+    return chosen
+
+
+def generate_map(hex_count: int, seed: str, room_ratio: float, min_room: int, max_room: int,
+                 levels: int = 1) -> dict:
+    """Generate an API-compatible map dictionary"""
+    # Each level gets an even share of what the ramps leave
+    level_hexes = hex_count - RAMPS_PER_LEVEL * (levels - 1)
+    targets = [level_hexes // levels + (1 if level < level_hexes % levels else 0) for level in range(levels)]
+    if min(targets) < 1:
+        raise RuntimeError(f"{hex_count} hexes cannot fill {levels} levels")
+
+    builders = []
+    for level, target in enumerate(targets):
+        rng = random.Random(seed if level == 0 else f'{seed}/level-{level}')
+        builder = DungeonBuilder(target, room_ratio, min_room, max_room, rng)
+        builder.build()
+        builders.append(builder)
+
+    # Hexagons as (level, ramp, q, r, type, linked entries), ramps last
+    entries = []
+    base = []
+    for level, builder in enumerate(builders):
+        base.append(len(entries))
+        for index, (q, r) in enumerate(builder.coords):
+            entries.append((level, 0, q, r, builder.types[index], set()))
+    for level, builder in enumerate(builders):
+        for index, links in enumerate(builder.links):
+            entries[base[level] + index][5].update(base[level] + other for other in links)
+
+    ramp_count = 0
+    taken = set()
+    for level in range(levels - 1):
+        rng = random.Random(f'{seed}/ramps-{level}')
+        ramps = link_levels(builders[level], builders[level + 1], taken, rng)
+        if not ramps:
+            raise RuntimeError(f"no room for a ramp between levels {level} and {level + 1}")
+        taken = set()
+        for lower, (q, r), upper in ramps:
+            ramp = len(entries)
+            entries.append((level, 1, q, r, 'CORRIDOR', {base[level] + lower, base[level + 1] + upper}))
+            entries[base[level] + lower][5].add(ramp)
+            entries[base[level + 1] + upper][5].add(ramp)
+            taken.add(pack(q, r))
+        ramp_count += len(ramps)
+
+    # Level order (each level's ramps after it), ids by final position
+    order = sorted(range(len(entries)), key=lambda i: 2 * entries[i][0] + entries[i][1])
+    position = {old: new for new, old in enumerate(order)}
+    hexagons = []
+    for new, old in enumerate(order):
+        level, ramp, q, r, hex_type, links = entries[old]
+        hexagons.append({
+            'id': f'hex-{new}',
+            'q': q,
+            'r': r,
+            'type': hex_type,
+            'connections': [f'hex-{other}' for other in sorted(position[i] for i in links)],
+            'isWalkable': True,
+            'height': level + 1.5 if ramp else level + 1,
+        })
+
+    metadata = {
+        'seed': seed,
+        'totalHexagons': len(hexagons),
+        'rooms': sum(len(builder.room_cells) for builder in builders),
+        'corridors': sum(builder.corridor_count for builder in builders) + ramp_count,
+    }
+    if levels > 1:
+        metadata['levels'] = levels
+        metadata['ramps'] = ramp_count
+    return {
+        'metadata': metadata,
+        'hexagons': hexagons,
+    }
+
+
+def write_map(map_data: dict, output_path: str):
+    """Write JSON one hexagon per line (keeps memory flat and diffs readable)"""
+    with open(output_path, 'w') as f:
+        f.write('{"metadata": ')
+        json.dump(map_data['metadata'], f)
+        f.write(', "hexagons": [\n')
+        hexagons = map_data['hexagons']
+        for i, hex_data in enumerate(hexagons):
+            json.dump(hex_data, f, separators=(',', ':'))
+            f.write(',\n' if i < len(hexagons) - 1 else '\n')
+        f.write(']}\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate an offline ENCOM map (API-compatible JSON)')
+    parser.add_argument('-n', '--hexes', type=int, default=100, help=f'Hexagon count ({MIN_HEXES}-{MAX_HEXES})')
+    parser.add_argument('-s', '--seed', default='offline', help='Seed string (also picks the colour palette)')
+    parser.add_argument('--room-ratio', type=float, default=0.6, help='Target fraction of ROOM hexes (0.05-0.95)')
+    parser.add_argument('--min-room', type=int, default=1, help='Minimum room radius in hexes')
+    parser.add_argument('--max-room', type=int, default=3, help='Maximum room radius in hexes')
+    parser.add_argument('--levels', type=int, default=1, help=f'Stacked levels joined by ramps (1-{MAX_LEVELS})')
+    parser.add_argument('-o', '--output', default='map_response.json', help='Output JSON file')
+
+    args = parser.parse_args()
+
+    if not MIN_HEXES <= args.hexes <= MAX_HEXES:
+        print(f"ERROR: --hexes must be between {MIN_HEXES} and {MAX_HEXES}")
+        sys.exit(1)
+    if not 0.05 <= args.room_ratio <= 0.95:
+        print("ERROR: --room-ratio must be between 0.05 and 0.95")
+        sys.exit(1)
+    if not 0 <= args.min_room <= args.max_room:
+        print("ERROR: need 0 <= --min-room <= --max-room")
+        sys.exit(1)
+    if not 1 <= args.levels <= MAX_LEVELS:
+        print(f"ERROR: --levels must be between 1 and {MAX_LEVELS}")
+        sys.exit(1)
+
+    try:
+        map_data = generate_map(args.hexes, args.seed, args.room_ratio, args.min_room, args.max_room, args.levels)
+        write_map(map_data, args.output)
+    except Exception as e:
+        print(f"ERROR: {e}")
+        sys.exit(1)
+
+    metadata = map_data['metadata']
+    rooms = sum(1 for h in map_data['hexagons'] if h['type'] == 'ROOM')
+    print(f"Generated map: {args.output}")
+    print(f"  Hexagons: {metadata['totalHexagons']} ({rooms} room, {metadata['totalHexagons'] - rooms} corridor)")
+    print(f"  Rooms: {metadata['rooms']}, Corridors: {metadata['corridors']}")
+    if args.levels > 1:
+        print(f"  Levels: {args.levels}, Ramps: {metadata['ramps']}")
+    print(f"  Seed: {args.seed}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,421 @@
+/*
+ * ENCOM-64 micro-benchmark ROM
+ * Runs a fixed suite of synthetic scenes and CPU kernels, then prints timing
+ * tables through debugf (ISViewer / USB log), so it can run headless under
+ * an emulator. Separates RDP fill rate, triangle setup, mode/material
+ * switches, TMEM texture uploads, painter's order against the Z-buffer on
+ * whole game frames, interlaced field rendering at 640x480, and CPU math
+ * (project_vertex, culling, collision).
+ *
+ * All RDP timings include waiting for the RDP to finish (rdpq_detach_wait).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <libdragon.h>
+#include <rdpq.h>
+#include <rdpq_tri.h>
+#include <rdpq_mode.h>
+#include "../generated/map_data.h"
+#include "../core/hexagon.h"
+#include "../core/map_loader.h"
+#include "../core/render.h"
+#include "../core/collision.h"
+#include "../core/geometry.h"
+#include "../core/texture.h"
+#include "../core/arena.h"
+#include "../core/interlace.h"
+
+#define BENCH_FRAMES 30              // Frames averaged per RDP scene
+#define BENCH_FILLS_PER_FRAME 4      // Full-screen fills per frame in the fill test
+#define BENCH_MATERIAL_TRIS 400      // Triangles in the material switch and texture tests
+#define BENCH_PROJECT_CALLS 20000    // project_vertex calls per timing
+#define BENCH_CULL_FRAMES 200        // render_build_lists calls per timing
+#define BENCH_COLLISION_MOVES 2000   // collision_move calls per timing
+
+hexagon_t hexagons[MAP_HEX_COUNT];
+
+static const rdpq_trifmt_t bench_trifmt = {
+    .pos_offset = RENDER_VTX_POS,
+    .shade_offset = RENDER_VTX_SHADE,
+    .tex_offset = -1,
+    .z_offset = -1
+};
+
+static uint32_t ticks_to_us(uint32_t ticks) {
+    return (uint32_t)TICKS_TO_US((uint64_t)ticks);
+}
+
+// Screen-space triangle with the game's vertex layout (shade alpha = fog factor)
+static void bench_triangle(float x0, float y0, float x1, float y1, float x2, float y2, float fog_alpha) {
+    float v[3][RENDER_VTX_FLOATS] = {
+        { x0, y0, 1.0f, 1.0f, 1.0f, fog_alpha },
+        { x1, y1, 1.0f, 1.0f, 1.0f, fog_alpha },
+        { x2, y2, 1.0f, 1.0f, 1.0f, fog_alpha },
+    };
+    rdpq_triangle(&bench_trifmt, v[0], v[1], v[2]);
+}
+
+// Game render mode: material colour times shade through the fog blender
+static void bench_game_mode(void) {
+    rdpq_set_mode_standard();
+    rdpq_mode_combiner(RENDER_COMBINER_LIT);
+    rdpq_mode_fog(RDPQ_FOG_STANDARD);
+    rdpq_set_fog_color(render_fog_color());
+}
+
+// Full-screen fill-mode rectangles: raw RDP fill rate per target size/depth
+static void bench_fills(void) {
+    static const struct { int width, height; tex_format_t format; const char* name; } targets[] = {
+        { 320, 240, FMT_RGBA16, "320x240 16bpp" },
+        { 320, 240, FMT_RGBA32, "320x240 32bpp" },
+        { 640, 480, FMT_RGBA16, "640x480 16bpp" },
+        { 640, 480, FMT_RGBA32, "640x480 32bpp" },
+    };
+
+    debugf("\nFull-screen fills (%d per frame, %d frames)\n", BENCH_FILLS_PER_FRAME, BENCH_FRAMES);
+    debugf("%-16s %12s %12s\n", "target", "us/fill", "Mpixel/s");
+    for(int t = 0; t < 4; t++) {
+        surface_t surf = surface_alloc(targets[t].format, targets[t].width, targets[t].height);
+        uint32_t start = get_ticks();
+        for(int f = 0; f < BENCH_FRAMES; f++) {
+            rdpq_attach(&surf, NULL);
+            rdpq_set_mode_fill(RGBA32(f, 0, 0, 255));
+            for(int i = 0; i < BENCH_FILLS_PER_FRAME; i++) {
+                rdpq_fill_rectangle(0, 0, targets[t].width, targets[t].height);
+            }
+            rdpq_detach_wait();
+        }
+        uint32_t us = ticks_to_us(get_ticks() - start) / (BENCH_FRAMES * BENCH_FILLS_PER_FRAME);
+        uint32_t pixels = targets[t].width * targets[t].height;
+        debugf("%-16s %12lu %12lu\n", targets[t].name, (unsigned long)us,
+               (unsigned long)(us ? pixels / us : 0));
+        surface_free(&surf);
+    }
+}
+
+// N wall quads (two fogged triangles each) of a given screen coverage,
+// tiled across a 320x240 16bpp target like the game's wall pass
+static void bench_walls(void) {
+    static const int wall_counts[] = { 10, 100, 400 };
+    static const int wall_sizes[] = { 4, 16, 64, 240 };   // Quad edge in pixels
+    surface_t surf = surface_alloc(FMT_RGBA16, 320, 240);
+
+    debugf("\nWalls: fogged flat quads, 320x240 16bpp (%d frames)\n", BENCH_FRAMES);
+    debugf("%-6s %-8s %12s %12s %12s\n", "walls", "size", "us/frame", "ns/tri", "Mpixel/s");
+    for(int c = 0; c < 3; c++) {
+        for(int s = 0; s < 4; s++) {
+            int count = wall_counts[c];
+            float size = wall_sizes[s];
+            uint32_t start = get_ticks();
+            for(int f = 0; f < BENCH_FRAMES; f++) {
+                rdpq_attach(&surf, NULL);
+                bench_game_mode();
+                rdpq_set_prim_color(RGBA32(128, 128, 128, 255));
+                for(int w = 0; w < count; w++) {
+                    // Step across the screen so small quads do not stack
+                    float x = (w * 37) % (int)(321 - (size > 320 ? 320 : size));
+                    float y = (w * 23) % (int)(241 - (size > 240 ? 240 : size));
+                    bench_triangle(x, y, x + size, y, x, y + size, 0.75f);
+                    bench_triangle(x + size, y, x + size, y + size, x, y + size, 0.75f);
+                }
+                rdpq_detach_wait();
+            }
+            uint32_t us = ticks_to_us(get_ticks() - start) / BENCH_FRAMES;
+            uint32_t pixels = (uint32_t)(count * size * size);
+            debugf("%-6d %3dx%-4d %12lu %12lu %12lu\n", count, (int)size, (int)size, (unsigned long)us,
+                   (unsigned long)(us * 1000 / (count * 2)), (unsigned long)(us ? pixels / us : 0));
+        }
+    }
+    surface_free(&surf);
+}
+
+// Small triangles with a material (prim colour) or render mode change before
+// every triangle, against the same triangles sorted into four batches
+static void bench_materials(void) {
+    static const char* names[] = { "batched", "colour/tri", "mode/tri" };
+    surface_t surf = surface_alloc(FMT_RGBA16, 320, 240);
+
+    debugf("\nMaterial switches: %d 10x10 triangles, 320x240 16bpp (%d frames)\n", BENCH_MATERIAL_TRIS, BENCH_FRAMES);
+    debugf("%-12s %12s %12s\n", "submission", "us/frame", "ns/tri");
+    for(int mode = 0; mode < 3; mode++) {
+        uint32_t start = get_ticks();
+        for(int f = 0; f < BENCH_FRAMES; f++) {
+            rdpq_attach(&surf, NULL);
+            bench_game_mode();
+            for(int i = 0; i < BENCH_MATERIAL_TRIS; i++) {
+                int material = (mode == 0) ? i * 4 / BENCH_MATERIAL_TRIS : i % 4;
+                if(mode == 0 && i % (BENCH_MATERIAL_TRIS / 4) == 0) {
+                    rdpq_set_prim_color(RGBA32(64 * material, 128, 255 - 64 * material, 255));
+                } else if(mode == 1) {
+                    rdpq_set_prim_color(RGBA32(64 * material, 128, 255 - 64 * material, 255));
+                } else if(mode == 2) {
+                    // Alternate fog on/off: a combiner/blender (SOM) change per triangle
+                    rdpq_mode_fog(material & 1 ? RDPQ_FOG_STANDARD : 0);
+                }
+                float x = (i * 37) % 310, y = (i * 23) % 230;
+                bench_triangle(x, y, x + 10, y, x, y + 10, 0.75f);
+            }
+            rdpq_detach_wait();
+        }
+        uint32_t us = ticks_to_us(get_ticks() - start) / BENCH_FRAMES;
+        debugf("%-12s %12lu %12lu\n", names[mode], (unsigned long)us,
+               (unsigned long)(us * 1000 / BENCH_MATERIAL_TRIS));
+    }
+    surface_free(&surf);
+}
+
+// Small wall-textured triangles: untextured, textured with the level kept
+// resident, and textured with the level reloaded into TMEM before every
+// triangle (what a texture-unaware submission order degrades to)
+static void bench_textures(void) {
+    static const char* names[] = { "flat", "resident", "upload/tri" };
+    surface_t surf = surface_alloc(FMT_RGBA16, 320, 240);
+
+    debugf("\nTextures: %d 10x10 triangles, wall level 0, 320x240 16bpp (%d frames)\n", BENCH_MATERIAL_TRIS, BENCH_FRAMES);
+    debugf("%-12s %12s %12s %12s\n", "submission", "us/frame", "ns/tri", "TMEM B/frame");
+    for(int mode = 0; mode < 3; mode++) {
+        rdpq_trifmt_t trifmt = bench_trifmt;
+        uint32_t upload_bytes = 0;
+        uint32_t start = get_ticks();
+        for(int f = 0; f < BENCH_FRAMES; f++) {
+            rdpq_attach(&surf, NULL);
+            bench_game_mode();
+            if(mode > 0) {
+                rdpq_mode_combiner(RENDER_COMBINER_TEXTURED);
+                rdpq_mode_filter(FILTER_BILINEAR);
+                rdpq_mode_persp(true);
+                trifmt.tex_offset = RENDER_VTX_TEX;
+            }
+            texture_invalidate();
+            texture_begin_frame();
+            rdpq_set_prim_color(render_material_color(RENDER_MATERIAL_WALL));
+            for(int i = 0; i < BENCH_MATERIAL_TRIS; i++) {
+                if(mode == 2) texture_invalidate();
+                if(mode > 0) trifmt.tex_tile = texture_bind(TEXTURE_WALL, 0);
+                float x = (i * 37) % 310, y = (i * 23) % 230;
+                float v[3][RENDER_VTX_FLOATS] = {
+                    { x, y, 1.0f, 1.0f, 1.0f, 0.75f, 0.0f, 0.0f, 1.0f },
+                    { x + 10, y, 1.0f, 1.0f, 1.0f, 0.75f, 64.0f, 0.0f, 1.0f },
+                    { x, y + 10, 1.0f, 1.0f, 1.0f, 0.75f, 0.0f, 32.0f, 1.0f },
+                };
+                rdpq_triangle(&trifmt, v[0], v[1], v[2]);
+            }
+            rdpq_detach_wait();
+            upload_bytes += texture_stats.upload_bytes;
+        }
+        uint32_t us = ticks_to_us(get_ticks() - start) / BENCH_FRAMES;
+        debugf("%-12s %12lu %12lu %12lu\n", names[mode], (unsigned long)us,
+               (unsigned long)(us * 1000 / BENCH_MATERIAL_TRIS), (unsigned long)(upload_bytes / BENCH_FRAMES));
+    }
+    surface_free(&surf);
+    texture_invalidate();
+}
+
+// Whole game frames (render_world, textured) turning in place at the first
+// hexagon, in painter's order and with the Z-buffer, at 16 and 32 bpp.
+// Submit is the CPU time to build and queue the frame (culling, sorting,
+// projection); frame adds waiting for the RDP, which pays for the overdraw
+// in painter's order and for the Z reads and writes otherwise.
+static void bench_zbuffer(void) {
+    static const struct { tex_format_t format; const char* name; } targets[] = {
+        { FMT_RGBA16, "320x240 16bpp" },
+        { FMT_RGBA32, "320x240 32bpp" },
+    };
+    surface_t zbuf = surface_alloc(FMT_RGBA16, 320, 240);
+    camera_t cam = {
+        .x = hexagons[0].center_x,
+        .y = 10.0f,
+        .z = hexagons[0].center_z
+    };
+    render_split_viewports(&cam, 1, 320, 240);
+
+    debugf("\nGame frames: painter's order vs Z-buffer (%d frames, turning in place)\n", BENCH_FRAMES);
+    debugf("%-16s %-10s %12s %12s\n", "target", "order", "submit us", "frame us");
+    for(int t = 0; t < 2; t++) {
+        surface_t surf = surface_alloc(targets[t].format, 320, 240);
+        for(int zbuffer = 0; zbuffer < 2; zbuffer++) {
+            render_zbuffer = zbuffer;
+            uint32_t submit = 0;
+            uint32_t start = get_ticks();
+            for(int f = 0; f < BENCH_FRAMES; f++) {
+                arena_frame_reset();
+                texture_invalidate();
+                cam.yaw_rad = f * 0.2f;
+                uint32_t frame_start = get_ticks();
+                rdpq_attach(&surf, zbuffer ? &zbuf : NULL);
+                render_world(&cam);
+                submit += get_ticks() - frame_start;
+                rdpq_detach_wait();
+            }
+            uint32_t us = ticks_to_us(get_ticks() - start) / BENCH_FRAMES;
+            debugf("%-16s %-10s %12lu %12lu\n", targets[t].name, zbuffer ? "Z-buffer" : "painter",
+                   (unsigned long)(ticks_to_us(submit) / BENCH_FRAMES), (unsigned long)us);
+        }
+        surface_free(&surf);
+    }
+    render_zbuffer = 0;
+    surface_free(&zbuf);
+}
+
+// Whole game frames (painter's order, textured, 16 bpp) turning in place at
+// the first hexagon: 320x240, 640x480 with every line drawn, and 640x480
+// drawing one field per frame with each reconstruction of the other (the
+// copy is part of the frame time). Two 640x480 frames alternate, as the
+// display's buffers do, so a weave reads the previous one.
+static void bench_interlace(void) {
+    static const struct { int width, height, fields; interlace_recon_t recon; const char* name; } runs[] = {
+        { 320, 240, 0, INTERLACE_WEAVE, "all" },
+        { 640, 480, 0, INTERLACE_WEAVE, "all" },
+        { 640, 480, 1, INTERLACE_WEAVE, "field weave" },
+        { 640, 480, 1, INTERLACE_BOB, "field bob" },
+    };
+    surface_t frames[2] = {
+        surface_alloc(FMT_RGBA16, 640, 480),
+        surface_alloc(FMT_RGBA16, 640, 480),
+    };
+    surface_t small = surface_alloc(FMT_RGBA16, 320, 240);
+    camera_t cam = {
+        .x = hexagons[0].center_x,
+        .y = 10.0f,
+        .z = hexagons[0].center_z
+    };
+
+    debugf("\nInterlaced fields: game frames at 16bpp (%d frames, turning in place)\n", BENCH_FRAMES);
+    debugf("%-10s %-12s %12s %12s\n", "target", "lines", "submit us", "frame us");
+    for(int r = 0; r < 4; r++) {
+        render_split_viewports(&cam, 1, runs[r].width, runs[r].height);
+        interlace_reset();
+        interlace.recon = runs[r].recon;
+        uint32_t submit = 0;
+        uint32_t start = get_ticks();
+        for(int f = 0; f < BENCH_FRAMES; f++) {
+            surface_t* surf = runs[r].width == 320 ? &small : &frames[f & 1];
+            arena_frame_reset();
+            texture_invalidate();
+            cam.yaw_rad = f * 0.2f;
+            uint32_t frame_start = get_ticks();
+            rdpq_attach(surf, NULL);
+            if(runs[r].fields) render_field = RENDER_FIELD_EVEN + interlace_next_field();
+            render_world(&cam);
+            if(runs[r].fields) {
+                render_field = RENDER_FIELD_NONE;
+                interlace_reconstruct(surf);
+            }
+            submit += get_ticks() - frame_start;
+            rdpq_detach_wait();
+            interlace_shown(surf);
+        }
+        uint32_t us = ticks_to_us(get_ticks() - start) / BENCH_FRAMES;
+        debugf("%4dx%-5d %-12s %12lu %12lu\n", runs[r].width, runs[r].height, runs[r].name,
+               (unsigned long)(ticks_to_us(submit) / BENCH_FRAMES), (unsigned long)us);
+    }
+    interlace_reset();
+    interlace.recon = INTERLACE_WEAVE;
+    surface_free(&small);
+    surface_free(&frames[0]);
+    surface_free(&frames[1]);
+    texture_invalidate();
+}
+
+// CPU kernels in tight loops on the real map
+static void bench_cpu(void) {
+    camera_t cam = {
+        .x = hexagons[0].center_x,
+        .y = 10.0f,
+        .z = hexagons[0].center_z,
+        .yaw_rad = 0.3f
+    };
+    render_split_viewports(&cam, 1, 320, 240);
+
+    debugf("\nCPU kernels (%d hexes)\n", MAP_HEX_COUNT);
+    debugf("%-24s %10s %12s\n", "kernel", "calls", "ns/call");
+
+    // project_vertex over hexagon corners
+    volatile float sink = 0.0f;
+    uint32_t start = get_ticks();
+    for(int i = 0; i < BENCH_PROJECT_CALLS; i++) {
+        const hexagon_t* hex = &hexagons[(i / 6) % MAP_HEX_COUNT];
+        screen_pos_t p = project_vertex(hex->vertices_x[i % 6], 20.0f, hex->vertices_z[i % 6], &cam);
+        sink += p.x;
+    }
+    uint32_t us = ticks_to_us(get_ticks() - start);
+    debugf("%-24s %10d %12lu\n", "project_vertex", BENCH_PROJECT_CALLS,
+           (unsigned long)((uint64_t)us * 1000 / BENCH_PROJECT_CALLS));
+
+    // Per-frame culling and depth sorting (one view, rotating in place), with
+    // the visibility cache kept and with it regathered every call
+    arena_frame_reset();
+    render_lists_t* lists = render_lists_alloc();
+    for(int cold = 0; cold < 2; cold++) {
+        start = get_ticks();
+        for(int i = 0; i < BENCH_CULL_FRAMES; i++) {
+            cam.yaw_rad = i * 0.05f;
+            if(cold) render_invalidate_views();
+            render_prepare_views(&cam, 1);
+            render_build_lists(&cam, 0, lists);
+            sink += lists->hex_count;
+        }
+        us = ticks_to_us(get_ticks() - start);
+        debugf("%-24s %10d %12lu\n", cold ? "prepare+build (regather)" : "prepare+build_lists", BENCH_CULL_FRAMES,
+               (unsigned long)((uint64_t)us * 1000 / BENCH_CULL_FRAMES));
+    }
+    
+    // Swept-circle collision: short moves in random directions near hex centres
+    srand(1);
+    start = get_ticks();
+    for(int i = 0; i < BENCH_COLLISION_MOVES; i++) {
+        const hexagon_t* hex = &hexagons[rand() % MAP_HEX_COUNT];
+        float x = hex->center_x, z = hex->center_z;
+        float new_x = x + (rand() % 81 - 40), new_z = z + (rand() % 81 - 40);
+        collision_move(x, z, &new_x, &new_z, 5.0f, hex->level);
+        sink += new_x;
+    }
+    us = ticks_to_us(get_ticks() - start);
+    debugf("%-24s %10d %12lu\n", "collision_move", BENCH_COLLISION_MOVES,
+           (unsigned long)((uint64_t)us * 1000 / BENCH_COLLISION_MOVES));
+    (void)sink;
+}
+
+int main(void)
+{
+    debug_init_isviewer();
+    debug_init_usblog();
+    arena_init();
+    display_init(RESOLUTION_320x240, DEPTH_16_BPP, 2, GAMMA_NONE, FILTERS_RESAMPLE);
+    dfs_init(DFS_DEFAULT_LOCATION);
+    rdpq_init();
+
+#ifdef MAP_BLOB_FILE
+    if(map_load("rom:/" MAP_BLOB_FILE, NULL) < 0) {
+        debugf("Cannot load map blob rom:/%s\n", MAP_BLOB_FILE);
+        return 1;
+    }
+#endif
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        hexagon_init(&hexagons[i], &map_hexagons[i]);
+    }
+    hexagon_build_lookup();
+    geometry_build();
+    texture_init();
+    render_init();
+
+    debugf("ENCOM-64 benchmark: map %s (%d hexes)\n", MAP_SEED, MAP_HEX_COUNT);
+    bench_fills();
+    bench_walls();
+    bench_materials();
+    bench_textures();
+    bench_zbuffer();
+    bench_interlace();
+    bench_cpu();
+    arena_report();
+    debugf("\nBenchmark done\n");
+
+    // Leave the result on screen for runs without a debug log
+    while(1) {
+        surface_t* disp = display_get();
+        graphics_fill_screen(disp, 0);
+        graphics_draw_text(disp, 20, 20, "ENCOM-64 benchmark done (see debug log)");
+        display_show(disp);
+    }
+}
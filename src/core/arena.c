@@ -0,0 +1,218 @@
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <assert.h>
+#ifdef N64
+#include <libdragon.h>
+#else
+#define debugf(...) printf(__VA_ARGS__)
+#define assertf(expr, ...) assert(expr)
+#endif
+
+// Exceeding a budget or an arena's size is fatal on N64. Host tools load
+// maps far larger than the console holds, so there it is reported (once, via
+// the warned flag) and the run carries on, with the peaks in arena_report
+// showing by how much
+#ifdef N64
+#define limit_check(warned, expr, ...) assertf(expr, __VA_ARGS__)
+#else
+#define limit_check(warned, expr, ...) do { \
+    if(!(expr) && !(warned)) { \
+        (warned) = 1; \
+        fprintf(stderr, "Warning: " __VA_ARGS__); \
+        fprintf(stderr, " (not enforced on host)\n"); \
+    } \
+} while(0)
+
+// Memory reserved behind each host arena, so runs past the console's sizes
+// still have room (pages no allocation touches are never committed)
+#define ARENA_HOST_RESERVE (256 * 1024 * 1024)
+#endif
+
+// Allocation alignment: one data cache line, so buffers the RDP or RSP
+// reads never share a line with CPU data
+#define ARENA_ALIGN 16
+
+// Budget limits without / with the Expansion Pak
+static const struct {
+    const char* name;
+    uint32_t limit, limit_expanded;
+} budget_table[ARENA_BUDGET_COUNT] = {
+    [ARENA_MAP] = { "map", 1024 * 1024, 2048 * 1024 },
+    [ARENA_GEOMETRY] = { "geometry", 320 * 1024, 640 * 1024 },
+    [ARENA_TEXTURE] = { "texture", 16 * 1024, 16 * 1024 },
+    [ARENA_ENTITY] = { "entity", 96 * 1024, 160 * 1024 },
+    [ARENA_NAV] = { "nav", 256 * 1024, 1280 * 1024 },
+    [ARENA_VISIBILITY] = { "visibility", 16 * 1024, 64 * 1024 },
+    [ARENA_RENDER] = { "render", 128 * 1024, 256 * 1024 },
+    [ARENA_ZBUFFER] = { "zbuffer", 150 * 1024, 600 * 1024 },   // 320x240 / 640x480 at 16 bits
+};
+
+arena_budget_info_t arena_budgets[ARENA_BUDGET_COUNT];
+int arena_expanded = 0;
+static uint8_t budget_warned[ARENA_BUDGET_COUNT];
+
+// Bump arenas: [base, base + size), next free byte at top (host builds
+// reserve more than size behind base)
+typedef struct {
+    const char* name;
+    uint8_t* base;
+    size_t size;
+    size_t reserved;
+    size_t top;
+    size_t peak;
+    uint8_t warned;
+} bump_arena_t;
+
+static bump_arena_t persistent_arena, frame_arena;
+
+static size_t align_up(size_t bytes) {
+    return (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static void bump_init(bump_arena_t* arena, const char* name, size_t size) {
+#ifdef N64
+    size_t reserved = size;
+#else
+    size_t reserved = ARENA_HOST_RESERVE;
+#endif
+    arena->name = name;
+    arena->base = memalign(ARENA_ALIGN, reserved);
+    assertf(arena->base, "Cannot reserve a %u byte arena", (unsigned)reserved);
+    arena->size = size;
+    arena->reserved = reserved;
+    arena->top = 0;
+    arena->peak = 0;
+    arena->warned = 0;
+}
+
+static void* bump_alloc(bump_arena_t* arena, size_t bytes) {
+    limit_check(arena->warned, arena->top + bytes <= arena->size,
+            "%s arena full: %u of %u bytes used, %u requested",
+            arena->name, (unsigned)arena->top, (unsigned)arena->size, (unsigned)bytes);
+    assertf(arena->top + bytes <= arena->reserved, "%s arena reserve exhausted", arena->name);
+    void* ptr = arena->base + arena->top;
+    arena->top += bytes;
+    if(arena->top > arena->peak) arena->peak = arena->top;
+    return ptr;
+}
+
+// Charge bytes to a budget (fatal past its limit on N64)
+static void budget_charge(arena_budget_t budget, size_t bytes) {
+    arena_budget_info_t* info = &arena_budgets[budget];
+    limit_check(budget_warned[budget], info->static_bytes + info->used + bytes <= info->limit,
+            "%s budget exceeded: %lu static + %lu used + %u requested > %lu",
+            info->name, (unsigned long)info->static_bytes, (unsigned long)info->used,
+            (unsigned)bytes, (unsigned long)info->limit);
+    info->used += bytes;
+    if(info->static_bytes + info->used > info->peak) info->peak = info->static_bytes + info->used;
+}
+
+// Detect the Expansion Pak, set the budgets and reserve both arenas (call
+// before any other subsystem is initialised)
+void arena_init(void) {
+#ifdef N64
+    arena_expanded = is_memory_expanded();
+#endif
+    for(int b = 0; b < ARENA_BUDGET_COUNT; b++) {
+        arena_budgets[b] = (arena_budget_info_t){
+            .name = budget_table[b].name,
+            .limit = arena_expanded ? budget_table[b].limit_expanded : budget_table[b].limit,
+        };
+        budget_warned[b] = 0;
+    }
+    bump_init(&persistent_arena, "Persistent", arena_scaled(ARENA_PERSISTENT_BYTES, ARENA_PERSISTENT_BYTES_EXPANDED));
+    bump_init(&frame_arena, "Frame", arena_scaled(ARENA_FRAME_BYTES, ARENA_FRAME_BYTES_EXPANDED));
+}
+
+// Record the statically allocated tables of a budget's subsystem (replaces
+// the previous figure, so re-initialising a subsystem does not add up)
+void arena_static(arena_budget_t budget, size_t bytes) {
+    arena_budget_info_t* info = &arena_budgets[budget];
+    bytes = align_up(bytes);
+    limit_check(budget_warned[budget], bytes + info->used <= info->limit, "%s budget exceeded: %u static bytes > %lu",
+            info->name, (unsigned)bytes, (unsigned long)info->limit);
+    info->static_bytes = bytes;
+    if(info->static_bytes + info->used > info->peak) info->peak = info->static_bytes + info->used;
+}
+
+// Bytes a budget can still allocate (a multiple of the alignment, so n items
+// of a size fit if n times the size does; none once a host run exceeds it)
+size_t arena_available(arena_budget_t budget) {
+    const arena_budget_info_t* info = &arena_budgets[budget];
+    size_t held = info->static_bytes + info->used;
+    return held < info->limit ? info->limit - held : 0;
+}
+
+// Persistent allocation (zeroed, never freed)
+void* arena_alloc(arena_budget_t budget, size_t bytes) {
+    bytes = align_up(bytes);
+    budget_charge(budget, bytes);
+    void* ptr = bump_alloc(&persistent_arena, bytes);
+    memset(ptr, 0, bytes);
+    return ptr;
+}
+
+// Release everything allocated from the frame arena (call once per frame,
+// before rendering)
+void arena_frame_reset(void) {
+    frame_arena.top = 0;
+    for(int b = 0; b < ARENA_BUDGET_COUNT; b++) {
+        arena_budgets[b].used -= arena_budgets[b].frame_bytes;
+        arena_budgets[b].frame_bytes = 0;
+    }
+}
+
+// Allocation valid until the next arena_frame_reset (not zeroed)
+void* arena_frame_alloc(arena_budget_t budget, size_t bytes) {
+    bytes = align_up(bytes);
+    budget_charge(budget, bytes);
+    arena_budgets[budget].frame_bytes += bytes;
+    return bump_alloc(&frame_arena, bytes);
+}
+
+// Carve a pool of capacity items from the persistent arena
+void arena_pool_init(arena_pool_t* pool, arena_budget_t budget, size_t item_bytes, int capacity) {
+    pool->item_bytes = align_up(item_bytes < sizeof(void*) ? sizeof(void*) : item_bytes);
+    pool->base = arena_alloc(budget, pool->item_bytes * capacity);
+    pool->capacity = capacity;
+    pool->used = 0;
+    pool->free_list = NULL;
+    for(int i = capacity - 1; i >= 0; i--) {
+        void* item = pool->base + i * pool->item_bytes;
+        *(void**)item = pool->free_list;
+        pool->free_list = item;
+    }
+}
+
+// Take a free item (contents undefined), or NULL when all are in use
+void* arena_pool_get(arena_pool_t* pool) {
+    void* item = pool->free_list;
+    if(!item) return NULL;
+    pool->free_list = *(void**)item;
+    pool->used++;
+    return item;
+}
+
+void arena_pool_put(arena_pool_t* pool, void* item) {
+    *(void**)item = pool->free_list;
+    pool->free_list = item;
+    pool->used--;
+}
+
+// Print every budget's static, current and peak bytes against its limit,
+// and the arenas' high-water marks
+void arena_report(void) {
+    debugf("Memory: %s, persistent arena %u/%u KB, frame arena peak %u/%u KB\n",
+           arena_expanded ? "8 MB (Expansion Pak)" : "4 MB",
+           (unsigned)(persistent_arena.peak / 1024), (unsigned)(persistent_arena.size / 1024),
+           (unsigned)(frame_arena.peak / 1024), (unsigned)(frame_arena.size / 1024));
+    debugf("%-12s %10s %10s %10s %10s\n", "budget", "static", "arena", "peak", "limit");
+    for(int b = 0; b < ARENA_BUDGET_COUNT; b++) {
+        const arena_budget_info_t* info = &arena_budgets[b];
+        debugf("%-12s %10lu %10lu %10lu %10lu\n", info->name, (unsigned long)info->static_bytes,
+               (unsigned long)info->used, (unsigned long)info->peak, (unsigned long)info->limit);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Memory budgets: every subsystem's memory is charged to a named budget,
+// whether it is a static table (recorded with arena_static) or allocated
+// from one of the arenas:
+//   - the persistent arena, bump-allocated during startup and never freed
+//   - the frame arena, bump-allocated while building a frame and reset
+//     before the next one (arena_frame_reset)
+//   - fixed-size pools carved from the persistent arena, for caches that
+//     recycle entries
+// Allocations past a budget or an arena's size are fatal, so the limits
+// below are the whole game's memory plan (host builds only warn, so tools
+// can load maps the console could not hold). Each budget keeps a high-water
+// mark, printed by arena_report.
+//
+// With an Expansion Pak (8 MB) the budgets are larger, and the caches
+// sized from them (visibility caches, flow fields, render queue) grow.
+typedef enum {
+    ARENA_MAP = 0,                   // Hexagons, map tables and the lookup grid
+    ARENA_GEOMETRY,                  // Merged floor pieces and wall tables
+    ARENA_TEXTURE,                   // Texture levels
+    ARENA_ENTITY,                    // Entity arrays and buckets
+    ARENA_NAV,                       // Search scratch and the flow-field cache
+    ARENA_VISIBILITY,                // Per-cell visibility caches
+    ARENA_RENDER,                    // Per-frame render lists and sort scratch
+    ARENA_ZBUFFER,                   // Z-buffer surface (display size, when enabled)
+    ARENA_BUDGET_COUNT
+} arena_budget_t;
+
+// Arena sizes without / with the Expansion Pak: the persistent arena backs
+// the nav and visibility budgets, the frame arena the render budget
+#define ARENA_PERSISTENT_BYTES (320 * 1024)
+#define ARENA_PERSISTENT_BYTES_EXPANDED (1536 * 1024)
+#define ARENA_FRAME_BYTES (24 * 1024)
+#define ARENA_FRAME_BYTES_EXPANDED (48 * 1024)
+
+typedef struct {
+    const char* name;
+    uint32_t limit;                  // Bytes allowed (static plus arenas)
+    uint32_t static_bytes;           // Statically allocated tables
+    uint32_t used;                   // Arena bytes held now
+    uint32_t frame_bytes;            // Of which from the frame arena (until the reset)
+    uint32_t peak;                   // High-water mark of static_bytes + used
+} arena_budget_info_t;
+
+extern arena_budget_info_t arena_budgets[ARENA_BUDGET_COUNT];
+
+// Set by arena_init on N64 (host tools may set it beforehand to model 8 MB)
+extern int arena_expanded;
+
+// Fixed-size pool: items of one size, recycled through a free list
+typedef struct {
+    uint8_t* base;
+    size_t item_bytes;               // Rounded up to the arena alignment
+    int capacity;
+    int used;
+    void* free_list;
+} arena_pool_t;
+
+// Pick a size by the memory installed
+static inline int arena_scaled(int base, int expanded) {
+    return arena_expanded ? expanded : base;
+}
+
+// Function prototypes
+void arena_init(void);
+void arena_static(arena_budget_t budget, size_t bytes);
+size_t arena_available(arena_budget_t budget);
+void* arena_alloc(arena_budget_t budget, size_t bytes);
+void arena_frame_reset(void);
+void* arena_frame_alloc(arena_budget_t budget, size_t bytes);
+void arena_pool_init(arena_pool_t* pool, arena_budget_t budget, size_t item_bytes, int capacity);
+void* arena_pool_get(arena_pool_t* pool);
+void arena_pool_put(arena_pool_t* pool, void* item);
+void arena_report(void);
+
+#endif // ARENA_H
@@ -0,0 +1,118 @@
+#include "autowalk.h"
+#include <math.h>
+#include "nav.h"
+
+// Begin a tour from the player's current hexagon
+void autowalk_start(autowalk_t* walk, const player_state_t* player) {
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        walk->visited[i] = 0;
+    }
+    walk->visited_count = 0;
+    walk->reachable_count = 0;
+    walk->target = -1;
+    walk->target_ticks = 0;
+    walk->last_hex = -1;
+    walk->skipped = 0;
+    walk->active = 0;
+    
+    int start = hexagon_at_position(player->x, player->z, player->level);
+    if(start < 0) return;
+    
+    // Reachable set = everything with a finite distance to the start
+    const nav_field_t* field = nav_get_flow_field(start);
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        if(field->dist[i] != NAV_UNREACHABLE) walk->reachable_count++;
+    }
+    walk->active = 1;
+}
+
+// Nearest unvisited reachable hexagon (the field towards the current hexagon
+// doubles as distance-from-here since open edges are symmetric)
+static int autowalk_pick_target(autowalk_t* walk, int current) {
+    const nav_field_t* field = nav_get_flow_field(current);
+    int best = -1;
+    uint16_t best_dist = NAV_UNREACHABLE;
+    
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        if(!walk->visited[i] && field->dist[i] < best_dist) {
+            best_dist = field->dist[i];
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Produce stick input steering the player along the tour.
+// Returns 0 once every reachable hexagon has been visited.
+int autowalk_input(autowalk_t* walk, const player_state_t* player, sim_input_t* input) {
+    input->stick_x = 0;
+    input->stick_y = 0;
+    if(!walk->active) return 0;
+    
+    int current = hexagon_at_position(player->x, player->z, player->level);
+    if(current < 0) return 1;  // Outside the map - wait for collision to settle
+    
+    if(!walk->visited[current]) {
+        walk->visited[current] = 1;
+        walk->visited_count++;
+    }
+    
+    // Abandon targets we stop making progress towards (e.g. blocked doorway
+    // geometry); distant targets are fine as long as hexagons keep changing
+    if(current != walk->last_hex) {
+        walk->last_hex = current;
+        walk->target_ticks = 0;
+    }
+    if(walk->target >= 0 && walk->target_ticks++ > AUTOWALK_STUCK_TICKS) {
+        walk->visited[walk->target] = 1;
+        walk->visited_count++;
+        walk->skipped++;
+        walk->target = -1;
+    }
+    
+    if(walk->target < 0 || walk->visited[walk->target]) {
+        walk->target = autowalk_pick_target(walk, current);
+        walk->target_ticks = 0;
+        if(walk->target < 0) {
+            walk->active = 0;
+            return 0;  // Tour complete
+        }
+    }
+    
+    // Next hexagon along the shared flow field
+    int next = nav_flow_next(nav_get_flow_field(walk->target), current);
+    if(next < 0) next = walk->target;
+    
+    // Aim for the shared edge midpoint (doorway centre), then the next centre
+    float aim_x = 0.5f * (hexagons[current].center_x + hexagons[next].center_x);
+    float aim_z = 0.5f * (hexagons[current].center_z + hexagons[next].center_z);
+    float dx = aim_x - player->x;
+    float dz = aim_z - player->z;
+    if(dx*dx + dz*dz < 64.0f) {
+        dx = hexagons[next].center_x - player->x;
+        dz = hexagons[next].center_z - player->z;
+    }
+    
+    // Movement direction is (sin(-yaw), cos(-yaw)) - solve for the yaw
+    float target_yaw = atan2f(-dx, dz) * 180.0f / 3.14159f;
+    float yaw_error = target_yaw - player->yaw_deg;
+    while(yaw_error > 180.0f) yaw_error -= 360.0f;
+    while(yaw_error < -180.0f) yaw_error += 360.0f;
+    
+    // Yaw changes by -stick_x / 20 per tick; stay outside the 30 dead zone
+    if(yaw_error > 2.0f || yaw_error < -2.0f) {
+        int stick = (int)(-yaw_error * 20.0f);
+        if(stick > 127) stick = 127;
+        if(stick < -127) stick = -127;
+        if(stick > 0 && stick <= 30) stick = 31;
+        if(stick < 0 && stick >= -30) stick = -31;
+        input->stick_x = stick;
+    }
+    
+    // Walk forward once roughly facing the aim point
+    if(yaw_error < 45.0f && yaw_error > -45.0f) {
+        input->stick_y = 127;
+    }
+    
+    return 1;
+}
@@ -0,0 +1,27 @@
+#ifndef AUTOWALK_H
+#define AUTOWALK_H
+
+#include <stdint.h>
+#include "hexagon.h"
+#include "sim.h"
+
+// Give up on a target after this many ticks without entering a new hexagon
+#define AUTOWALK_STUCK_TICKS (SIM_TICK_HZ * 10)
+
+// Auto-walk tour state: visits every hexagon reachable from the start
+typedef struct {
+    uint8_t visited[MAP_HEX_COUNT];
+    int visited_count;
+    int reachable_count;
+    int target;                  // Unvisited hexagon being walked to (-1 = pick next)
+    int target_ticks;            // Ticks since the last hexagon change on the way to the target
+    int last_hex;                // Hexagon the player was in last tick
+    int skipped;                 // Targets abandoned as stuck
+    int active;
+} autowalk_t;
+
+// Function prototypes
+void autowalk_start(autowalk_t* walk, const player_state_t* player);
+int autowalk_input(autowalk_t* walk, const player_state_t* player, sim_input_t* input);
+
+#endif // AUTOWALK_H
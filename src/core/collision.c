@@ -0,0 +1,300 @@
+#include "collision.h"
+#include <math.h>
+#include <stddef.h>
+#include "../generated/map_data.h"
+
+// Doorway layout shared with rendering (1/3 gap in the center of the edge)
+#define DOOR_GAP 0.33f
+
+// Append one segment to a gathered set (silently drops overflow)
+static void collision_add_segment(collision_set_t* set, float x1, float z1, float x2, float z2) {
+    if(set->count >= COLLISION_MAX_SEGMENTS) return;
+    collision_seg_t* seg = &set->segs[set->count++];
+    seg->x1 = x1; seg->z1 = z1;
+    seg->x2 = x2; seg->z2 = z2;
+}
+
+// Gather the blocking segments of a hexagon's walls that a circle within
+// reach of (x, z) could touch (a wall is 50 units long, so its points are
+// within 25 of its midpoint)
+static void collision_gather_walls(collision_set_t* set, const hexagon_t* hex, float x, float z, float reach) {
+    float max_dist = reach + 25.0f;
+    float max_dist_sq = max_dist * max_dist;
+    
+    // Wall direction d spans vertices (d+5)%6 -> d and uses connection bit d
+    for(int wall_dir = 0; wall_dir < 6; wall_dir++) {
+        int v1 = (wall_dir + 5) % 6;
+        int v2 = wall_dir;
+        float x1 = hex->vertices_x[v1], z1 = hex->vertices_z[v1];
+        float x2 = hex->vertices_x[v2], z2 = hex->vertices_z[v2];
+        float mid_dx = 0.5f * (x1 + x2) - x;
+        float mid_dz = 0.5f * (z1 + z2) - z;
+        if(mid_dx*mid_dx + mid_dz*mid_dz > max_dist_sq) continue;
+        
+        if(!(hex->connections & (1 << wall_dir))) {
+            // No connection: full wall
+            collision_add_segment(set, x1, z1, x2, z2);
+        } else if(hex->type == HEX_TYPE_CORRIDOR) {
+            // Corridor connection: the two wall pieces either side of the doorway
+            float wall_portion = (1.0f - DOOR_GAP) / 2.0f;
+            float left_x = x1 + wall_portion * (x2 - x1);
+            float left_z = z1 + wall_portion * (z2 - z1);
+            float right_x = x1 + (1.0f - wall_portion) * (x2 - x1);
+            float right_z = z1 + (1.0f - wall_portion) * (z2 - z1);
+            collision_add_segment(set, x1, z1, left_x, left_z);
+            collision_add_segment(set, right_x, right_z, x2, z2);
+        }
+        // Room connection: no wall at all
+    }
+}
+
+// Gather the blocking segments of a single hexagon
+void collision_gather_hex(collision_set_t* set, const hexagon_t* hex) {
+    collision_gather_walls(set, hex, hex->center_x, hex->center_z, INFINITY);
+}
+
+// Gather every segment on a level that a circle within reach of (x, z)
+// could touch (only that level's index range is scanned)
+void collision_gather(collision_set_t* set, float x, float z, float reach, int level) {
+    // Hexagon circumradius is 50 units
+    float max_dist = reach + 50.0f;
+    float max_dist_sq = max_dist * max_dist;
+    int first, end;
+    hexagon_level_range(level, &first, &end);
+    
+    set->count = 0;
+    for(int hex_i = first; hex_i < end; hex_i++) {
+        hexagon_t* hex = &hexagons[hex_i];
+        if(!hexagon_on_level(hex, level)) continue;
+        float dx = hex->center_x - x;
+        float dz = hex->center_z - z;
+        if(dx*dx + dz*dz > max_dist_sq) continue;
+        
+        collision_gather_hex(set, hex);
+    }
+}
+
+// Offset from a hexagon's centre to each neighbour's (CONN_* order; the
+// same on every level)
+static const float neighbor_dx[6] = { 75.0f, 75.0f, 0.0f, -75.0f, -75.0f, 0.0f };
+static const float neighbor_dz[6] = { -43.3f, 43.3f, 86.6f, 43.3f, -43.3f, -86.6f };
+
+// Gather the segments of a hexagon and its six neighbours, skipping those
+// too far from (x, z) for a circle within reach of it to touch (tested
+// before a neighbour is looked up)
+void collision_gather_local(collision_set_t* set, int hex_idx, float x, float z, float reach) {
+    // Hexagon circumradius is 50 units
+    float max_dist = reach + 50.0f;
+    float max_dist_sq = max_dist * max_dist;
+    const hexagon_t* center = &hexagons[hex_idx];
+    
+    set->count = 0;
+    for(int dir = -1; dir < 6; dir++) {
+        float dx = center->center_x - x;
+        float dz = center->center_z - z;
+        if(dir >= 0) {
+            dx += neighbor_dx[dir];
+            dz += neighbor_dz[dir];
+        }
+        if(dx*dx + dz*dz > max_dist_sq) continue;
+        
+        int hex_i = dir < 0 ? hex_idx : hexagon_neighbor(hex_idx, dir);
+        if(hex_i >= 0) collision_gather_walls(set, &hexagons[hex_i], x, z, reach);
+    }
+}
+
+// Closest point on a segment to (px, pz)
+static void closest_point_on_segment(const collision_seg_t* seg, float px, float pz, float* cx, float* cz) {
+    float line_dx = seg->x2 - seg->x1;
+    float line_dz = seg->z2 - seg->z1;
+    float line_length_sq = line_dx * line_dx + line_dz * line_dz;
+    float t = 0.0f;
+    
+    if(line_length_sq > 0.001f) {
+        t = ((px - seg->x1) * line_dx + (pz - seg->z1) * line_dz) / line_length_sq;
+        if(t < 0.0f) t = 0.0f;
+        if(t > 1.0f) t = 1.0f;
+    }
+    
+    *cx = seg->x1 + t * line_dx;
+    *cz = seg->z1 + t * line_dz;
+}
+
+// Time of impact of a circle moving from (px, pz) by (dx, dz) against a round
+// endpoint - returns a value > 1 when there is no contact within the move
+static float sweep_endpoint(float px, float pz, float dx, float dz, float ex, float ez, float radius) {
+    float rel_x = px - ex;
+    float rel_z = pz - ez;
+    float a = dx*dx + dz*dz;
+    float b = 2.0f * (rel_x * dx + rel_z * dz);
+    float c = rel_x*rel_x + rel_z*rel_z - radius*radius;
+    
+    if(a < 0.000001f || c < 0.0f || b >= 0.0f) return 2.0f;  // Static, overlapping or moving away
+    
+    float disc = b*b - 4.0f*a*c;
+    if(disc < 0.0f) return 2.0f;
+    
+    return (-b - sqrtf(disc)) / (2.0f * a);
+}
+
+// Time of impact of a moving circle against one segment (capsule test)
+static float sweep_segment(const collision_seg_t* seg, float px, float pz, float dx, float dz, float radius, float* nx, float* nz) {
+    float best_t = 2.0f;
+    float edge_x = seg->x2 - seg->x1;
+    float edge_z = seg->z2 - seg->z1;
+    float edge_len = sqrtf(edge_x*edge_x + edge_z*edge_z);
+    
+    if(edge_len > 0.001f) {
+        // Flat side of the capsule: signed distance along the segment normal
+        float ux = edge_x / edge_len;
+        float uz = edge_z / edge_len;
+        float n_x = -uz;
+        float n_z = ux;
+        float side = (px - seg->x1) * n_x + (pz - seg->z1) * n_z;
+        float approach = dx * n_x + dz * n_z;
+        
+        if(side < 0.0f) {
+            side = -side; approach = -approach;
+            n_x = -n_x; n_z = -n_z;
+        }
+        
+        if(side >= radius && approach < -0.000001f) {
+            float t = (side - radius) / -approach;
+            float hit_x = px + dx * t;
+            float hit_z = pz + dz * t;
+            float along = (hit_x - seg->x1) * ux + (hit_z - seg->z1) * uz;
+            if(t <= 1.0f && along >= 0.0f && along <= edge_len) {
+                best_t = t;
+                *nx = n_x;
+                *nz = n_z;
+            }
+        }
+    }
+    
+    // Round caps at both endpoints (corners and doorway edges)
+    float ends_x[2] = { seg->x1, seg->x2 };
+    float ends_z[2] = { seg->z1, seg->z2 };
+    for(int i = 0; i < 2; i++) {
+        float t = sweep_endpoint(px, pz, dx, dz, ends_x[i], ends_z[i], radius);
+        if(t >= 0.0f && t < best_t) {
+            best_t = t;
+            *nx = (px + dx * t - ends_x[i]) / radius;
+            *nz = (pz + dz * t - ends_z[i]) / radius;
+        }
+    }
+    
+    return best_t;
+}
+
+// Push a circle out of any segment it already overlaps
+static void depenetrate(const collision_set_t* set, float* px, float* pz, float radius) {
+    for(int i = 0; i < set->count; i++) {
+        float cx, cz;
+        closest_point_on_segment(&set->segs[i], *px, *pz, &cx, &cz);
+        float dx = *px - cx;
+        float dz = *pz - cz;
+        float dist_sq = dx*dx + dz*dz;
+        
+        if(dist_sq < radius * radius && dist_sq > 0.000001f) {
+            float dist = sqrtf(dist_sq);
+            float push = radius + COLLISION_SKIN - dist;
+            *px += (dx / dist) * push;
+            *pz += (dz / dist) * push;
+        }
+    }
+}
+
+// Move a circle against a pre-gathered set, sliding along walls it meets.
+// Returns the number of contacts; *new_x/*new_z receive the resolved position.
+int collision_sweep(const collision_set_t* set, float old_x, float old_z, float *new_x, float *new_z, float radius, collision_hit_t* hit) {
+    float px = old_x;
+    float pz = old_z;
+    float dx = *new_x - old_x;
+    float dz = *new_z - old_z;
+    int contacts = 0;
+    
+    depenetrate(set, &px, &pz, radius);
+    
+    for(int iter = 0; iter < COLLISION_MAX_ITERATIONS; iter++) {
+        if(dx*dx + dz*dz < 0.000001f) break;
+        
+        // Bounds of this sweep, used to reject far segments cheaply
+        float min_x = (dx < 0.0f ? px + dx : px) - radius;
+        float max_x = (dx < 0.0f ? px : px + dx) + radius;
+        float min_z = (dz < 0.0f ? pz + dz : pz) - radius;
+        float max_z = (dz < 0.0f ? pz : pz + dz) + radius;
+        
+        // Earliest time of impact across the gathered set
+        float toi = 2.0f;
+        float nx = 0.0f, nz = 0.0f;
+        for(int i = 0; i < set->count; i++) {
+            const collision_seg_t* seg = &set->segs[i];
+            if((seg->x1 < min_x && seg->x2 < min_x) || (seg->x1 > max_x && seg->x2 > max_x) ||
+               (seg->z1 < min_z && seg->z2 < min_z) || (seg->z1 > max_z && seg->z2 > max_z)) continue;
+            
+            float seg_nx = 0.0f, seg_nz = 0.0f;
+            float t = sweep_segment(seg, px, pz, dx, dz, radius, &seg_nx, &seg_nz);
+            if(t < toi) {
+                toi = t;
+                nx = seg_nx;
+                nz = seg_nz;
+            }
+        }
+        
+        if(toi > 1.0f) {
+            // Free path for the rest of the move
+            px += dx;
+            pz += dz;
+            break;
+        }
+        
+        // Advance to the contact, keeping a small skin off the wall
+        px += dx * toi + nx * COLLISION_SKIN;
+        pz += dz * toi + nz * COLLISION_SKIN;
+        contacts++;
+        if(hit) {
+            hit->normal_x = nx;
+            hit->normal_z = nz;
+        }
+        
+        // Slide: drop the remaining motion's component into the wall
+        float rem_x = dx * (1.0f - toi);
+        float rem_z = dz * (1.0f - toi);
+        float into = rem_x * nx + rem_z * nz;
+        if(into < 0.0f) {
+            rem_x -= nx * into;
+            rem_z -= nz * into;
+        }
+        dx = rem_x;
+        dz = rem_z;
+    }
+    
+    if(hit) hit->contacts = contacts;
+    *new_x = px;
+    *new_z = pz;
+    return contacts;
+}
+
+// Swept move with sliding on a level: one gather, then iterate inside the
+// gathered set
+int collision_move(float old_x, float old_z, float *new_x, float *new_z, float radius, int level) {
+    collision_set_t set;
+    float dx = *new_x - old_x;
+    float dz = *new_z - old_z;
+    float half_move = 0.5f * sqrtf(dx*dx + dz*dz);
+    
+    // Circle around the midpoint that bounds the whole sweep
+    float mid_x = old_x + 0.5f * dx;
+    float mid_z = old_z + 0.5f * dz;
+    float reach = half_move + radius + COLLISION_SKIN;
+    
+    // Short moves stay within the current hexagon's neighbourhood (inner
+    // radius ~43 units); anything longer falls back to a map scan
+    int hex_idx = hexagon_at_position(old_x, old_z, level);
+    if(hex_idx >= 0 && 2.0f * reach < 43.0f) {
+        collision_gather_local(&set, hex_idx, mid_x, mid_z, reach);
+    } else {
+        collision_gather(&set, mid_x, mid_z, reach, level);
+    }
+    return collision_sweep(&set, old_x, old_z, new_x, new_z, radius, NULL);
+}
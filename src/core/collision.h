@@ -0,0 +1,36 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "hexagon.h"
+
+// Swept-circle solver limits
+#define COLLISION_MAX_SEGMENTS 96     // Wall segments gathered per move
+#define COLLISION_MAX_ITERATIONS 4    // Slide iterations per move
+#define COLLISION_SKIN 0.01f          // Separation kept from walls after contact
+
+// Blocking wall segment in world space (XZ plane)
+typedef struct {
+    float x1, z1;
+    float x2, z2;
+} collision_seg_t;
+
+// Wall segments gathered once around a move and reused for every slide
+typedef struct {
+    collision_seg_t segs[COLLISION_MAX_SEGMENTS];
+    int count;
+} collision_set_t;
+
+// Outcome of a swept move
+typedef struct {
+    int contacts;                // Number of walls touched (0 = free move)
+    float normal_x, normal_z;    // Contact normal of the last wall touched
+} collision_hit_t;
+
+// Swept-circle collision
+void collision_gather_hex(collision_set_t* set, const hexagon_t* hex);
+void collision_gather(collision_set_t* set, float x, float z, float reach, int level);
+void collision_gather_local(collision_set_t* set, int hex_idx, float x, float z, float reach);
+int collision_sweep(const collision_set_t* set, float old_x, float old_z, float *new_x, float *new_z, float radius, collision_hit_t* hit);
+int collision_move(float old_x, float old_z, float *new_x, float *new_z, float radius, int level);
+
+#endif // COLLISION_H
@@ -0,0 +1,243 @@
+#include "entity.h"
+#include <math.h>
+#include "collision.h"
+#include "arena.h"
+
+entity_world_t entities;
+entity_stats_t entity_stats;
+
+// Per-hex buckets rebuilt every tick with a counting sort:
+// bucket_start[h] .. bucket_start[h + 1] indexes bucket_items for hexagon h,
+// and the extra last bucket holds entities outside the map
+#define ENTITY_OUTSIDE_BUCKET MAP_HEX_COUNT
+static int32_t bucket_start[MAP_HEX_COUNT + 2];
+static int32_t bucket_items[ENTITY_MAX];
+
+// Reset the entity world
+void entity_init(void) {
+    arena_static(ARENA_ENTITY, sizeof(entities) + sizeof(bucket_start) + sizeof(bucket_items));
+    entities.count = 0;
+    entity_stats = (entity_stats_t){0};
+}
+
+// Add an entity on a level - returns its index or -1 when full
+int entity_spawn(entity_kind_t kind, float x, float z, int level, float vel_x, float vel_z, float radius) {
+    if(entities.count >= ENTITY_MAX) return -1;
+    
+    int id = entities.count++;
+    entities.pos_x[id] = x;
+    entities.pos_z[id] = z;
+    entities.vel_x[id] = vel_x;
+    entities.vel_z[id] = vel_z;
+    entities.radius[id] = radius;
+    entities.kind[id] = (uint8_t)kind;
+    entities.dead[id] = 0;
+    entities.level[id] = (uint8_t)level;
+    entities.hex[id] = hexagon_at_position(x, z, level);
+    return id;
+}
+
+// Bucket every entity by its current hexagon
+static void entity_build_buckets(void) {
+    for(int h = 0; h <= ENTITY_OUTSIDE_BUCKET + 1; h++) {
+        bucket_start[h] = 0;
+    }
+    
+    // Count entities per hexagon (shifted by one for the prefix sum), moving
+    // entities between levels as they walk ramps
+    for(int i = 0; i < entities.count; i++) {
+        int hex = hexagon_at_position(entities.pos_x[i], entities.pos_z[i], entities.level[i]);
+        if(hex >= 0) {
+            float floor_y = hexagon_floor_y(&hexagons[hex], entities.pos_x[i], entities.pos_z[i]);
+            entities.level[i] = (uint8_t)hexagon_level_at(&hexagons[hex], floor_y);
+        }
+        entities.hex[i] = hex;
+        bucket_start[(hex >= 0 ? hex : ENTITY_OUTSIDE_BUCKET) + 1]++;
+    }
+    
+    for(int h = 0; h <= ENTITY_OUTSIDE_BUCKET; h++) {
+        bucket_start[h + 1] += bucket_start[h];
+    }
+    
+    // Scatter into place (bucket_start[h] ends up at the next bucket's start)
+    for(int i = 0; i < entities.count; i++) {
+        int bucket = entities.hex[i] >= 0 ? entities.hex[i] : ENTITY_OUTSIDE_BUCKET;
+        bucket_items[bucket_start[bucket]++] = i;
+    }
+    
+    // Shift back so bucket_start[h] is the start of bucket h again
+    for(int h = ENTITY_OUTSIDE_BUCKET; h > 0; h--) {
+        bucket_start[h] = bucket_start[h - 1];
+    }
+    bucket_start[0] = 0;
+}
+
+// Wall contact response: projectiles are removed, patrollers reflect their
+// velocity about the contact normal
+void entity_hit_wall(int i, const collision_hit_t* hit) {
+    entity_stats.wall_contacts++;
+    
+    if(entities.kind[i] == ENTITY_PROJECTILE) {
+        entities.dead[i] = 1;
+        return;
+    }
+    
+    float into = entities.vel_x[i] * hit->normal_x + entities.vel_z[i] * hit->normal_z;
+    if(into < 0.0f) {
+        entities.vel_x[i] -= 2.0f * into * hit->normal_x;
+        entities.vel_z[i] -= 2.0f * into * hit->normal_z;
+    }
+}
+
+// Resolve all entities of one bucket against a shared wall set
+static void entity_resolve_walls(const collision_set_t* walls, int first, int last) {
+    for(int b = first; b < last; b++) {
+        int i = bucket_items[b];
+        float new_x = entities.pos_x[i] + entities.vel_x[i];
+        float new_z = entities.pos_z[i] + entities.vel_z[i];
+        collision_hit_t hit;
+        
+        if(collision_sweep(walls, entities.pos_x[i], entities.pos_z[i], &new_x, &new_z, entities.radius[i], &hit)) {
+            entity_hit_wall(i, &hit);
+        }
+        
+        entities.pos_x[i] = new_x;
+        entities.pos_z[i] = new_z;
+    }
+}
+
+// Entity-versus-entity test for one pair - returns 1 if they touched
+int entity_collide_pair(int i, int j) {
+    float dx = entities.pos_x[j] - entities.pos_x[i];
+    float dz = entities.pos_z[j] - entities.pos_z[i];
+    float min_dist = entities.radius[i] + entities.radius[j];
+    float dist_sq = dx*dx + dz*dz;
+    
+    if(dist_sq >= min_dist * min_dist) return 0;
+    entity_stats.entity_contacts++;
+    
+    // Projectiles are consumed by whatever they hit
+    if(entities.kind[i] == ENTITY_PROJECTILE || entities.kind[j] == ENTITY_PROJECTILE) {
+        if(entities.kind[i] == ENTITY_PROJECTILE) entities.dead[i] = 1;
+        if(entities.kind[j] == ENTITY_PROJECTILE) entities.dead[j] = 1;
+        return 1;
+    }
+    
+    float dist = sqrtf(dist_sq);
+    float nx = 1.0f, nz = 0.0f;
+    if(dist > 0.0001f) {
+        nx = dx / dist;
+        nz = dz / dist;
+    }
+    
+    // Separate equally, then exchange velocity along the contact normal
+    float push = 0.5f * (min_dist - dist);
+    entities.pos_x[i] -= nx * push;
+    entities.pos_z[i] -= nz * push;
+    entities.pos_x[j] += nx * push;
+    entities.pos_z[j] += nz * push;
+    
+    float rel = (entities.vel_x[j] - entities.vel_x[i]) * nx + (entities.vel_z[j] - entities.vel_z[i]) * nz;
+    if(rel < 0.0f) {
+        entities.vel_x[i] += rel * nx;
+        entities.vel_z[i] += rel * nz;
+        entities.vel_x[j] -= rel * nx;
+        entities.vel_z[j] -= rel * nz;
+    }
+    return 1;
+}
+
+// Entity-versus-entity tests between members of one bucket
+static void entity_resolve_pairs(int first, int last) {
+    for(int a = first; a < last; a++) {
+        for(int b = a + 1; b < last; b++) {
+            entity_collide_pair(bucket_items[a], bucket_items[b]);
+        }
+    }
+}
+
+// Entity-versus-entity tests between two neighbouring buckets, so entities
+// either side of a hexagon edge still collide
+static void entity_resolve_neighbor_pairs(int first, int last, int other_first, int other_last) {
+    for(int a = first; a < last; a++) {
+        for(int b = other_first; b < other_last; b++) {
+            entity_stats.neighbor_contacts += entity_collide_pair(bucket_items[a], bucket_items[b]);
+        }
+    }
+}
+
+// Drop dead entities by swapping the last live one into their slot
+void entity_compact(void) {
+    int i = 0;
+    while(i < entities.count) {
+        if(!entities.dead[i]) {
+            i++;
+            continue;
+        }
+        
+        int last = --entities.count;
+        entities.pos_x[i] = entities.pos_x[last];
+        entities.pos_z[i] = entities.pos_z[last];
+        entities.vel_x[i] = entities.vel_x[last];
+        entities.vel_z[i] = entities.vel_z[last];
+        entities.radius[i] = entities.radius[last];
+        entities.kind[i] = entities.kind[last];
+        entities.dead[i] = entities.dead[last];
+        entities.level[i] = entities.level[last];
+        entities.hex[i] = entities.hex[last];
+        entity_stats.removed++;
+    }
+}
+
+// Advance every entity by one simulation tick in a single batched pass
+void entity_update_tick(void) {
+    entity_stats = (entity_stats_t){0};
+    if(entities.count == 0) return;
+    
+    entity_build_buckets();
+    
+    collision_set_t walls;
+    for(int h = 0; h < MAP_HEX_COUNT; h++) {
+        int first = bucket_start[h];
+        int last = bucket_start[h + 1];
+        if(first == last) continue;
+        
+        // Walls first: one gather per occupied hexagon, shared by all its
+        // entities (a circle around the hexagon's centre holding every sweep)
+        float reach = 0.0f;
+        for(int b = first; b < last; b++) {
+            int i = bucket_items[b];
+            float extent = hypotf(entities.pos_x[i] - hexagons[h].center_x, entities.pos_z[i] - hexagons[h].center_z) +
+                           hypotf(entities.vel_x[i], entities.vel_z[i]) + entities.radius[i] + COLLISION_SKIN;
+            if(extent > reach) reach = extent;
+        }
+        entity_stats.buckets_used++;
+        collision_gather_local(&walls, h, hexagons[h].center_x, hexagons[h].center_z, reach);
+        entity_resolve_walls(&walls, first, last);
+    }
+    
+    // Then pairs, once every entity has moved: within each bucket, and
+    // against the buckets of its three forward neighbours (the other three
+    // see this bucket as one of theirs, so each pair is tested once)
+    for(int h = 0; h < MAP_HEX_COUNT; h++) {
+        int first = bucket_start[h];
+        int last = bucket_start[h + 1];
+        if(first == last) continue;
+        
+        entity_resolve_pairs(first, last);
+        for(int dir = 0; dir < 3; dir++) {
+            int neighbor = hexagon_neighbor(h, dir);
+            if(neighbor < 0 || bucket_start[neighbor] == bucket_start[neighbor + 1]) continue;
+            entity_resolve_neighbor_pairs(first, last, bucket_start[neighbor], bucket_start[neighbor + 1]);
+        }
+    }
+    
+    // Entities outside the map just drift (nothing to collide with)
+    for(int b = bucket_start[ENTITY_OUTSIDE_BUCKET]; b < bucket_start[ENTITY_OUTSIDE_BUCKET + 1]; b++) {
+        int i = bucket_items[b];
+        entities.pos_x[i] += entities.vel_x[i];
+        entities.pos_z[i] += entities.vel_z[i];
+    }
+    
+    entity_compact();
+}
@@ -0,0 +1,48 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include <stdint.h>
+#include "hexagon.h"
+#include "collision.h"
+
+#define ENTITY_MAX 1024
+
+// Entity kinds
+typedef enum {
+    ENTITY_PATROLLER = 0,        // Bounces off walls and other entities
+    ENTITY_PROJECTILE = 1        // Removed on first contact
+} entity_kind_t;
+
+// Structure-of-arrays entity storage (hot loops touch only what they need)
+typedef struct {
+    int count;
+    float pos_x[ENTITY_MAX], pos_z[ENTITY_MAX];
+    float vel_x[ENTITY_MAX], vel_z[ENTITY_MAX];    // Units per tick (keep under ~20 so sweeps stay local)
+    float radius[ENTITY_MAX];
+    uint8_t kind[ENTITY_MAX];
+    uint8_t dead[ENTITY_MAX];
+    uint8_t level[ENTITY_MAX];                      // Level walked on (follows ramps like the player)
+    int32_t hex[ENTITY_MAX];                        // Current hexagon (-1 = outside map)
+} entity_world_t;
+
+// Per-tick counters for the last update
+typedef struct {
+    int buckets_used;            // Hexagons holding at least one entity
+    int wall_contacts;
+    int entity_contacts;
+    int neighbor_contacts;       // Of which across a hexagon edge (neighbouring buckets)
+    int removed;
+} entity_stats_t;
+
+extern entity_world_t entities;
+extern entity_stats_t entity_stats;
+
+// Function prototypes
+void entity_init(void);
+int entity_spawn(entity_kind_t kind, float x, float z, int level, float vel_x, float vel_z, float radius);
+void entity_update_tick(void);
+void entity_hit_wall(int i, const collision_hit_t* hit);
+int entity_collide_pair(int i, int j);
+void entity_compact(void);
+
+#endif // ENTITY_H
@@ -0,0 +1,271 @@
+#include "geometry.h"
+#include <math.h>
+#include <string.h>
+#include "arena.h"
+
+uint32_t geometry_floor_piece[GEOMETRY_PIECE_KINDS][MAP_HEX_COUNT];
+uint8_t geometry_piece_light[GEOMETRY_PIECE_KINDS][MAP_HEX_COUNT][4];
+uint8_t geometry_wall_mask[MAP_HEX_COUNT];
+uint8_t geometry_shared_walls[MAP_HEX_COUNT];
+uint8_t geometry_two_sided_walls[MAP_HEX_COUNT];
+float geometry_edge_normal_x[6], geometry_edge_normal_z[6];
+float geometry_edge_offset[6];
+geometry_stats_t geometry_stats;
+
+// Lattice spacing between centres down a column (as hexagon_init) and the
+// hexagon template's half height
+#define GEOMETRY_SPACING_Z 86.6f
+#define GEOMETRY_HALF_HEIGHT 43.0f
+
+// Not yet assigned to a piece (no valid reference is all ones)
+#define GEOMETRY_PIECE_NONE 0xFFFFFFFFu
+
+// Corners of each part kind on the east and west lines of its strip or
+// column, north first (-1: none)
+static const int8_t part_line_corners[GEOMETRY_PIECE_KINDS][2][2] = {
+    { { 1, 5 }, { 2, 4 } },     // Column: both rectangle sides
+    { { 2, 4 }, { 3, -1 } },    // Left triangle: base east, apex west
+    { { 0, -1 }, { 1, 5 } },    // Right triangle: apex east, base west
+};
+
+static int floor_div(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Part at a position along a line on a level. Columns (line q) run by r.
+// The strip between columns line-1 and line runs by pos = 2r + q: even
+// offsets from the line are left triangles of column line, odd ones right
+// triangles of column line-1, alternating north to south.
+static int part_at(int strip, int line, int pos, int level, int* kind) {
+    if(!strip) {
+        *kind = GEOMETRY_PIECE_COLUMN;
+        return hexagon_lookup(line, pos, level);
+    }
+    if(((pos - line) & 1) == 0) {
+        *kind = GEOMETRY_PIECE_LEFT;
+        return hexagon_lookup(line, (pos - line) / 2, level);
+    }
+    *kind = GEOMETRY_PIECE_RIGHT;
+    return hexagon_lookup(line - 1, (pos - line + 1) / 2, level);
+}
+
+// Direction from a part's hexagon to the next part's hexagon (one step south)
+static int part_link_dir(int kind) {
+    if(kind == GEOMETRY_PIECE_COLUMN) return 5;    // S: rectangle below
+    if(kind == GEOMETRY_PIECE_LEFT) return 4;      // SW: its right triangle
+    return 0;                                      // SE: its left triangle
+}
+
+// Two parts merge when both are level room hexagons open to each other
+static int parts_linked(int a, int b, int dir) {
+    if(a < 0 || b < 0) return 0;
+    if(hexagons[a].type != HEX_TYPE_ROOM || hexagons[b].type != HEX_TYPE_ROOM) return 0;
+    if(hexagons[a].ramp_dir != HEXAGON_FLAT || hexagons[b].ramp_dir != HEXAGON_FLAT) return 0;
+    return (hexagons[a].connections & (1 << dir)) && (hexagons[b].connections & (1 << ((dir + 3) % 6)));
+}
+
+// Baked light of a run's end corners on one line (0 east, 1 west): its
+// first part's northmost corner there and its last part's southmost
+static void run_line_ends(const int* hex, const int* kind, int count, int side, int* top, int* bottom) {
+    const int8_t* last = part_line_corners[kind[count - 1]][side];
+    top[0] = hex[0];
+    top[1] = part_line_corners[kind[0]][side][0];
+    bottom[0] = hex[count - 1];
+    bottom[1] = last[1] >= 0 ? last[1] : last[0];
+}
+
+// A merged piece is Gouraud shaded from its end corners, so a run may only
+// grow while every corner along both lines stays within
+// GEOMETRY_LIGHT_TOLERANCE of the linear blend between them
+static int run_lit_linearly(const int* hex, const int* kind, int count) {
+    for(int side = 0; side < 2; side++) {
+        int top[2], bottom[2];
+        run_line_ends(hex, kind, count, side, top, bottom);
+        float z_top = hexagons[top[0]].vertices_z[top[1]];
+        float z_bottom = hexagons[bottom[0]].vertices_z[bottom[1]];
+        float light_top = map_corner_light[top[0]][top[1]];
+        float light_bottom = map_corner_light[bottom[0]][bottom[1]];
+        float slope = z_top > z_bottom ? (light_bottom - light_top) / (z_top - z_bottom) : 0.0f;
+        
+        for(int p = 0; p < count; p++) {
+            for(int c = 0; c < 2; c++) {
+                int v = part_line_corners[kind[p]][side][c];
+                if(v < 0) continue;
+                float expected = light_top + slope * (z_top - hexagons[hex[p]].vertices_z[v]);
+                if(fabsf(map_corner_light[hex[p]][v] - expected) > GEOMETRY_LIGHT_TOLERANCE) return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Assign pieces to the linked parts around one hexagon's part, within its
+// block: the segment is split greedily from its north end into runs that
+// keep their lighting linear, and every part gets its run's reference
+static void build_runs(int hex_idx, int kind) {
+    const hexagon_t* hex = &hexagons[hex_idx];
+    int strip = (kind != GEOMETRY_PIECE_COLUMN);
+    int line = hex->q + (kind == GEOMETRY_PIECE_RIGHT);
+    int pos = strip ? 2 * hex->r + hex->q : hex->r;
+    int block_len = strip ? 2 * GEOMETRY_RUN_HEXES : GEOMETRY_RUN_HEXES;
+    int block_start = floor_div(pos, block_len) * block_len;
+
+    // Walk north to the segment's first part
+    int start = pos, first = hex_idx, first_kind = kind;
+    while(start > block_start) {
+        int prev_kind;
+        int prev = part_at(strip, line, start - 1, hex->level, &prev_kind);
+        if(!parts_linked(prev, first, part_link_dir(prev_kind))) break;
+        start--;
+        first = prev;
+        first_kind = prev_kind;
+    }
+
+    // Collect it south to the end
+    int parts[2 * GEOMETRY_RUN_HEXES], kinds[2 * GEOMETRY_RUN_HEXES];
+    int count = 0;
+    parts[count] = first;
+    kinds[count++] = first_kind;
+    while(start + count < block_start + block_len) {
+        int next_kind;
+        int next = part_at(strip, line, start + count, hex->level, &next_kind);
+        if(!parts_linked(parts[count - 1], next, part_link_dir(kinds[count - 1]))) break;
+        parts[count] = next;
+        kinds[count++] = next_kind;
+    }
+
+    for(int s = 0; s < count; ) {
+        int e = s + 1;
+        while(e < count && run_lit_linearly(&parts[s], &kinds[s], e - s + 1)) e++;
+        if(s > 0) geometry_stats.lighting_splits++;
+        geometry_stats.floor_pieces++;
+
+        uint32_t ref = GEOMETRY_PIECE_REF(parts[s], kinds[s], e - s);
+        for(int p = s; p < e; p++) {
+            geometry_floor_piece[kinds[p]][parts[p]] = ref;
+        }
+
+        // Corner light in geometry_piece_corners order
+        uint8_t* light = geometry_piece_light[kinds[s]][parts[s]];
+        int top[2], bottom[2];
+        run_line_ends(&parts[s], &kinds[s], e - s, 0, top, bottom);
+        light[0] = map_corner_light[top[0]][top[1]];
+        light[3] = map_corner_light[bottom[0]][bottom[1]];
+        run_line_ends(&parts[s], &kinds[s], e - s, 1, top, bottom);
+        light[1] = map_corner_light[top[0]][top[1]];
+        light[2] = map_corner_light[bottom[0]][bottom[1]];
+        s = e;
+    }
+}
+
+// Edge normals from a hexagon at the origin: wall direction d runs from
+// vertex (d + 5) % 6 to vertex d
+static void build_edge_normals(void) {
+    hex_t origin_data = { 0 };
+    hexagon_t origin;
+    hexagon_init(&origin, &origin_data);
+
+    for(int dir = 0; dir < 6; dir++) {
+        int v1 = (dir + 5) % 6, v2 = dir;
+        float edge_x = origin.vertices_x[v2] - origin.vertices_x[v1];
+        float edge_z = origin.vertices_z[v2] - origin.vertices_z[v1];
+        float length = sqrtf(edge_x * edge_x + edge_z * edge_z);
+
+        // Vertices wind counter-clockwise, so outward is the edge turned clockwise
+        geometry_edge_normal_x[dir] = edge_z / length;
+        geometry_edge_normal_z[dir] = -edge_x / length;
+        geometry_edge_offset[dir] = geometry_edge_normal_x[dir] * origin.vertices_x[v2] +
+                                    geometry_edge_normal_z[dir] * origin.vertices_z[v2];
+    }
+}
+
+// Build the merged floor pieces and wall tables (call once the hexagon
+// lookup is built)
+void geometry_build(void) {
+    geometry_stats.floor_pieces = 0;
+    geometry_stats.shared_walls = 0;
+    geometry_stats.two_sided_walls = 0;
+    geometry_stats.lighting_splits = 0;
+    arena_static(ARENA_GEOMETRY, sizeof(geometry_floor_piece) + sizeof(geometry_piece_light) +
+                 sizeof(geometry_wall_mask) + sizeof(geometry_shared_walls) + sizeof(geometry_two_sided_walls));
+    build_edge_normals();
+    memset(geometry_floor_piece, 0xFF, sizeof(geometry_floor_piece));
+
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        for(int kind = 0; kind < GEOMETRY_PIECE_KINDS; kind++) {
+            if(geometry_floor_piece[kind][i] == GEOMETRY_PIECE_NONE) build_runs(i, kind);
+        }
+
+        const hexagon_t* hex = &hexagons[i];
+        geometry_wall_mask[i] = hex->type == HEX_TYPE_CORRIDOR ? 0x3F : (uint8_t)(~hex->connections & 0x3F);
+    }
+
+    // An edge both sides render the same way (two full walls, or two
+    // corridor doorways) is the same quads twice
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        const hexagon_t* hex = &hexagons[i];
+        geometry_shared_walls[i] = 0;
+        geometry_two_sided_walls[i] = 0;
+        for(int dir = 0; dir < 6; dir++) {
+            if(!(geometry_wall_mask[i] & (1 << dir))) continue;
+            int n = hexagon_neighbor(i, dir);
+            int opposite = (dir + 3) % 6;
+            if(n < 0) continue;  // Map edge: only ever seen from inside
+            if(!(geometry_wall_mask[n] & (1 << opposite))) {
+                geometry_two_sided_walls[i] |= 1 << dir;
+                geometry_stats.two_sided_walls++;
+                continue;
+            }
+
+            int door = (hex->connections & (1 << dir)) != 0;
+            int neighbor_door = (hexagons[n].connections & (1 << opposite)) != 0;
+            if(door != neighbor_door) continue;  // Different quads, each seen from its own side
+
+            // Beside a ramp the two sides stand on different floors (corner
+            // d is the neighbour's corner d + 2)
+            if(hexagon_corner_floor_y(hex, dir) != hexagon_corner_floor_y(&hexagons[n], (dir + 2) % 6) ||
+               hexagon_corner_floor_y(hex, (dir + 5) % 6) != hexagon_corner_floor_y(&hexagons[n], (dir + 3) % 6)) continue;
+            geometry_shared_walls[i] |= 1 << dir;
+            geometry_stats.shared_walls++;
+        }
+    }
+    geometry_stats.shared_walls /= 2;
+}
+
+// World corners (x, z) of a run of parts and their baked light,
+// counter-clockwise from the north-east; returns 4 for a rectangle or
+// trapezoid, 3 for a lone triangle
+int geometry_piece_corners(int anchor, int kind, int length, float* x, float* z, uint8_t* light) {
+    const hexagon_t* hex = &hexagons[anchor];
+    const uint8_t* piece_light = geometry_piece_light[kind][anchor];
+    float cx = hex->center_x, cz = hex->center_z;
+
+    if(kind == GEOMETRY_PIECE_COLUMN) {
+        for(int i = 0; i < 4; i++) light[i] = piece_light[i];
+        float bottom = cz - GEOMETRY_HALF_HEIGHT - GEOMETRY_SPACING_Z * (length - 1);
+        x[0] = cx + 25.0f; z[0] = cz + GEOMETRY_HALF_HEIGHT;
+        x[1] = cx - 25.0f; z[1] = cz + GEOMETRY_HALF_HEIGHT;
+        x[2] = cx - 25.0f; z[2] = bottom;
+        x[3] = cx + 25.0f; z[3] = bottom;
+        return 4;
+    }
+
+    // Strip between two vertical lines: triangles alternate between an apex
+    // on the west line (left triangles) and one on the east line (right)
+    int first_left = (kind == GEOMETRY_PIECE_LEFT);
+    int last_left = ((length - 1) & 1) ? !first_left : first_left;
+    float east = first_left ? cx - 25.0f : cx + 50.0f;
+    float west = first_left ? cx - 50.0f : cx + 25.0f;
+    float last_z = cz - 0.5f * GEOMETRY_SPACING_Z * (length - 1);
+
+    int n = 0;
+    light[n] = piece_light[0]; x[n] = east; z[n++] = cz + (first_left ? GEOMETRY_HALF_HEIGHT : 0.0f);
+    light[n] = piece_light[1]; x[n] = west; z[n++] = cz + (first_left ? 0.0f : GEOMETRY_HALF_HEIGHT);
+    if(length > 1 || !first_left) {
+        light[n] = piece_light[2]; x[n] = west; z[n++] = last_z - (last_left ? 0.0f : GEOMETRY_HALF_HEIGHT);
+    }
+    if(length > 1 || first_left) {
+        light[n] = piece_light[3]; x[n] = east; z[n++] = last_z - (last_left ? GEOMETRY_HALF_HEIGHT : 0.0f);
+    }
+    return n;
+}
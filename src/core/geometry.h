@@ -0,0 +1,81 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <stdint.h>
+#include "../generated/map_data.h"
+#include "hexagon.h"
+
+// Load-time geometry optimiser: merged floor/ceiling pieces and walls shared
+// by two hexagons (see geometry_build)
+//
+// A flat-top hexagon's floor is a central rectangle plus a triangle on its
+// left and right. Rectangles stacked down a column merge into one rectangle,
+// and the side triangles filling the zigzag strip between two columns merge
+// into one trapezoid, so an open room draws as a few convex quads instead of
+// a 4-triangle fan per hexagon. Pieces only grow across open connections
+// between room hexagons and stay inside fixed blocks of GEOMETRY_RUN_HEXES
+// hexagons, so they are small enough to be culled with their hexagons.
+// They are also cut where the baked corner light stops varying linearly
+// along them (by more than GEOMETRY_LIGHT_TOLERANCE of 255), since a piece
+// is shaded from its own corners only.
+#define GEOMETRY_RUN_HEXES 8
+#define GEOMETRY_LIGHT_TOLERANCE 12.0f
+
+typedef enum {
+    GEOMETRY_PIECE_COLUMN = 0,       // Central rectangle (column run)
+    GEOMETRY_PIECE_LEFT,             // West triangle (strip to the left)
+    GEOMETRY_PIECE_RIGHT,            // East triangle (strip to the right)
+    GEOMETRY_PIECE_KINDS
+} geometry_piece_kind_t;
+
+// Piece reference: the run's first (northmost) part, as anchor hexagon index,
+// the kind of part it contributes and the number of parts in the run (up to
+// 2 * GEOMETRY_RUN_HEXES, in 4 bits)
+#define GEOMETRY_PIECE_REF(anchor, kind, length) (((uint32_t)(anchor) << 6) | ((kind) << 4) | ((length) - 1))
+#define GEOMETRY_PIECE_ANCHOR(ref) ((int)((ref) >> 6))
+#define GEOMETRY_PIECE_KIND(ref) ((int)(((ref) >> 4) & 3))
+#define GEOMETRY_PIECE_LENGTH(ref) ((int)((ref) & 15) + 1)
+
+// Piece each hexagon's parts belong to, per part kind
+extern uint32_t geometry_floor_piece[GEOMETRY_PIECE_KINDS][MAP_HEX_COUNT];
+
+// Baked light of each piece's corners, on its anchor part: east line top,
+// west top, west bottom, east bottom
+extern uint8_t geometry_piece_light[GEOMETRY_PIECE_KINDS][MAP_HEX_COUNT][4];
+
+// Wall sides that render per hexagon (closed sides, plus every side of a
+// corridor as doorways), and those of them the neighbour across the edge
+// draws identically - only one copy needs submitting
+extern uint8_t geometry_wall_mask[MAP_HEX_COUNT];
+extern uint8_t geometry_shared_walls[MAP_HEX_COUNT];
+
+// Rendered sides that must stay two-sided for back-face culling: the
+// neighbour across the edge is open to it without drawing the edge itself
+// (a corridor doorway seen from the room it opens into)
+extern uint8_t geometry_two_sided_walls[MAP_HEX_COUNT];
+
+// Outward unit normal of each wall direction and the edge's distance from
+// the hexagon centre along it (identical for every hexagon)
+extern float geometry_edge_normal_x[6], geometry_edge_normal_z[6];
+extern float geometry_edge_offset[6];
+
+// A wall side faces a point on the inner side of its edge
+static inline int geometry_wall_faces(const hexagon_t* hex, int dir, float x, float z) {
+    return geometry_edge_normal_x[dir] * (x - hex->center_x) +
+           geometry_edge_normal_z[dir] * (z - hex->center_z) < geometry_edge_offset[dir];
+}
+
+typedef struct {
+    int floor_pieces;                // Distinct floor pieces (one per hexagon part unmerged)
+    int shared_walls;                // Edges drawn from both sides before deduplication
+    int two_sided_walls;             // Sides exempt from back-face culling
+    int lighting_splits;             // Runs cut to keep their lighting linear
+} geometry_stats_t;
+
+extern geometry_stats_t geometry_stats;
+
+// Function prototypes
+void geometry_build(void);
+int geometry_piece_corners(int anchor, int kind, int length, float* x, float* z, uint8_t* light);
+
+#endif // GEOMETRY_H
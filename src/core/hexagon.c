@@ -1,4 +1,11 @@
 #include "hexagon.h"
+#include <math.h>
+#include "arena.h"
+
+int hexagon_level_count = 1;
+
+// ramp_dir of a ramp until hexagon_build_lookup finds its top
+#define HEX_RAMP_UNRESOLVED 6
 
 // Standard hexagon vertices relative to center (flat-top orientation)
 static const float hex_template_x[6] = { 50.0f, 25.0f, -25.0f, -50.0f, -25.0f, 25.0f };
@@ -24,12 +31,195 @@ void hexagon_init(hexagon_t* hex, const hex_t* map_data) {
     hex->center_x = spacing_x * map_data->q;
     hex->center_z = -spacing_z * (map_data->r + map_data->q * 0.5f);
     
+    hex->q = map_data->q;
+    hex->r = map_data->r;
     hex->connections = map_data->connections;
     hex->type = map_data->type;
     
+    // Level from the map height; a ramp's direction is resolved by
+    // hexagon_build_lookup, which needs the other hexagons
+    int level = map_data->height / HEX_HEIGHT_SCALE - 1;
+    hex->level = level < 0 ? 0 : (level >= HEXAGON_MAX_LEVELS ? HEXAGON_MAX_LEVELS - 1 : level);
+    hex->ramp_dir = (map_data->height % HEX_HEIGHT_SCALE) ? HEX_RAMP_UNRESOLVED : HEXAGON_FLAT;
+    
     // Calculate world vertices
     for(int i = 0; i < 6; i++) {
         hex->vertices_x[i] = hex->center_x + hex_template_x[i];
         hex->vertices_z[i] = hex->center_z + hex_template_z[i];
     }
-}
\ No newline at end of file
+}
+
+// Axial offsets per direction, matching the CONN_* bit order
+static const int8_t hex_dir_q[6] = { 1, 1, 0, -1, -1, 0 };
+static const int8_t hex_dir_r[6] = { 0, -1, -1, 0, 1, 1 };
+
+// Floor height at a world position over the hexagon. A ramp's floor is the
+// plane through its edges: level at the low edge, one level up at the top
+// edge (86.6 units further along the direction between them). Away from
+// the hexagon this is still the plane's height, which may be off its levels.
+float hexagon_floor_y(const hexagon_t* hex, float x, float z) {
+    float y = hexagon_level_floor(hex->level);
+    if(hex->ramp_dir == HEXAGON_FLAT) return y;
+    
+    int dir = hex->ramp_dir;
+    float dir_x = 75.0f * hex_dir_q[dir] / 86.6f;
+    float dir_z = -(hex_dir_r[dir] + 0.5f * hex_dir_q[dir]);
+    float rise = 0.5f + ((x - hex->center_x) * dir_x + (z - hex->center_z) * dir_z) / 86.6f;
+    return y + rise * HEXAGON_LEVEL_HEIGHT;
+}
+
+// Floor height at a corner (exact, so it matches the neighbours' corners)
+float hexagon_corner_floor_y(const hexagon_t* hex, int corner) {
+    float y = hexagon_level_floor(hex->level);
+    if(hex->ramp_dir == HEXAGON_FLAT) return y;
+    
+    // Corners d - 1 and d bound the top edge, d + 2 and d + 3 the low edge
+    int k = (corner - hex->ramp_dir + 6) % 6;
+    float rise = (k == 0 || k == 5) ? 1.0f : (k == 2 || k == 3) ? 0.0f : 0.5f;
+    return y + rise * HEXAGON_LEVEL_HEIGHT;
+}
+
+// Level a floor height on the hexagon belongs to: a ramp's upper half is
+// on the level above
+int hexagon_level_at(const hexagon_t* hex, float y) {
+    if(hex->ramp_dir == HEXAGON_FLAT) return hex->level;
+    return hex->level + (y - hexagon_level_floor(hex->level) > 0.5f * HEXAGON_LEVEL_HEIGHT);
+}
+
+// Open-addressing table from (q, r, level) to hexagon index (-1 = empty slot)
+#define HEX_LOOKUP_SIZE (MAP_HEX_COUNT * 2 + 1)
+static int32_t hex_lookup_table[HEX_LOOKUP_SIZE];
+
+// Hexagons are ordered by sort key 2 * level + (ramp); first index of each
+// key, if they are (see hexagon_level_range)
+#define HEX_LEVEL_KEYS (2 * HEXAGON_MAX_LEVELS)
+static int32_t hex_key_start[HEX_LEVEL_KEYS + 1];
+static int hex_levels_sorted;
+
+static uint32_t hex_lookup_hash(int q, int r, int level) {
+    uint32_t key = ((uint32_t)(uint16_t)q << 16) | (uint16_t)r;
+    return (key * 2654435761u + (uint32_t)level * 0x9E3779B9u) % HEX_LOOKUP_SIZE;
+}
+
+// Build the coordinate lookup table from hexagons[]
+void hexagon_build_lookup(void) {
+    for(int i = 0; i < HEX_LOOKUP_SIZE; i++) {
+        hex_lookup_table[i] = -1;
+    }
+    
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        uint32_t slot = hex_lookup_hash(hexagons[i].q, hexagons[i].r, hexagons[i].level);
+        while(hex_lookup_table[slot] >= 0) {
+            slot = (slot + 1) % HEX_LOOKUP_SIZE;
+        }
+        hex_lookup_table[slot] = i;
+    }
+    
+    // A ramp rises towards its connected neighbour one level up that connects
+    // back; one with no way up has a level floor
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        hexagon_t* hex = &hexagons[i];
+        if(hex->ramp_dir == HEXAGON_FLAT) continue;
+        
+        hex->ramp_dir = HEXAGON_FLAT;
+        for(int dir = 0; dir < 6; dir++) {
+            if(!(hex->connections & (1 << dir))) continue;
+            int up = hexagon_lookup(hex->q + hex_dir_q[dir], hex->r + hex_dir_r[dir], hex->level + 1);
+            if(up >= 0 && (hexagons[up].connections & (1 << ((dir + 3) % 6)))) {
+                hex->ramp_dir = dir;
+                break;
+            }
+        }
+    }
+    
+    // Level ranges (the map tools emit hexagons sorted this way)
+    int key_count[HEX_LEVEL_KEYS] = { 0 };
+    int last_key = 0;
+    hex_levels_sorted = 1;
+    hexagon_level_count = 1;
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        int key = 2 * hexagons[i].level + (hexagons[i].ramp_dir != HEXAGON_FLAT);
+        if(key < last_key) hex_levels_sorted = 0;
+        last_key = key;
+        key_count[key]++;
+        if(hexagons[i].level >= hexagon_level_count) hexagon_level_count = hexagons[i].level + 1;
+    }
+    hex_key_start[0] = 0;
+    for(int key = 0; key < HEX_LEVEL_KEYS; key++) {
+        hex_key_start[key + 1] = hex_key_start[key] + key_count[key];
+    }
+    
+    // Map memory: hexagons, the map tables (hexagons and corner light) and this grid
+    arena_static(ARENA_MAP, sizeof(hexagons) + MAP_HEX_COUNT * (sizeof(hex_t) + 6) + sizeof(hex_lookup_table) +
+                 sizeof(hex_key_start));
+}
+
+// Find hexagon index at axial coordinates on a level (-1 if none)
+int hexagon_lookup(int q, int r, int level) {
+    uint32_t slot = hex_lookup_hash(q, r, level);
+    while(hex_lookup_table[slot] >= 0) {
+        const hexagon_t* hex = &hexagons[hex_lookup_table[slot]];
+        if(hex->q == q && hex->r == r && hex->level == level) return hex_lookup_table[slot];
+        slot = (slot + 1) % HEX_LOOKUP_SIZE;
+    }
+    return -1;
+}
+
+// Neighbouring hexagon in a wall direction (-1 if none): on the same level,
+// or across a ramp's top edge the hexagon one level up, and from there back
+// onto the ramp one level down
+int hexagon_neighbor(int hex_idx, int dir) {
+    const hexagon_t* hex = &hexagons[hex_idx];
+    int q = hex->q + hex_dir_q[dir], r = hex->r + hex_dir_r[dir];
+    int level = hex->level + (hex->ramp_dir == dir);
+    
+    int neighbor = hexagon_lookup(q, r, level);
+    if(neighbor < 0 && level > 0) {
+        neighbor = hexagon_lookup(q, r, level - 1);
+        if(neighbor >= 0 && hexagons[neighbor].ramp_dir != (dir + 3) % 6) neighbor = -1;
+    }
+    return neighbor;
+}
+
+// Index range [first, end) of hexagons[] holding every hexagon on a level
+// (hexagon_on_level): the ramps up to it, its own hexagons, then its ramps.
+// The whole map if the hexagons are not in level order.
+void hexagon_level_range(int level, int* first, int* end) {
+    if(!hex_levels_sorted || level < 0 || level >= HEXAGON_MAX_LEVELS) {
+        *first = 0;
+        *end = MAP_HEX_COUNT;
+        return;
+    }
+    *first = hex_key_start[level > 0 ? 2 * level - 1 : 0];
+    *end = hex_key_start[2 * level + 2];
+}
+
+// Hexagon containing a world position on a level, or the ramp up to it
+// (-1 if outside the map)
+int hexagon_at_position(float x, float z, int level) {
+    // Invert the axial -> world mapping used by hexagon_init
+    float fq = x / 75.0f;
+    float fr = -z / 86.6f - fq * 0.5f;
+    float fs = -fq - fr;
+    
+    // Cube rounding to the nearest hexagon
+    int q = (int)floorf(fq + 0.5f);
+    int r = (int)floorf(fr + 0.5f);
+    int s = (int)floorf(fs + 0.5f);
+    float dq = fabsf(q - fq);
+    float dr = fabsf(r - fr);
+    float ds = fabsf(s - fs);
+    
+    if(dq > dr && dq > ds) {
+        q = -r - s;
+    } else if(dr > ds) {
+        r = -q - s;
+    }
+    
+    int hex = hexagon_lookup(q, r, level);
+    if(hex < 0 && level > 0) {
+        hex = hexagon_lookup(q, r, level - 1);
+        if(hex >= 0 && hexagons[hex].ramp_dir == HEXAGON_FLAT) hex = -1;
+    }
+    return hex;
+}
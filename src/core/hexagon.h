@@ -4,16 +4,56 @@
 #include <stdint.h>
 #include "../generated/map_data.h"
 
+// Levels: dungeons stack floors, each HEXAGON_LEVEL_HEIGHT above the last.
+// A hexagon's map height is (level + 1) * HEX_HEIGHT_SCALE, or half a step
+// more for a ramp - a corridor hexagon whose floor rises one level across
+// it, from the connected hexagon on its level to the one on the level above.
+// A ramp fills its cell on both levels; it is on both (hexagon_on_level).
+#define HEXAGON_LEVEL_HEIGHT 32.0f   // Floor to floor (walls plus a 12-unit slab)
+#define HEXAGON_WALL_HEIGHT 20.0f    // Floor to ceiling
+#define HEXAGON_EYE_HEIGHT 10.0f     // Camera above the floor
+#define HEXAGON_MAX_LEVELS 16
+#define HEXAGON_FLAT -1              // ramp_dir of a hexagon with a level floor
+
 // Hexagon object - pure geometry and data
 typedef struct {
     float center_x, center_z;    // World position (converted from fixed-point)
+    int16_t q, r;                // Axial grid coordinates
     uint8_t connections;         // Connection bitmask from map data
     uint8_t type;               // Room/corridor type
+    uint8_t level;              // Floor level (0 = ground)
+    int8_t ramp_dir;            // Wall direction a ramp rises towards (HEXAGON_FLAT if level)
     float vertices_x[6];        // Calculated world vertices
     float vertices_z[6];        // Calculated world vertices
 } hexagon_t;
 
+// Map hexagons (defined in main.c)
+extern hexagon_t hexagons[MAP_HEX_COUNT];
+
+// Levels in the map (set by hexagon_build_lookup)
+extern int hexagon_level_count;
+
+// A hexagon is on its own level, and a ramp also on the one it rises to
+static inline int hexagon_on_level(const hexagon_t* hex, int level) {
+    return hex->level == level || (hex->ramp_dir != HEXAGON_FLAT && hex->level + 1 == level);
+}
+
+// Floor height of a level
+static inline float hexagon_level_floor(int level) {
+    return level * HEXAGON_LEVEL_HEIGHT;
+}
+
 // Function prototypes
 void hexagon_init(hexagon_t* hex, const hex_t* map_data);
+float hexagon_floor_y(const hexagon_t* hex, float x, float z);
+float hexagon_corner_floor_y(const hexagon_t* hex, int corner);
+int hexagon_level_at(const hexagon_t* hex, float y);
+
+// Spatial lookup (call hexagon_build_lookup once all hexagons are initialised)
+void hexagon_build_lookup(void);
+int hexagon_lookup(int q, int r, int level);
+int hexagon_neighbor(int hex_idx, int dir);
+int hexagon_at_position(float x, float z, int level);
+void hexagon_level_range(int level, int* first, int* end);
 
-#endif // HEXAGON_H
\ No newline at end of file
+#endif // HEXAGON_H
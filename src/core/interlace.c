@@ -0,0 +1,101 @@
+#include "interlace.h"
+#include <rdpq.h>
+#include <rdpq_mode.h>
+#include <rdpq_tex.h>
+#include "texture.h"
+
+interlace_t interlace = {
+    .enabled = 1,
+    .recon = INTERLACE_WEAVE,
+};
+
+// SET_SCISSOR field bits: write only every other line, the odd ones if set
+#define SCISSOR_FIELD (1u << 25)
+#define SCISSOR_KEEP_ODD (1u << 24)
+
+// rdpq_set_scissor without the field bits; its command fixup (which adjusts
+// the rectangle per cycle type) keeps them
+extern void __rdpq_set_scissor(uint32_t w0, uint32_t w1);
+
+static const char* recon_names[INTERLACE_RECON_COUNT] = {
+    [INTERLACE_WEAVE] = "weave",
+    [INTERLACE_BOB] = "bob",
+};
+
+// Scissor to [x0, x1) x [y0, y1), writing only the lines of one field (0 even,
+// 1 odd); rdpq_set_scissor, rdpq_attach and rdpq_clear_z all restore a plain
+// scissor. Coordinates are 10.2 fixed point, as rdpq_set_scissor sends them.
+void interlace_set_scissor(int x0, int y0, int x1, int y1, int field) {
+    __rdpq_set_scissor(((uint32_t)(x0 * 4) & 0xFFF) << 12 | ((uint32_t)(y0 * 4) & 0xFFF),
+                       SCISSOR_FIELD | (field ? SCISSOR_KEEP_ODD : 0) |
+                       ((uint32_t)(x1 * 4) & 0xFFF) << 12 | ((uint32_t)(y1 * 4) & 0xFFF));
+}
+
+// Forget the previous frame (call after the display is re-initialised, its
+// buffers are gone); the next frame is bobbed
+void interlace_reset(void) {
+    interlace.prev_frame = NULL;
+}
+
+// Advance to the other field for the frame about to be drawn; returns it.
+// With two display buffers each buffer always gets the same field, so a
+// weave reads the other one.
+int interlace_next_field(void) {
+    interlace.field = !interlace.field;
+    return interlace.field;
+}
+
+// Copy lines [y0, y0 + lines) of src to the same lines of the attached frame
+// shifted by dy (the field scissor keeps only the lines not drawn)
+static void blit_lines(const surface_t* src, int y0, int lines, int dy) {
+    if(lines <= 0) return;
+    rdpq_tex_blit(src, 0, y0 + dy, &(rdpq_blitparms_t){
+        .t0 = y0,
+        .height = lines,
+    });
+}
+
+// Fill in the lines of the field not drawn this frame (call with the RDP
+// attached to frame, after the world is drawn under interlace_set_scissor
+// and before overlays): bob copies each drawn line to the missing line next
+// to it, weave copies the missing lines from the previous frame (the top
+// INTERLACE_OVERLAY_LINES, and a frame with no previous one, are bobbed)
+void interlace_reconstruct(const surface_t* frame) {
+    int field = interlace.field;
+    int width = frame->width, height = frame->height;
+    
+    // Copy mode moves 4 pixels per cycle but has no 32-bit path
+    if(surface_get_format(frame) == FMT_RGBA32) {
+        rdpq_set_mode_standard();
+        rdpq_mode_combiner(RDPQ_COMBINER_TEX);
+    } else {
+        rdpq_set_mode_copy(false);
+    }
+    interlace_set_scissor(0, 0, width, height, !field);
+    
+    // Bob: missing line 2k + 1 takes drawn line 2k (even field), missing
+    // line 2k takes drawn line 2k + 1 (odd field)
+    int weave = interlace.recon == INTERLACE_WEAVE && interlace.prev_frame &&
+                interlace.prev_frame != frame;
+    int bob_lines = weave ? INTERLACE_OVERLAY_LINES : height;
+    if(field) {
+        blit_lines(frame, 1, bob_lines - 1, -1);
+    } else {
+        blit_lines(frame, 0, bob_lines - 1, 1);
+    }
+    if(weave) {
+        blit_lines(interlace.prev_frame, bob_lines, height - bob_lines, 0);
+    }
+    
+    texture_invalidate();  // The blits loaded TMEM over resident textures
+    rdpq_set_scissor(0, 0, width, height);
+}
+
+// Record the frame just passed to display_show as the next weave source
+void interlace_shown(const surface_t* frame) {
+    interlace.prev_frame = frame;
+}
+
+const char* interlace_recon_name(interlace_recon_t recon) {
+    return recon_names[recon];
+}
@@ -0,0 +1,45 @@
+#ifndef INTERLACE_H
+#define INTERLACE_H
+
+#include <libdragon.h>
+
+// Interlaced field rendering for the 640x480 display: each frame draws only
+// one field's lines (even and odd in turn) at about the fill cost of a
+// 640x240 frame, using the RDP's scissor field mode on the full-height
+// framebuffer. (A half-height view with a doubled line stride is not
+// addressable: the RDP's image width, which is the stride, stops at 1024
+// pixels.) The other field's lines are then rebuilt with one RDP copy:
+//   - weave: from the previous frame, which drew that field (full 480-line
+//     detail while the view holds still, moving edges comb by one frame)
+//   - bob: from this frame's field, one line over (240-line detail, no
+//     combing)
+// Overlays drawn over the top lines every frame (debug text, minimap) would
+// leave the previous frame's copy behind in a weave, so those lines are
+// always bobbed. Every frame shown holds both fields, so it does not matter
+// which one the VI scans out first.
+typedef enum {
+    INTERLACE_WEAVE = 0,
+    INTERLACE_BOB,
+    INTERLACE_RECON_COUNT
+} interlace_recon_t;
+
+#define INTERLACE_OVERLAY_LINES 80   // Top lines always bobbed (covers debug text and minimap)
+
+typedef struct {
+    int enabled;                     // Field rendering at 640x480 (B toggles)
+    interlace_recon_t recon;         // Reconstruction of the other field (A cycles)
+    int field;                       // Field of the frame being drawn: 0 even lines, 1 odd
+    const surface_t* prev_frame;     // Last frame shown (weave source), or NULL
+} interlace_t;
+
+extern interlace_t interlace;
+
+// Function prototypes
+void interlace_set_scissor(int x0, int y0, int x1, int y1, int field);
+void interlace_reset(void);
+int interlace_next_field(void);
+void interlace_reconstruct(const surface_t* frame);
+void interlace_shown(const surface_t* frame);
+const char* interlace_recon_name(interlace_recon_t recon);
+
+#endif // INTERLACE_H
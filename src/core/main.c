@@ -6,268 +6,437 @@
 #include <rdpq_mode.h>
 #include "../generated/map_data.h"
 #include "hexagon.h"
+#include "map_loader.h"
 #include "render.h"
+#include "sim.h"
+#include "entity.h"
+#include "nav.h"
+#include "autowalk.h"
+#include "minimap.h"
+#include "geometry.h"
+#include "texture.h"
+#include "arena.h"
+#include "interlace.h"
+#ifdef ENCOM_RSP_GL
+#include <GL/gl_integration.h>
+#include "render_rsp.h"
+#endif
 
 static resolution_t res = RESOLUTION_320x240;
 static bitdepth_t bit = DEPTH_32_BPP;
 
-static int camera_yaw = 0;   // Horizontal rotation (integer degrees)
-static float player_x = 0.0f;  // Player position in room
-static float player_z = 0.0f;
+// Simulation states bracketing the current render time, one per split-screen
+// player (player 1 drives auto-walk and the minimap)
+static player_state_t player_prev[RENDER_MAX_VIEWS];
+static player_state_t player_curr[RENDER_MAX_VIEWS];
+
+// Split-screen views (Z cycles 1, 2, 4; player N uses controller port N)
+static int view_count = 1;
+
+// Auto-walk tour (START toggles) for hands-off soak/benchmark runs
+static autowalk_t autowalk;
+static uint32_t autowalk_ticks = 0;
+
+// Z-buffer surface while render_zbuffer is on (C-right toggles), sized to
+// the display and charged to its memory budget
+static surface_t zbuffer;
+
+// Scene shown by the current front buffer (idle frames re-present it); a
+// woven field frame is complete once both fields were drawn from the scene
+static scene_key_t shown_scene;
+static int shown_scene_valid = 0;
+static int shown_scene_complete = 0;
+
+#ifdef ENCOM_RSP_GL
+// Vertex transform backend (L toggles, R validates/benchmarks against the CPU path)
+static render_backend_t render_backend = RENDER_BACKEND_CPU;
+#endif
 
 // Hexagon objects for all map hexagons
 hexagon_t hexagons[MAP_HEX_COUNT];
 
 
+// Reallocate the Z-buffer for the current resolution, or free it when
+// Z-buffering is off; Z-buffering stays off if it would exceed its budget
+static void zbuffer_update(void)
+{
+    surface_free(&zbuffer);
+    arena_static(ARENA_ZBUFFER, 0);
+    if(!render_zbuffer) return;
+    
+    size_t bytes = res.width * res.height * sizeof(uint16_t);
+    if(bytes > arena_budgets[ARENA_ZBUFFER].limit) {
+        debugf("Z-buffer: %dx%d needs %u KB, over its %lu KB budget\n", res.width, res.height,
+               (unsigned)(bytes / 1024), (unsigned long)(arena_budgets[ARENA_ZBUFFER].limit / 1024));
+        render_zbuffer = 0;
+        return;
+    }
+    zbuffer = surface_alloc(FMT_RGBA16, res.width, res.height);
+    arena_static(ARENA_ZBUFFER, bytes);
+}
+
 int main(void)
 {
     /* Initialize peripherals */
+    uint32_t startup_ticks = get_ticks();
+    arena_init();
     display_init( res, bit, 2, GAMMA_NONE, FILTERS_RESAMPLE );
     dfs_init( DFS_DEFAULT_LOCATION );
     joypad_init();
     rdpq_init();
+    uint32_t init_ticks = get_ticks();
 
-    /* Initialize all hexagons from map data */
+    /* Initialize all hexagons from map data (large maps load from a DFS blob) */
+    map_load_info_t map_info = { 0, 0 };
+#ifdef MAP_LOAD_COMPARE
+    /* Same blob stored uncompressed, timed for the startup report */
+    map_load_info_t raw_info = { 0, 0 };
+    uint32_t raw_ticks = get_ticks();
+    int raw_status = map_load("rom:/" MAP_BLOB_RAW_FILE, &raw_info);
+    assertf(raw_status == 0, "Cannot load map blob rom:/%s", MAP_BLOB_RAW_FILE);
+    raw_ticks = get_ticks() - raw_ticks;
+    init_ticks = get_ticks();
+#endif
+#ifdef MAP_BLOB_FILE
+    /* The hexagons are empty without the blob, so a failed load is fatal */
+    int map_status = map_load("rom:/" MAP_BLOB_FILE, &map_info);
+    assertf(map_status == 0, "Cannot load map blob rom:/%s", MAP_BLOB_FILE);
+#endif
+    uint32_t load_ticks = get_ticks();
     for(int i = 0; i < MAP_HEX_COUNT; i++) {
         hexagon_init(&hexagons[i], &map_hexagons[i]);
     }
+    hexagon_build_lookup();
+    geometry_build();
+    minimap_init();
+    texture_init();
+    render_init();
+    uint32_t hex_ticks = get_ticks();
+    entity_init();
+    nav_init();
+#ifdef ENCOM_RSP_GL
+    gl_init();
+    render_rsp_init();
+#endif
+    uint32_t ready_ticks = get_ticks();
 
+    /* Startup timing report */
+    debugf("Startup (%d hexes): init %lu us, map load %lu us (%lu bytes stored, %lu raw), "
+           "hexagons %lu us, nav/entities %lu us\n", MAP_HEX_COUNT,
+           (unsigned long)TICKS_TO_US(init_ticks - startup_ticks),
+           (unsigned long)TICKS_TO_US(load_ticks - init_ticks),
+           (unsigned long)map_info.stored_bytes, (unsigned long)map_info.raw_bytes,
+           (unsigned long)TICKS_TO_US(hex_ticks - load_ticks),
+           (unsigned long)TICKS_TO_US(ready_ticks - hex_ticks));
+    debugf("Geometry: %d floor pieces (%d hexagon parts, %d cuts for lighting), %d shared walls, %d two-sided\n",
+           geometry_stats.floor_pieces, MAP_HEX_COUNT * GEOMETRY_PIECE_KINDS, geometry_stats.lighting_splits,
+           geometry_stats.shared_walls, geometry_stats.two_sided_walls);
+    arena_report();
+#ifdef MAP_LOAD_COMPARE
+    debugf("Map load: compressed %lu us (%lu bytes), raw %lu us (%lu bytes)\n",
+           (unsigned long)TICKS_TO_US(load_ticks - init_ticks), (unsigned long)map_info.stored_bytes,
+           (unsigned long)TICKS_TO_US(raw_ticks), (unsigned long)raw_info.stored_bytes);
+#endif
+
+    /* Fixed-timestep accumulator (in CPU ticks) */
+    uint32_t last_ticks = get_ticks();
+    uint32_t sim_accumulator = 0;
 
     /* Main loop test */
     while(1) 
     {
-        char tStr[256];
         static display_context_t disp = 0;
 
-        /* Grab a render buffer */
-        disp = display_get();
-       
-        /*Fill the screen */
-        graphics_fill_screen( disp, 0 );
-
-        /* Handle analog stick input for camera yaw */
+        /* Handle analog stick input (applied to every simulation tick) */
         joypad_poll();
         joypad_inputs_t joypad = joypad_get_inputs(JOYPAD_PORT_1);
-        
-        // Analog stick X controls yaw (left/right look)
-        if(joypad.stick_x > 30 || joypad.stick_x < -30) {
-            camera_yaw -= joypad.stick_x / 20;  // Right stick = clockwise (positive yaw)
-            while(camera_yaw >= 360) camera_yaw -= 360;
-            while(camera_yaw < 0) camera_yaw += 360;
+        sim_input_t inputs[RENDER_MAX_VIEWS];
+        for(int p = 0; p < view_count; p++) {
+            joypad_inputs_t pad = joypad_get_inputs(JOYPAD_PORT_1 + p);
+            inputs[p] = (sim_input_t){ .stick_x = pad.stick_x, .stick_y = pad.stick_y };
         }
         
-        // Analog stick Y controls forward/backward movement
-        if(joypad.stick_y > 30 || joypad.stick_y < -30) {
-            float move_speed = 1.25f;
-            float yaw_rad = (camera_yaw * 3.14159f) / 180.0f;
-            
-            // Calculate proposed movement
-            float movement = (joypad.stick_y / 128.0f) * move_speed;
-            float new_x = player_x + sinf(-yaw_rad) * movement;
-            float new_z = player_z + cosf(-yaw_rad) * movement;
+        // Run as many fixed ticks as real time demands, independent of frame rate
+        uint32_t now_ticks = get_ticks();
+        sim_accumulator += now_ticks - last_ticks;
+        last_ticks = now_ticks;
+        
+        int sim_ticks = 0;
+        while(sim_accumulator >= SIM_TICK_TICKS && sim_ticks < SIM_MAX_TICKS_PER_FRAME) {
+            for(int p = 0; p < view_count; p++) {
+                player_prev[p] = player_curr[p];
+            }
             
-            // Check collision with wall sliding (player radius = 3 units)
-            if(!check_collision_with_slide(player_x, player_z, &new_x, &new_z, 3.0f)) {
-                player_x = new_x;
-                player_z = new_z;
+            // Auto-walk replaces player 1's stick while a tour is running
+            if(autowalk.active) {
+                if(autowalk_input(&autowalk, &player_curr[0], &inputs[0])) {
+                    autowalk_ticks++;
+                } else {
+                    debugf("Auto-walk tour: %d/%d hexes in %lu ticks (%d skipped)\n",
+                           autowalk.visited_count - autowalk.skipped, autowalk.reachable_count,
+                           (unsigned long)autowalk_ticks, autowalk.skipped);
+                }
             }
-        }
-
-
-
-        /* Render 3D hexagons with RDP triangles */
-        // Setup RDP for triangle rendering (no Z-buffer for now)
-        rdpq_attach(disp, NULL);
-        rdpq_set_mode_fill(RGBA32(128, 0, 0, 255));  // Red background/skybox
-        rdpq_fill_rectangle(0, 0, 320, 240);
-        
-        rdpq_set_mode_standard();
-        rdpq_mode_combiner(RDPQ_COMBINER_FLAT);
-        rdpq_mode_blender(RDPQ_BLENDER_MULTIPLY);
-        
-        // Camera parameters - following player position
-        camera_t camera = {
-            .x = player_x,              // Camera follows player X
-            .y = 10.0f,                 // Eye level ABOVE the floor
-            .z = player_z,              // Camera follows player Z
-            .yaw_rad = (camera_yaw * 3.14159f) / 180.0f,  // Convert to radians
-            .focal_length = 277.0f      // 60 degree FOV
-        };
-        
-        // Define triangle format for flat shading (no Z-buffer)
-        rdpq_trifmt_t trifmt = (rdpq_trifmt_t){
-            .pos_offset = 0,
-            .shade_offset = -1,  // No per-vertex shading
-            .tex_offset = -1,    // No texture
-            .z_offset = -1       // No Z-buffer
-        };
-        
-        // Create array of hexagon indices with distances for depth sorting
-        typedef struct {
-            int index;
-            float distance;
-        } hexagon_distance_t;
-        
-        hexagon_distance_t hex_distances[MAP_HEX_COUNT];
-        
-        // Calculate squared distance from camera to each hexagon center
-        // Skip very distant hexagons early to reduce sorting overhead
-        int visible_hex_count = 0;
-        for(int i = 0; i < MAP_HEX_COUNT; i++) {
-            float dx = hexagons[i].center_x - camera.x;
-            float dz = hexagons[i].center_z - camera.z;
-            float dist_sq = dx*dx + dz*dz;
             
-            // Only include hexagons within maximum render distance
-            if(dist_sq <= 160000.0f) {
-                hex_distances[visible_hex_count].index = i;
-                hex_distances[visible_hex_count].distance = dist_sq;
-                visible_hex_count++;
+            for(int p = 0; p < view_count; p++) {
+                sim_tick(&player_curr[p], &inputs[p]);
             }
+            entity_update_tick();
+            sim_accumulator -= SIM_TICK_TICKS;
+            sim_ticks++;
         }
         
-        // Simple bubble sort to sort hexagons by distance (far to near)
-        // Only sort the visible hexagons
-        for(int i = 0; i < visible_hex_count - 1; i++) {
-            for(int j = 0; j < visible_hex_count - 1 - i; j++) {
-                if(hex_distances[j].distance < hex_distances[j+1].distance) {
-                    hexagon_distance_t temp = hex_distances[j];
-                    hex_distances[j] = hex_distances[j+1];
-                    hex_distances[j+1] = temp;
-                }
-            }
+        // Reveal the player's hexagon on the automap (only touches it on hexagon change)
+        if(minimap_update(player_curr[0].x, player_curr[0].z, player_curr[0].level)) {
+            render_world_version++;
         }
         
-        // Render ceilings first (back to front, farthest geometry)
-        for(int i = 0; i < visible_hex_count; i++) {
-            int hex_idx = hex_distances[i].index;
-            // Combined visibility culling
-            if(should_render_hexagon(&hexagons[hex_idx], &camera)) {
-                render_hexagon_ceiling(&hexagons[hex_idx], &camera, &trifmt);
-            }
+        // Drop backlog we could not catch up on (e.g. after a long stall)
+        if(sim_accumulator >= SIM_TICK_TICKS) {
+            sim_accumulator %= SIM_TICK_TICKS;
         }
         
-        // Render floors (back to front) with LOD
-        for(int i = 0; i < visible_hex_count; i++) {
-            int hex_idx = hex_distances[i].index;
-            // Combined visibility culling  
-            if(should_render_hexagon(&hexagons[hex_idx], &camera)) {
-                int lod = get_hexagon_lod_level(&hexagons[hex_idx], &camera);
-                render_hexagon_floor_lod(&hexagons[hex_idx], &camera, &trifmt, lod);
-            }
+        // Interpolate the cameras between the last two simulation states
+        float sim_alpha = (float)sim_accumulator / (float)SIM_TICK_TICKS;
+        player_state_t views[RENDER_MAX_VIEWS];
+        for(int p = 0; p < view_count; p++) {
+            sim_interpolate(&player_prev[p], &player_curr[p], sim_alpha, &views[p]);
         }
+        player_state_t view = views[0];
         
-        // Collect all wall segments for depth sorting
-        // Limit max wall segments to reduce sorting overhead
-        #define MAX_WALL_SEGMENTS 100
-        wall_segment_t wall_segments[MAX_WALL_SEGMENTS];
-        int wall_count = 0;
-        
-        for(int hex_i = 0; hex_i < MAP_HEX_COUNT; hex_i++) {
-            hexagon_t* hex = &hexagons[hex_i];
+        // Debug text is part of the scene (stick shown after the dead zone)
+        scene_key_t scene = {
+            .view_count = view_count,
+            .world_version = render_world_version,
+            .width = res.width,
+            .height = res.height,
+            .bitdepth = bit
+        };
+        for(int p = 0; p < view_count; p++) {
+            scene.x[p] = views[p].x;
+            scene.y[p] = views[p].floor_y + HEXAGON_EYE_HEIGHT;
+            scene.z[p] = views[p].z;
+            scene.yaw_rad[p] = (views[p].yaw_deg * 3.14159f) / 180.0f;
+        }
+        int shown_stick_x = (joypad.stick_x > 30 || joypad.stick_x < -30) ? joypad.stick_x : 0;
+        int shown_stick_y = (joypad.stick_y > 30 || joypad.stick_y < -30) ? joypad.stick_y : 0;
+        snprintf(scene.overlay[0], sizeof(scene.overlay[0]), "Map: %s (%d hexes)\n", MAP_SEED, MAP_HEX_COUNT);
+        snprintf(scene.overlay[1], sizeof(scene.overlay[1]), "Yaw: %d, Pos: %.1f,%.1f, Level %d/%d\n", (int)view.yaw_deg, view.x, view.z,
+                 view.level + 1, hexagon_level_count);
+        snprintf(scene.overlay[2], sizeof(scene.overlay[2]), "Stick X: %d, Y: %d\n", shown_stick_x, shown_stick_y);
+        if(autowalk.active) {
+            snprintf(scene.overlay[3], sizeof(scene.overlay[3]), "Auto-walk: %d/%d hexes\n", autowalk.visited_count, autowalk.reachable_count);
+        }
+#ifdef ENCOM_RSP_GL
+        else if(render_backend == RENDER_BACKEND_RSP) {
+            snprintf(scene.overlay[3], sizeof(scene.overlay[3]), "Backend: RSP\n");
+        }
+#endif
+        // TMEM traffic of the last rendered frame (budget: TEXTURE_UPLOAD_BUDGET)
+        if(render_textures) {
+            snprintf(scene.overlay[4], sizeof(scene.overlay[4]), "TMEM: %lu B/frame, %lu loads\n",
+                     (unsigned long)texture_stats.upload_bytes, (unsigned long)texture_stats.uploads);
+        }
+
+        int scene_repeated = shown_scene_valid && scene_key_equal(&scene, &shown_scene);
+        if(scene_repeated && shown_scene_complete) {
+            /* Nothing changed: keep presenting the previous frame, and idle
+               until the next simulation tick instead of rebuilding it */
+            wait_ticks(SIM_TICK_TICKS - sim_accumulator);
+        } else {
+            /* Grab a render buffer; the last frame's scratch is released */
+            disp = display_get();
+            arena_frame_reset();
             
-            // Skip hexagons that are not visible
-            if(!should_render_hexagon(hex, &camera)) continue;
+            // 640x480: draw one interlace field, rebuild the other's lines
+            int field_mode = interlace.enabled && res.height == 480;
+#ifdef ENCOM_RSP_GL
+            field_mode = field_mode && render_backend == RENDER_BACKEND_CPU;  // GL sets its own scissor
+#endif
+           
+            /*Fill the screen (field frames clear every line they draw and rebuild the rest) */
+            if(!field_mode) {
+                graphics_fill_screen( disp, 0 );
+            }
+
+            /* Render 3D hexagons with RDP triangles */
+            // Setup RDP for triangle rendering, with the Z-buffer if enabled
+            rdpq_attach(disp, render_zbuffer ? &zbuffer : NULL);
             
-            // Calculate wall segment distances for each direction
-            for(int wall_dir = 0; wall_dir < 6; wall_dir++) {
-                // Only add walls that will actually render
-                int should_render = 0;
-                switch(wall_dir) {
-                    case 2: // North
-                        should_render = (!(hex->connections & CONN_NORTH)) || (hex->type == HEX_TYPE_CORRIDOR);
-                        break;
-                    case 5: // South
-                        should_render = (!(hex->connections & CONN_SOUTH)) || (hex->type == HEX_TYPE_CORRIDOR);
-                        break;
-                    case 0: // Southeast
-                        should_render = (!(hex->connections & CONN_SOUTHEAST)) || (hex->type == HEX_TYPE_CORRIDOR);
-                        break;
-                    case 1: // Northeast
-                        should_render = (!(hex->connections & CONN_NORTHEAST)) || (hex->type == HEX_TYPE_CORRIDOR);
-                        break;
-                    case 3: // Northwest
-                        should_render = (!(hex->connections & CONN_NORTHWEST)) || (hex->type == HEX_TYPE_CORRIDOR);
-                        break;
-                    case 4: // Southwest
-                        should_render = (!(hex->connections & CONN_SOUTHWEST)) || (hex->type == HEX_TYPE_CORRIDOR);
-                        break;
-                }
-                
-                if(should_render) {
-                    // Calculate squared distance (avoid expensive sqrt)
-                    float wall_center_x = hex->center_x;
-                    float wall_center_z = hex->center_z;
-                    float dx = wall_center_x - camera.x;
-                    float dz = wall_center_z - camera.z;
-                    float dist_sq = dx*dx + dz*dz;
-                    
-                    // Skip walls that are too far away (distance culling)
-                    if(dist_sq > 160000.0f) continue;  // ~400 unit cutoff
-                    
-                    // Only add if we have room (prioritize closer walls)
-                    if(wall_count < MAX_WALL_SEGMENTS) {
-                        wall_segments[wall_count].distance = dist_sq;
-                        wall_segments[wall_count].hex = hex;
-                        wall_segments[wall_count].wall_dir = wall_dir;
-                        wall_count++;
-                    }
+            // Camera parameters - one per view, following interpolated player positions
+            camera_t cameras[RENDER_MAX_VIEWS];
+            for(int p = 0; p < view_count; p++) {
+                cameras[p] = (camera_t){
+                    .x = scene.x[p],                // Camera follows player X
+                    .y = scene.y[p],                // Eye level ABOVE the floor
+                    .z = scene.z[p],                // Camera follows player Z
+                    .yaw_rad = scene.yaw_rad[p]     // Converted to radians above
+                };
+            }
+            render_split_viewports(cameras, view_count, res.width, res.height);
+            if(field_mode) {
+                render_field = RENDER_FIELD_EVEN + interlace_next_field();
+            }
+            
+#ifdef ENCOM_RSP_GL
+            if(render_backend == RENDER_BACKEND_RSP) {
+                // The GL path renders views one by one (no shared candidates)
+                for(int p = 0; p < view_count; p++) {
+                    render_world_rsp(&cameras[p]);
                 }
+            } else {
+                render_world_views(cameras, view_count);
             }
-        }
-        
-        // Sort wall segments by distance (far to near) using insertion sort
-        for(int i = 1; i < wall_count; i++) {
-            wall_segment_t key = wall_segments[i];
-            int j = i - 1;
+#else
+            render_world_views(cameras, view_count);
+#endif
+            if(field_mode) {
+                render_field = RENDER_FIELD_NONE;
+                interlace_reconstruct(disp);
+            }
+            minimap_draw(view.x, view.z, scene.yaw_rad[0], res.width);
             
-            // Move elements that are closer than key to one position ahead
-            while(j >= 0 && wall_segments[j].distance < key.distance) {
-                wall_segments[j + 1] = wall_segments[j];
-                j--;
+            rdpq_detach();
+
+            // Draw debug text after RDP operations
+            for(int line = 0; line < SCENE_OVERLAY_LINES; line++) {
+                graphics_draw_text( disp, 20, 20 + line * 10, scene.overlay[line] );
             }
-            wall_segments[j + 1] = key;
+
+            display_show(disp);
+            interlace_shown(disp);
+            
+            shown_scene = scene;
+            shown_scene_valid = 1;
+            shown_scene_complete = !field_mode || interlace.recon == INTERLACE_BOB || scene_repeated;
         }
-        
-        // Render wall segments in depth order
-        for(int i = 0; i < wall_count; i++) {
-            render_single_wall(wall_segments[i].hex, wall_segments[i].wall_dir, &camera, &trifmt);
+
+        /* Do we need to switch video displays? */
+        joypad_buttons_t keys = joypad_get_buttons_pressed(JOYPAD_PORT_1);
+
+        /* Z cycles split-screen: 1, 2 (stacked) or 4 (quadrant) players,
+           new players start where player 1 stands */
+        if( keys.z )
+        {
+            int next = view_count == 1 ? 2 : (view_count == 2 ? 4 : 1);
+            for(int p = view_count; p < next; p++) {
+                player_prev[p] = player_curr[0];
+                player_curr[p] = player_curr[0];
+            }
+            view_count = next;
+        }
+
+        /* START toggles the auto-walk tour */
+        if( keys.start )
+        {
+            if(autowalk.active) {
+                autowalk.active = 0;
+            } else {
+                autowalk_start(&autowalk, &player_curr[0]);
+                autowalk_ticks = 0;
+            }
+        }
+
+        /* C-down toggles wall back-face culling (for A/B measurements) */
+        if( keys.c_down )
+        {
+            render_backface_cull = !render_backface_cull;
+            shown_scene_valid = 0;
+            debugf("Wall back-face culling %s\n", render_backface_cull ? "on" : "off");
         }
-        
-        rdpq_detach();
 
-        // Draw debug text after RDP operations
-        sprintf(tStr, "Map: %s (%d hexes)\n", MAP_SEED, MAP_HEX_COUNT);
-        graphics_draw_text( disp, 20, 20, tStr );
-        sprintf(tStr, "Yaw: %d, Pos: %.1f,%.1f\n", camera_yaw, player_x, player_z);
-        graphics_draw_text( disp, 20, 30, tStr );
-        sprintf(tStr, "Stick X: %d, Y: %d\n", joypad.stick_x, joypad.stick_y);
-        graphics_draw_text( disp, 20, 40, tStr );
+        /* C-up toggles textures (for A/B measurements) */
+        if( keys.c_up )
+        {
+            render_textures = !render_textures;
+            shown_scene_valid = 0;
+            debugf("Textures %s\n", render_textures ? "on" : "off");
+        }
 
-        display_show(disp);
+        /* C-right toggles the Z-buffer against painter's order (for A/B measurements) */
+        if( keys.c_right )
+        {
+            render_zbuffer = !render_zbuffer;
+            zbuffer_update();
+            shown_scene_valid = 0;
+            debugf("Z-buffer %s\n", render_zbuffer ? "on" : "off");
+        }
 
-        /* Do we need to switch video displays? */
-        joypad_buttons_t keys = joypad_get_buttons_pressed(JOYPAD_PORT_1);
+        /* B toggles interlaced field rendering at 640x480 (the display is kept) */
+        if( keys.b )
+        {
+            interlace.enabled = !interlace.enabled;
+            shown_scene_valid = 0;
+            debugf("Field rendering %s\n", interlace.enabled ? "on" : "off");
+        }
+
+        /* A cycles the reconstruction of the field not drawn */
+        if( keys.a )
+        {
+            interlace.recon = (interlace.recon + 1) % INTERLACE_RECON_COUNT;
+            shown_scene_valid = 0;
+            debugf("Field reconstruction: %s\n", interlace_recon_name(interlace.recon));
+        }
+
+        /* C-left prints memory use against the budgets (with high-water marks) */
+        if( keys.c_left )
+        {
+            arena_report();
+        }
+
+#ifdef ENCOM_RSP_GL
+        /* L switches the vertex transform backend */
+        if( keys.l )
+        {
+            render_backend = (render_backend == RENDER_BACKEND_CPU) ? RENDER_BACKEND_RSP : RENDER_BACKEND_CPU;
+            shown_scene_valid = 0;
+        }
+
+        /* R renders the current view through both backends and reports */
+        if( keys.r )
+        {
+            camera_t camera = {
+                .x = player_curr[0].x,
+                .y = player_curr[0].floor_y + HEXAGON_EYE_HEIGHT,
+                .z = player_curr[0].z,
+                .yaw_rad = (player_curr[0].yaw_deg * 3.14159f) / 180.0f
+            };
+            render_split_viewports(&camera, 1, 320, 240);
+            render_rsp_report_t report;
+            render_rsp_validate(&camera, 60, &report);
+            debugf("Backend check: %lu/%lu pixels differ, CPU %lu us/frame, RSP %lu us/frame\n",
+                   (unsigned long)report.mismatched_pixels, (unsigned long)report.total_pixels,
+                   (unsigned long)TICKS_TO_US(report.cpu_ticks), (unsigned long)TICKS_TO_US(report.rsp_ticks));
+            last_ticks = get_ticks();
+        }
+#endif
 
         if( keys.d_up )
         {
             display_close();
+            shown_scene_valid = 0;
 
             res = RESOLUTION_640x480;
             display_init( res, bit, 2, GAMMA_NONE, FILTERS_DISABLED );
+            interlace_reset();
+            zbuffer_update();
         }
 
         if( keys.d_down )
         {
             display_close();
+            shown_scene_valid = 0;
 
             res = RESOLUTION_320x240;
             display_init( res, bit, 2, GAMMA_NONE, FILTERS_RESAMPLE );
+            interlace_reset();
+            zbuffer_update();
         }
 
         if( keys.d_left )
         {
             display_close();
+            shown_scene_valid = 0;
 
             bit = DEPTH_16_BPP;
             // Use FILTERS_RESAMPLE for 320x240, FILTERS_DISABLED for higher res
@@ -276,11 +445,13 @@ int main(void)
             } else {
                 display_init( res, bit, 2, GAMMA_NONE, FILTERS_DISABLED );
             }
+            interlace_reset();
         }
 
         if( keys.d_right )
         {
             display_close();
+            shown_scene_valid = 0;
 
             bit = DEPTH_32_BPP;
             // Use FILTERS_RESAMPLE for 320x240, FILTERS_DISABLED for higher res
@@ -289,6 +460,7 @@ int main(void)
             } else {
                 display_init( res, bit, 2, GAMMA_NONE, FILTERS_DISABLED );
             }
+            interlace_reset();
         }
     }
 }
@@ -0,0 +1,122 @@
+#include "map_loader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef N64
+#include <libdragon.h>
+#endif
+
+#ifdef MAP_BLOB_FILE
+
+// Map hexagons and their baked corner light, filled from the blob at startup
+hex_t map_hexagons[MAP_HEX_COUNT];
+uint8_t map_corner_light[MAP_HEX_COUNT][6];
+
+static uint16_t read_u16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t read_u32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Size of the file as stored (compressed size for asset-compressed blobs)
+static uint32_t stored_size(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if(!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size > 0 ? (uint32_t)size : 0;
+}
+
+// Whole blob in one buffer. On N64 asset_load() decompresses libdragon asset
+// files (mkasset -c) in place while the cartridge DMA is still running and
+// reads uncompressed files as-is; the host tools read the raw blob.
+static uint8_t* read_blob(const char* path, int* size) {
+#ifdef N64
+    return asset_load(path, size);
+#else
+    FILE* f = fopen(path, "rb");
+    if(!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* data = length > 0 ? malloc(length) : NULL;
+    if(data && fread(data, 1, length, f) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size = (int)length;
+    return data;
+#endif
+}
+
+// Load map_hexagons[] from a blob; returns 0 on success, -1 if the file is
+// missing, malformed or was converted for a different MAP_HEX_COUNT.
+// The decompressed blob is held only while decoding (14 bytes per hexagon).
+int map_load(const char* path, map_load_info_t* info) {
+    int size = 0;
+    uint8_t* blob = read_blob(path, &size);
+    if(!blob) return -1;
+    
+    if(size != MAP_BLOB_HEADER_SIZE + MAP_HEX_COUNT * MAP_BLOB_HEX_BYTES ||
+       memcmp(blob, "EHEX", 4) != 0 ||
+       read_u16(blob + 4) != MAP_BLOB_VERSION ||
+       read_u16(blob + 6) != MAP_BLOB_HEX_BYTES ||
+       read_u32(blob + 8) != MAP_HEX_COUNT) {
+        free(blob);
+        return -1;
+    }
+    
+    const uint8_t* dq = blob + MAP_BLOB_HEADER_SIZE;
+    const uint8_t* dr = dq + MAP_HEX_COUNT * 2;
+    const uint8_t* types = dr + MAP_HEX_COUNT * 2;
+    const uint8_t* heights = types + MAP_HEX_COUNT;
+    const uint8_t* connections = heights + MAP_HEX_COUNT;
+    const uint8_t* walkable = connections + MAP_HEX_COUNT;
+    const uint8_t* light = walkable + MAP_HEX_COUNT;
+    uint16_t q = 0, r = 0;
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        hex_t* hex = &map_hexagons[i];
+        q += read_u16(dq + i * 2);
+        r += read_u16(dr + i * 2);
+        hex->q = (int16_t)q;
+        hex->r = (int16_t)r;
+        hex->type = types[i];
+        hex->height = heights[i];
+        hex->connections = connections[i];
+        hex->is_walkable = walkable[i];
+        for(int corner = 0; corner < 6; corner++) {
+            map_corner_light[i][corner] = light[corner * MAP_HEX_COUNT + i];
+        }
+        
+        // 16.16 world position, same math as the converter's header output
+        double x = 25.0 * (1.5 * hex->q);
+        double z = 25.0 * (0.866025404 * hex->q + 1.732050808 * hex->r);
+        hex->x_fixed = (int32_t)(x * 65536.0);
+        hex->z_fixed = (int32_t)(z * 65536.0);
+    }
+    free(blob);
+    
+    if(info) {
+        info->stored_bytes = stored_size(path);
+        info->raw_bytes = (uint32_t)size;
+    }
+    return 0;
+}
+
+#else
+
+// Map compiled into map_data.h - nothing to load
+int map_load(const char* path, map_load_info_t* info) {
+    (void)path;
+    if(info) {
+        info->stored_bytes = 0;
+        info->raw_bytes = 0;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef MAP_LOADER_H
+#define MAP_LOADER_H
+
+#include <stdint.h>
+#include "../generated/map_data.h"
+
+// Binary map blob written by map_converter.py --blob (large maps): a header
+// ("EHEX", version, bytes per hexagon, hex count) followed by the hexagon
+// fields as columns - big-endian int16 q and r deltas from the previous
+// hexagon, then one byte per hexagon each for type, height, connections and
+// walkable, then six columns of baked corner light (corner 0 of every
+// hexagon, corner 1, ...). Blob builds define MAP_BLOB_FILE and fill
+// map_hexagons[] and map_corner_light[] through map_load().
+#define MAP_BLOB_VERSION 3
+#define MAP_BLOB_HEADER_SIZE 12
+#define MAP_BLOB_HEX_BYTES 14
+
+// Uncompressed copy packed by MAP_LOAD_COMPARE=1 builds for the startup report
+#define MAP_BLOB_RAW_FILE "map_raw.bin"
+
+// Sizes of the last loaded blob (stored = bytes in DFS, after compression)
+typedef struct {
+    uint32_t stored_bytes;
+    uint32_t raw_bytes;
+} map_load_info_t;
+
+// Function prototypes
+int map_load(const char* path, map_load_info_t* info);
+
+#endif // MAP_LOADER_H
@@ -0,0 +1,153 @@
+#include "minimap.h"
+#include <math.h>
+#include <libdragon.h>
+#include <rdpq.h>
+#include <rdpq_mode.h>
+#include "hexagon.h"
+#include "texture.h"
+
+minimap_t minimap;
+
+// Offscreen automap (RGBA16, alpha 0 = unexplored, transparent when blitted)
+static surface_t minimap_surface;
+
+static uint16_t palette_color16(uint16_t rgb565) {
+    color_t c = RGBA32(((rgb565 >> 11) & 0x1F) << 3, ((rgb565 >> 5) & 0x3F) << 2, (rgb565 & 0x1F) << 3, 255);
+    return color_to_packed16(c);
+}
+
+static void minimap_plot(int x, int y, uint16_t color) {
+    if(x < 0 || y < 0 || x >= MINIMAP_SIZE || y >= MINIMAP_SIZE) return;
+    uint16_t* row = (uint16_t*)((uint8_t*)minimap_surface.buffer + y * minimap_surface.stride);
+    row[x] = color;
+}
+
+static void minimap_to_pixel(float world_x, float world_z, float* px, float* py) {
+    *px = (world_x - minimap.origin_x) * minimap.scale;
+    *py = (minimap.origin_z - world_z) * minimap.scale;   // North (+z) up, as seen facing yaw 0
+}
+
+// Draw one hexagon: a dot at its centre plus half of each connection, so a
+// passage shows once either end has been explored
+static void minimap_draw_hex(int hex_idx) {
+    const hexagon_t* hex = &hexagons[hex_idx];
+    uint16_t color = palette_color16(hex->type == HEX_TYPE_ROOM ? GET_MEDIUM_COLOR() : GET_BRIGHT_COLOR());
+    float cx, cy;
+    minimap_to_pixel(hex->center_x, hex->center_z, &cx, &cy);
+    
+    float spacing = 75.0f * minimap.scale;
+    int dot = (int)(spacing * 0.25f);
+    for(int dy = -dot; dy <= dot; dy++) {
+        for(int dx = -dot; dx <= dot; dx++) {
+            minimap_plot((int)cx + dx, (int)cy + dy, color);
+        }
+    }
+    
+    // Connections only resolve below a few pixels per hexagon
+    if(spacing < 3.0f) return;
+    for(int dir = 0; dir < 6; dir++) {
+        if(!(hex->connections & (1 << dir))) continue;
+        int neighbor = hexagon_neighbor(hex_idx, dir);
+        if(neighbor < 0) continue;
+        
+        float nx, ny;
+        minimap_to_pixel(hexagons[neighbor].center_x, hexagons[neighbor].center_z, &nx, &ny);
+        int steps = (int)(spacing * 0.5f + 0.5f);
+        for(int s = 1; s <= steps; s++) {
+            float t = 0.5f * s / steps;
+            minimap_plot((int)(cx + (nx - cx) * t), (int)(cy + (ny - cy) * t), color);
+        }
+    }
+}
+
+static void minimap_clear(void) {
+    for(int y = 0; y < MINIMAP_SIZE; y++) {
+        for(int x = 0; x < MINIMAP_SIZE; x++) {
+            minimap_plot(x, y, 0);
+        }
+    }
+}
+
+// Redraw the surface with the revealed hexagons on another level
+static void minimap_show_level(int level) {
+    minimap.level = level;
+    minimap_clear();
+    
+    int first, end;
+    hexagon_level_range(level, &first, &end);
+    for(int i = first; i < end; i++) {
+        if(minimap.revealed[i] && hexagon_on_level(&hexagons[i], level)) minimap_draw_hex(i);
+    }
+}
+
+// Allocate the surface and fit the map's bounding box into it (call after
+// the hexagons are initialised)
+void minimap_init(void) {
+    minimap_surface = surface_alloc(FMT_RGBA16, MINIMAP_SIZE, MINIMAP_SIZE);
+    minimap_clear();
+    
+    float min_x = hexagons[0].center_x, max_x = min_x;
+    float min_z = hexagons[0].center_z, max_z = min_z;
+    for(int i = 1; i < MAP_HEX_COUNT; i++) {
+        min_x = fminf(min_x, hexagons[i].center_x);
+        max_x = fmaxf(max_x, hexagons[i].center_x);
+        min_z = fminf(min_z, hexagons[i].center_z);
+        max_z = fmaxf(max_z, hexagons[i].center_z);
+    }
+    
+    // One hexagon of padding around the extents, map centred in the surface
+    float extent = fmaxf(max_x - min_x, max_z - min_z) + 100.0f;
+    minimap.scale = fminf(MINIMAP_SIZE / extent, MINIMAP_MAX_SCALE);
+    minimap.origin_x = (min_x + max_x) * 0.5f - (MINIMAP_SIZE * 0.5f) / minimap.scale;
+    minimap.origin_z = (min_z + max_z) * 0.5f + (MINIMAP_SIZE * 0.5f) / minimap.scale;
+    
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        minimap.revealed[i] = 0;
+    }
+    minimap.revealed_count = 0;
+    minimap.last_hex = -1;
+    minimap.level = 0;
+}
+
+// Reveal the hexagon at the player's position; only entering a new hexagon
+// or level touches the surface. Returns 1 if the minimap changed.
+int minimap_update(float x, float z, int level) {
+    int changed = 0;
+    if(level != minimap.level) {
+        minimap_show_level(level);
+        changed = 1;
+    }
+    
+    int current = hexagon_at_position(x, z, level);
+    if(current == minimap.last_hex) return changed;
+    minimap.last_hex = current;
+    if(current < 0 || minimap.revealed[current]) return changed;
+    
+    minimap.revealed[current] = 1;
+    minimap.revealed_count++;
+    minimap_draw_hex(current);
+    return 1;
+}
+
+// Composite the minimap in the top-right corner: one blit of the cached
+// surface (copy mode, unexplored pixels transparent) and the player marker.
+// Must be called with the RDP attached; cost does not depend on map size.
+void minimap_draw(float x, float z, float yaw_rad, int screen_width) {
+    int left = screen_width - MINIMAP_SIZE - MINIMAP_MARGIN;
+    int top = MINIMAP_MARGIN;
+    
+    rdpq_set_mode_copy(true);
+    rdpq_tex_blit(&minimap_surface, left, top, NULL);
+    texture_invalidate();  // The blit loaded TMEM over resident textures
+    
+    // Player dot plus a heading pixel (same forward vector as sim_tick)
+    float px, py;
+    minimap_to_pixel(x, z, &px, &py);
+    px += left;
+    py += top;
+    rdpq_set_mode_fill(RGBA32(255, 255, 255, 255));
+    rdpq_fill_rectangle(px - 1, py - 1, px + 2, py + 2);
+    float hx = px + sinf(-yaw_rad) * 3.0f;
+    float hy = py - cosf(-yaw_rad) * 3.0f;
+    rdpq_fill_rectangle(hx, hy, hx + 1, hy + 1);
+}
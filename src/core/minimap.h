@@ -0,0 +1,31 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <stdint.h>
+#include "../generated/map_data.h"
+
+// Automap: an offscreen surface holding the whole map scaled to fit, drawn
+// hex by hex as the player enters them (fog of war) and composited each
+// frame with one texture blit plus a player marker. It shows the player's
+// level only, redrawn from the revealed flags when the level changes.
+#define MINIMAP_SIZE 64              // Surface width/height in pixels
+#define MINIMAP_MARGIN 8             // Distance from the screen's top-right corner
+#define MINIMAP_MAX_SCALE 0.08f      // Pixels per world unit (caps small maps at ~6 px per hex)
+
+typedef struct {
+    uint8_t revealed[MAP_HEX_COUNT]; // Hexagons drawn into the surface
+    int revealed_count;
+    int last_hex;                    // Hexagon the player was in at the last update
+    int level;                       // Level drawn into the surface
+    float scale;                     // Pixels per world unit
+    float origin_x, origin_z;        // World position of surface pixel (0, 0) (top-left)
+} minimap_t;
+
+extern minimap_t minimap;
+
+// Function prototypes
+void minimap_init(void);
+int minimap_update(float x, float z, int level);
+void minimap_draw(float x, float z, float yaw_rad, int screen_width);
+
+#endif // MINIMAP_H
@@ -0,0 +1,298 @@
+#include "nav.h"
+#include "arena.h"
+
+// Flow field cache, sized at nav_init from the nav budget
+static nav_field_t* nav_fields;
+static int nav_field_slots;
+static uint32_t nav_use_clock = 0;
+
+// Shared scratch for BFS / A* (one search at a time)
+static int32_t* nav_queue;
+static uint16_t* nav_g;
+static int32_t* nav_came_from;
+static uint32_t* nav_stamp;
+static uint8_t* nav_closed;
+static uint8_t* nav_in_queue;
+static int32_t* nav_heap_pos;
+static uint32_t nav_search_id = 0;
+
+// Reset the flow field cache. The first call allocates the search scratch,
+// then as many flow fields as the rest of the nav budget holds (between one
+// and NAV_FIELD_SLOTS, or NAV_FIELD_SLOTS_EXPANDED with the Expansion Pak).
+void nav_init(void) {
+    if(!nav_fields) {
+        nav_queue = arena_alloc(ARENA_NAV, MAP_HEX_COUNT * sizeof(int32_t));
+        nav_g = arena_alloc(ARENA_NAV, MAP_HEX_COUNT * sizeof(uint16_t));
+        nav_came_from = arena_alloc(ARENA_NAV, MAP_HEX_COUNT * sizeof(int32_t));
+        nav_stamp = arena_alloc(ARENA_NAV, MAP_HEX_COUNT * sizeof(uint32_t));
+        nav_closed = arena_alloc(ARENA_NAV, MAP_HEX_COUNT * sizeof(uint8_t));
+        nav_in_queue = arena_alloc(ARENA_NAV, MAP_HEX_COUNT * sizeof(uint8_t));
+        nav_heap_pos = arena_alloc(ARENA_NAV, MAP_HEX_COUNT * sizeof(int32_t));
+        
+        int slots = arena_available(ARENA_NAV) / sizeof(nav_field_t);
+        int max_slots = arena_scaled(NAV_FIELD_SLOTS, NAV_FIELD_SLOTS_EXPANDED);
+        nav_field_slots = slots < 1 ? 1 : (slots > max_slots ? max_slots : slots);
+        nav_fields = arena_alloc(ARENA_NAV, nav_field_slots * sizeof(nav_field_t));
+    }
+    
+    for(int i = 0; i < nav_field_slots; i++) {
+        nav_fields[i].goal = -1;
+        nav_fields[i].last_used = 0;
+        nav_fields[i].dirty = 0;
+    }
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        nav_stamp[i] = 0;
+        nav_in_queue[i] = 0;
+    }
+    nav_use_clock = 0;
+    nav_search_id = 0;
+}
+
+// Neighbour reached through an open edge (-1 if blocked). Both hexagons must
+// list the connection - a one-sided connection still renders a wall.
+int nav_edge_open(int hex_idx, int dir) {
+    if(!(hexagons[hex_idx].connections & (1 << dir))) return -1;
+    
+    int neighbor = hexagon_neighbor(hex_idx, dir);
+    if(neighbor < 0) return -1;
+    if(!(hexagons[neighbor].connections & (1 << ((dir + 3) % 6)))) return -1;
+    
+    return neighbor;
+}
+
+// Full breadth-first fill from the goal
+static void nav_field_compute(nav_field_t* field) {
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        field->dist[i] = NAV_UNREACHABLE;
+        field->next_dir[i] = -1;
+    }
+    
+    int head = 0, tail = 0;
+    field->dist[field->goal] = 0;
+    nav_queue[tail++] = field->goal;
+    
+    while(head < tail) {
+        int hex = nav_queue[head++];
+        for(int dir = 0; dir < 6; dir++) {
+            int neighbor = nav_edge_open(hex, dir);
+            if(neighbor < 0 || field->dist[neighbor] != NAV_UNREACHABLE) continue;
+            
+            // Step from the neighbour back towards hex is the opposite direction
+            field->dist[neighbor] = field->dist[hex] + 1;
+            field->next_dir[neighbor] = (dir + 3) % 6;
+            nav_queue[tail++] = neighbor;
+        }
+    }
+    
+    field->dirty = 0;
+}
+
+// Get (or build) the flow field towards a goal - cached with LRU replacement
+const nav_field_t* nav_get_flow_field(int goal) {
+    nav_field_t* slot = &nav_fields[0];
+    
+    for(int i = 0; i < nav_field_slots; i++) {
+        if(nav_fields[i].goal == goal) {
+            slot = &nav_fields[i];
+            break;
+        }
+        if(nav_fields[i].last_used < slot->last_used) {
+            slot = &nav_fields[i];
+        }
+    }
+    
+    if(slot->goal != goal) {
+        slot->goal = goal;
+        slot->dirty = 1;
+    }
+    if(slot->dirty) {
+        nav_field_compute(slot);
+    }
+    
+    slot->last_used = ++nav_use_clock;
+    return slot;
+}
+
+// Next hexagon on the way to the field's goal - O(1) per agent (-1 at goal/unreachable)
+int nav_flow_next(const nav_field_t* field, int hex_idx) {
+    int dir = field->next_dir[hex_idx];
+    if(dir < 0) return -1;
+    return hexagon_neighbor(hex_idx, dir);
+}
+
+// Hex grid distance (admissible A* heuristic for unit step costs)
+static int nav_heuristic(int a, int b) {
+    int dq = hexagons[a].q - hexagons[b].q;
+    int dr = hexagons[a].r - hexagons[b].r;
+    int ds = -dq - dr;
+    if(dq < 0) dq = -dq;
+    if(dr < 0) dr = -dr;
+    if(ds < 0) ds = -ds;
+    return (dq + dr + ds) / 2;
+}
+
+// Indexed binary heap keyed on f = g + h (nav_queue doubles as heap storage).
+// Positions are tracked so an improved g is a decrease-key, which keeps the
+// heap within MAP_HEX_COUNT entries.
+static int nav_heap_f(int hex, int goal) {
+    return nav_g[hex] + nav_heuristic(hex, goal);
+}
+
+static void nav_heap_swap(int i, int j) {
+    int32_t tmp = nav_queue[i];
+    nav_queue[i] = nav_queue[j];
+    nav_queue[j] = tmp;
+    nav_heap_pos[nav_queue[i]] = i;
+    nav_heap_pos[nav_queue[j]] = j;
+}
+
+static void nav_heap_sift_up(int i, int goal) {
+    while(i > 0) {
+        int parent = (i - 1) / 2;
+        if(nav_heap_f(nav_queue[parent], goal) <= nav_heap_f(nav_queue[i], goal)) break;
+        nav_heap_swap(i, parent);
+        i = parent;
+    }
+}
+
+static int nav_heap_pop(int* size, int goal) {
+    int top = nav_queue[0];
+    nav_heap_pos[top] = -1;
+    
+    if(--(*size) > 0) {
+        nav_queue[0] = nav_queue[*size];
+        nav_heap_pos[nav_queue[0]] = 0;
+    }
+    
+    int i = 0;
+    while(1) {
+        int left = 2 * i + 1, right = left + 1, best = i;
+        if(left < *size && nav_heap_f(nav_queue[left], goal) < nav_heap_f(nav_queue[best], goal)) best = left;
+        if(right < *size && nav_heap_f(nav_queue[right], goal) < nav_heap_f(nav_queue[best], goal)) best = right;
+        if(best == i) break;
+        nav_heap_swap(i, best);
+        i = best;
+    }
+    return top;
+}
+
+// Insert a hexagon or move it up after its g improved
+static void nav_heap_update(int* size, int hex, int goal) {
+    if(nav_heap_pos[hex] < 0) {
+        nav_heap_pos[hex] = *size;
+        nav_queue[(*size)++] = hex;
+    }
+    nav_heap_sift_up(nav_heap_pos[hex], goal);
+}
+
+// A* between two hexagons. Writes start..goal into path and returns its
+// length, or 0 if the goal is unreachable or the path does not fit.
+int nav_find_path(int start, int goal, int32_t* path, int max_len) {
+    uint32_t id = ++nav_search_id;
+    int heap_size = 0;
+    
+    nav_stamp[start] = id;
+    nav_g[start] = 0;
+    nav_closed[start] = 0;
+    nav_came_from[start] = -1;
+    nav_heap_pos[start] = -1;
+    nav_heap_update(&heap_size, start, goal);
+    
+    while(heap_size > 0) {
+        int hex = nav_heap_pop(&heap_size, goal);
+        nav_closed[hex] = 1;
+        
+        if(hex == goal) {
+            // Leave no stale heap positions behind for the next search
+            for(int i = 0; i < heap_size; i++) {
+                nav_heap_pos[nav_queue[i]] = -1;
+            }
+            
+            // Walk back to the start, then reverse in place
+            int len = 0;
+            for(int at = goal; at >= 0; at = nav_came_from[at]) {
+                if(len >= max_len) return 0;
+                path[len++] = at;
+            }
+            for(int i = 0; i < len / 2; i++) {
+                int32_t tmp = path[i];
+                path[i] = path[len - 1 - i];
+                path[len - 1 - i] = tmp;
+            }
+            return len;
+        }
+        
+        for(int dir = 0; dir < 6; dir++) {
+            int neighbor = nav_edge_open(hex, dir);
+            if(neighbor < 0) continue;
+            
+            uint16_t g = nav_g[hex] + 1;
+            if(nav_stamp[neighbor] == id && (nav_closed[neighbor] || nav_g[neighbor] <= g)) continue;
+            
+            if(nav_stamp[neighbor] != id) {
+                nav_stamp[neighbor] = id;
+                nav_closed[neighbor] = 0;
+                nav_heap_pos[neighbor] = -1;
+            }
+            nav_g[neighbor] = g;
+            nav_came_from[neighbor] = hex;
+            nav_heap_update(&heap_size, neighbor, goal);
+        }
+    }
+    
+    return 0;
+}
+
+// Relax distances outward after edges opened (distances can only shrink)
+static void nav_field_relax(nav_field_t* field, int hex_idx) {
+    int head = 0, count = 0;
+    
+    // Seed with the changed hexagon and its neighbours across the new edges
+    for(int dir = -1; dir < 6; dir++) {
+        int hex = dir < 0 ? hex_idx : hexagon_neighbor(hex_idx, dir);
+        if(hex < 0 || nav_in_queue[hex]) continue;
+        nav_in_queue[hex] = 1;
+        nav_queue[count++] = hex;
+    }
+    
+    // Circular FIFO; in-queue flags bound it to MAP_HEX_COUNT entries
+    while(count > 0) {
+        int hex = nav_queue[head];
+        head = (head + 1) % MAP_HEX_COUNT;
+        count--;
+        nav_in_queue[hex] = 0;
+        if(field->dist[hex] == NAV_UNREACHABLE) continue;
+        
+        for(int dir = 0; dir < 6; dir++) {
+            int neighbor = nav_edge_open(hex, dir);
+            if(neighbor < 0 || field->dist[neighbor] <= field->dist[hex] + 1) continue;
+            
+            field->dist[neighbor] = field->dist[hex] + 1;
+            field->next_dir[neighbor] = (dir + 3) % 6;
+            if(!nav_in_queue[neighbor]) {
+                nav_in_queue[neighbor] = 1;
+                nav_queue[(head + count) % MAP_HEX_COUNT] = neighbor;
+                count++;
+            }
+        }
+    }
+}
+
+// Update cached fields after hexagons[hex_idx].connections changed.
+// Opened edges are patched incrementally; closed edges force a recompute
+// of each cached field on its next use.
+void nav_notify_hex_changed(int hex_idx, uint8_t old_connections) {
+    uint8_t new_connections = hexagons[hex_idx].connections;
+    int closed = (old_connections & ~new_connections) != 0;
+    
+    for(int i = 0; i < nav_field_slots; i++) {
+        nav_field_t* field = &nav_fields[i];
+        if(field->goal < 0 || field->dirty) continue;
+        
+        if(closed) {
+            field->dirty = 1;
+        } else if(new_connections != old_connections) {
+            nav_field_relax(field, hex_idx);
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef NAV_H
+#define NAV_H
+
+#include <stdint.h>
+#include "hexagon.h"
+
+#define NAV_UNREACHABLE 0xFFFF
+#define NAV_FIELD_SLOTS 8            // Flow fields kept in the LRU cache (at most)
+#define NAV_FIELD_SLOTS_EXPANDED 32  // The same with the Expansion Pak
+
+// Cached flow field towards one goal hexagon (BFS over open edges)
+typedef struct {
+    int32_t goal;                    // Goal hexagon (-1 = free slot)
+    uint32_t last_used;              // LRU stamp
+    uint8_t dirty;                   // Needs a full recompute before use
+    uint16_t dist[MAP_HEX_COUNT];    // Steps to the goal (NAV_UNREACHABLE if cut off)
+    int8_t next_dir[MAP_HEX_COUNT];  // Direction of the next step (-1 at goal/unreachable)
+} nav_field_t;
+
+// Function prototypes
+void nav_init(void);
+int nav_edge_open(int hex_idx, int dir);
+const nav_field_t* nav_get_flow_field(int goal);
+int nav_flow_next(const nav_field_t* field, int hex_idx);
+int nav_find_path(int start, int goal, int32_t* path, int max_len);
+void nav_notify_hex_changed(int hex_idx, uint8_t old_connections);
+
+#endif // NAV_H
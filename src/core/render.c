@@ -1,7 +1,20 @@
 #include "render.h"
 #include <math.h>
 #include <rdpq.h>
+#include <stdlib.h>
+#include <string.h>
 #include "../generated/map_data.h"
+#include "geometry.h"
+#include "arena.h"
+#include "interlace.h"
+
+uint32_t render_world_version = 0;
+render_pass_t render_current_pass = RENDER_PASS_CLEAR;
+int render_backface_cull = 1;
+int render_textures = 1;
+int render_zbuffer = 0;
+int render_field = RENDER_FIELD_NONE;
+int render_wall_capacity = RENDER_WALL_CAPACITY;
 
 // 3D to 2D projection function
 screen_pos_t project_vertex(float world_x, float world_y, float world_z, camera_t* cam) {
@@ -19,17 +32,22 @@ screen_pos_t project_vertex(float world_x, float world_y, float world_z, camera_
     // Small Z offset to ensure positive depth for projection stability
     view_z += 10.0f;
     
+    result.depth = view_z;
+    result.shade = 1.0f;
+    
     // 3D to 2D projection
     if(view_z > 0.001f) {
-        result.x = 160.0f + (view_x * cam->focal_length) / view_z;
-        result.y = 120.0f - (rel_y * cam->focal_length) / view_z;
+        result.x = RENDER_CENTER_X(cam) + (view_x * cam->focal_length) / view_z;
+        result.y = RENDER_CENTER_Y(cam) - (rel_y * cam->focal_length) / view_z;
         result.valid = 1;
         
         // Clamp to tighter bounds to prevent visual sliding
-        if(result.x < -200.0f) result.x = -200.0f;
-        if(result.x > 520.0f) result.x = 520.0f;
-        if(result.y < -200.0f) result.y = -200.0f;
-        if(result.y > 440.0f) result.y = 440.0f;
+        float min_x = cam->vp_x - 200.0f, max_x = cam->vp_x + cam->vp_width + 200.0f;
+        float min_y = cam->vp_y - 200.0f, max_y = cam->vp_y + cam->vp_height + 200.0f;
+        if(result.x < min_x) result.x = min_x;
+        if(result.x > max_x) result.x = max_x;
+        if(result.y < min_y) result.y = min_y;
+        if(result.y > max_y) result.y = max_y;
     } else {
         result.valid = 0;  // Mark as invalid for walls/pillars to skip them
     }
@@ -53,117 +71,266 @@ screen_pos_t project_vertex_floor(float world_x, float world_y, float world_z, c
     // Small Z offset to ensure positive depth for projection stability
     view_z += 10.0f;
     
+    result.depth = view_z;
+    result.shade = 1.0f;
+    
     // 3D to 2D projection (always return valid coordinates for floors)
     if(view_z > 0.001f) {
-        result.x = 160.0f + (view_x * cam->focal_length) / view_z;
-        result.y = 120.0f - (rel_y * cam->focal_length) / view_z;
+        result.x = RENDER_CENTER_X(cam) + (view_x * cam->focal_length) / view_z;
+        result.y = RENDER_CENTER_Y(cam) - (rel_y * cam->focal_length) / view_z;
     } else {
         // For vertices behind camera, project to near plane
         float near_z = 0.5f;
-        result.x = 160.0f + (view_x * cam->focal_length) / near_z;
-        result.y = 120.0f - (rel_y * cam->focal_length) / near_z;
+        result.x = RENDER_CENTER_X(cam) + (view_x * cam->focal_length) / near_z;
+        result.y = RENDER_CENTER_Y(cam) - (rel_y * cam->focal_length) / near_z;
     }
     
     result.valid = 1;  // Always mark as valid for floors
     
     // Clamp to reasonable offscreen bounds to prevent RDP issues
-    if(result.x < -500.0f) result.x = -500.0f;
-    if(result.x > 820.0f) result.x = 820.0f;
-    if(result.y < -500.0f) result.y = -500.0f;
-    if(result.y > 740.0f) result.y = 740.0f;
+    float min_x = cam->vp_x - RENDER_FLOOR_GUARD, max_x = cam->vp_x + cam->vp_width + RENDER_FLOOR_GUARD;
+    float min_y = cam->vp_y - RENDER_FLOOR_GUARD, max_y = cam->vp_y + cam->vp_height + RENDER_FLOOR_GUARD;
+    if(result.x < min_x) result.x = min_x;
+    if(result.x > max_x) result.x = max_x;
+    if(result.y < min_y) result.y = min_y;
+    if(result.y > max_y) result.y = max_y;
     
     return result;
 }
 
+static color_t palette_color(uint16_t c) {
+    return RGBA32(((c >> 11) & 0x1F) << 3, ((c >> 5) & 0x3F) << 2, (c & 0x1F) << 3, 255);
+}
+
+// Fog colour: the seed palette's dark shade (RGB565 in map data)
+color_t render_fog_color(void) {
+    return palette_color(GET_DARK_COLOR());
+}
+
+// Material colours: floors and ceilings are greys tinted halfway toward the
+// palette's medium and dark shades, walls take its bright shade, doorframes
+// stay black
+color_t render_material_color(render_material_t material) {
+    color_t tint;
+    int grey;
+    switch(material) {
+        case RENDER_MATERIAL_FLOOR: tint = palette_color(GET_MEDIUM_COLOR()); grey = 128; break;
+        case RENDER_MATERIAL_CEILING: tint = palette_color(GET_DARK_COLOR()); grey = 64; break;
+        case RENDER_MATERIAL_WALL: return palette_color(GET_BRIGHT_COLOR());
+        default: return RGBA32(0, 0, 0, 255);
+    }
+    return RGBA32((grey + tint.r) / 2, (grey + tint.g) / 2, (grey + tint.b) / 2, 255);
+}
+
+// Bind a texture level for the following triangles; their coordinates are
+// given at level 0 and scaled down to the bound level
+static float texel_scale = 1.0f;
+
+static void render_bind_texture(rdpq_trifmt_t* trifmt, texture_id_t texture, int level) {
+    if(!render_textures) return;
+    trifmt->tex_tile = texture_bind(texture, level);
+    texel_scale = 1.0f / (1 << level);
+}
+
+// Floor/ceiling texture coordinates: world position in level-0 texels, from
+// the last repeat boundary before the polygon so they stay small
+static void floor_texcoords(const float* x, const float* z, int count, texture_id_t texture, float* s, float* t) {
+    const texture_info_t* info = &texture_info[texture];
+    float min_x = x[0], min_z = z[0];
+    for(int i = 1; i < count; i++) {
+        min_x = fminf(min_x, x[i]);
+        min_z = fminf(min_z, z[i]);
+    }
+    float base_x = floorf(min_x / info->span_s) * info->span_s;
+    float base_z = floorf(min_z / info->span_t) * info->span_t;
+    for(int i = 0; i < count; i++) {
+        s[i] = (x[i] - base_x) * (info->width / info->span_s);
+        t[i] = (z[i] - base_z) * (info->height / info->span_t);
+    }
+}
+
+// Baked light of a hexagon corner as a shade factor
+static float corner_shade(const hexagon_t* hex, int corner) {
+    return map_corner_light[hex - hexagons][corner] * (1.0f / 255.0f);
+}
+
+// Emit one triangle: screen position plus per-vertex shade, whose RGB is the
+// baked light and whose alpha is the fog blend factor (1 = lit material
+// colour, 0 = fully fogged), and texture coordinates (ignored untextured)
+static void render_triangle(rdpq_trifmt_t* trifmt, const screen_pos_t* a, const screen_pos_t* b, const screen_pos_t* c) {
+    const screen_pos_t* pos[3] = { a, b, c };
+    float v[3][RENDER_VTX_FLOATS];
+    
+    for(int i = 0; i < 3; i++) {
+        float fog = (pos[i]->depth - RENDER_FOG_START) * (1.0f / (RENDER_FOG_END - RENDER_FOG_START));
+        if(fog < 0.0f) fog = 0.0f;
+        if(fog > 1.0f) fog = 1.0f;
+        
+        v[i][RENDER_VTX_POS + 0] = pos[i]->x;
+        v[i][RENDER_VTX_POS + 1] = pos[i]->y;
+        v[i][RENDER_VTX_SHADE + 0] = pos[i]->shade;
+        v[i][RENDER_VTX_SHADE + 1] = pos[i]->shade;
+        v[i][RENDER_VTX_SHADE + 2] = pos[i]->shade;
+        v[i][RENDER_VTX_SHADE + 3] = 1.0f - fog;
+        v[i][RENDER_VTX_TEX + 0] = pos[i]->s * texel_scale;
+        v[i][RENDER_VTX_TEX + 1] = pos[i]->t * texel_scale;
+        v[i][RENDER_VTX_TEX + 2] = 1.0f / fmaxf(pos[i]->depth, 0.5f);
+        if(trifmt->z_offset >= 0) {
+            float z = (1.0f / RENDER_ZBUF_NEAR - v[i][RENDER_VTX_TEX + 2]) *
+                      (1.0f / (1.0f / RENDER_ZBUF_NEAR - 1.0f / RENDER_ZBUF_FAR));
+            v[i][RENDER_VTX_Z] = fminf(fmaxf(z, 0.0f), 1.0f);
+        }
+    }
+    rdpq_triangle(trifmt, v[0], v[1], v[2]);
+}
+
+// View-space polygon corner for render_view_polygon: x, height above the
+// eye, depth (offset as in project_vertex), then shade and texture coordinates
+enum { CLIP_X = 0, CLIP_Y, CLIP_DEPTH, CLIP_SHADE, CLIP_S, CLIP_T, CLIP_FLOATS };
+
+// Draw a convex polygon given in view space (in poly[0]) as a fan. It is
+// clipped before projection to depth >= near and to planes at the guard band
+// beside, above and below the viewport, so no corner needs clamping and
+// every interpolated value (texture coordinates, Z) stays exact.
+static void render_view_polygon(float poly[2][RENDER_FLOOR_MAX_CORNERS][CLIP_FLOATS], int n, float near, int reverse,
+                                camera_t* cam, rdpq_trifmt_t* trifmt) {
+    float side_x = (cam->vp_width * 0.5f + RENDER_FLOOR_GUARD) / cam->focal_length;
+    float side_y = (cam->vp_height * 0.5f + RENDER_FLOOR_GUARD) / cam->focal_length;
+    
+    // Sutherland-Hodgman against depth >= near, |x| <= side_x * depth, |y| <= side_y * depth
+    int src = 0;
+    for(int plane = 0; plane < 5 && n > 0; plane++) {
+        float (*in)[CLIP_FLOATS] = poly[src], (*out)[CLIP_FLOATS] = poly[src ^ 1];
+        float side = plane < 3 ? side_x : side_y;
+        int axis = plane < 3 ? CLIP_X : CLIP_Y;
+        float sign = (plane & 1) ? -1.0f : 1.0f;
+        int out_count = 0;
+        for(int i = 0; i < n; i++) {
+            const float* a = in[i];
+            const float* b = in[(i + 1) % n];
+            float da = plane == 0 ? a[CLIP_DEPTH] - near : side * a[CLIP_DEPTH] + sign * a[axis];
+            float db = plane == 0 ? b[CLIP_DEPTH] - near : side * b[CLIP_DEPTH] + sign * b[axis];
+            if(da >= 0.0f) {
+                memcpy(out[out_count++], a, sizeof(out[0]));
+            }
+            if((da >= 0.0f) != (db >= 0.0f)) {
+                float f = da / (da - db);
+                for(int c = 0; c < CLIP_FLOATS; c++) {
+                    out[out_count][c] = a[c] + f * (b[c] - a[c]);
+                }
+                out_count++;
+            }
+        }
+        n = out_count;
+        src ^= 1;
+    }
+    if(n < 3) return;
+    
+    screen_pos_t pos[RENDER_FLOOR_MAX_CORNERS];
+    for(int i = 0; i < n; i++) {
+        const float* c = poly[src][i];
+        pos[i].x = RENDER_CENTER_X(cam) + (c[CLIP_X] * cam->focal_length) / c[CLIP_DEPTH];
+        pos[i].y = RENDER_CENTER_Y(cam) - (c[CLIP_Y] * cam->focal_length) / c[CLIP_DEPTH];
+        pos[i].depth = c[CLIP_DEPTH];
+        pos[i].shade = c[CLIP_SHADE];
+        pos[i].s = c[CLIP_S];
+        pos[i].t = c[CLIP_T];
+        pos[i].valid = 1;
+    }
+    
+    for(int i = 1; i + 1 < n; i++) {
+        if(reverse) render_triangle(trifmt, &pos[i + 1], &pos[i], &pos[0]);
+        else render_triangle(trifmt, &pos[0], &pos[i], &pos[i + 1]);
+    }
+}
+
+// Draw a wall quad standing on the floor from (x0, z0) to (x1, z1), floor
+// heights y0 and y1, with shade and texture s given at each end and t
+// running from t_bottom at the floor to 0 at the top. In painter's order its
+// projected corners are drawn as they are (nothing if one is behind the
+// eye); with the Z-buffer the quad is clipped in view space instead.
+static void render_wall_quad(camera_t* cam, rdpq_trifmt_t* trifmt, float x0, float z0, float x1, float z1,
+                             float y0, float y1, float shade0, float shade1, float s0, float s1, float t_bottom) {
+    if(render_zbuffer) {
+        float sin_yaw = sinf(-cam->yaw_rad), cos_yaw = cosf(-cam->yaw_rad);
+        float end[2][2] = { { x0 - cam->x, z0 - cam->z }, { x1 - cam->x, z1 - cam->z } };
+        float poly[2][RENDER_FLOOR_MAX_CORNERS][CLIP_FLOATS];
+        
+        // Bottom 0, bottom 1, top 1, top 0
+        for(int i = 0; i < 4; i++) {
+            int k = (i == 1 || i == 2);
+            int top = (i >= 2);
+            poly[0][i][CLIP_X] = end[k][0] * cos_yaw - end[k][1] * sin_yaw;
+            poly[0][i][CLIP_Y] = (k ? y1 : y0) + (top ? HEXAGON_WALL_HEIGHT : 0.0f) - cam->y;
+            poly[0][i][CLIP_DEPTH] = end[k][0] * sin_yaw + end[k][1] * cos_yaw + 10.0f;
+            poly[0][i][CLIP_SHADE] = k ? shade1 : shade0;
+            poly[0][i][CLIP_S] = k ? s1 : s0;
+            poly[0][i][CLIP_T] = top ? 0.0f : t_bottom;
+        }
+        render_view_polygon(poly, 4, RENDER_ZBUF_NEAR, 0, cam, trifmt);
+        return;
+    }
+    
+    screen_pos_t bottom[2], top[2];
+    bottom[0] = project_vertex(x0, y0, z0, cam);
+    bottom[1] = project_vertex(x1, y1, z1, cam);
+    top[0] = project_vertex(x0, y0 + HEXAGON_WALL_HEIGHT, z0, cam);
+    top[1] = project_vertex(x1, y1 + HEXAGON_WALL_HEIGHT, z1, cam);
+    if(!bottom[0].valid || !bottom[1].valid || !top[0].valid || !top[1].valid) return;
+    
+    bottom[0].shade = top[0].shade = shade0;
+    bottom[1].shade = top[1].shade = shade1;
+    bottom[0].s = top[0].s = s0;
+    bottom[1].s = top[1].s = s1;
+    bottom[0].t = bottom[1].t = t_bottom;
+    render_triangle(trifmt, &bottom[0], &bottom[1], &top[0]);  // bottom-left, bottom-right, top-left
+    render_triangle(trifmt, &bottom[1], &top[1], &top[0]);     // bottom-right, top-right, top-left
+}
+
 // Render hexagon floor
 void render_hexagon_floor(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt) {
     // Project hexagon vertices to screen coordinates using floor projection
     screen_pos_t screen_pos[6];
+    float s[6], t[6];
+    floor_texcoords(hex->vertices_x, hex->vertices_z, 6, TEXTURE_FLOOR, s, t);
     for(int i = 0; i < 6; i++) {
-        screen_pos[i] = project_vertex_floor(hex->vertices_x[i], 0.0f, hex->vertices_z[i], cam);
+        screen_pos[i] = project_vertex_floor(hex->vertices_x[i], hexagon_corner_floor_y(hex, i), hex->vertices_z[i], cam);
+        screen_pos[i].shade = corner_shade(hex, i);
+        screen_pos[i].s = s[i];
+        screen_pos[i].t = t[i];
     }
     
-    // Set floor color (gray)
-    rdpq_set_prim_color(RGBA32(128, 128, 128, 255));
+    rdpq_set_prim_color(render_material_color(RENDER_MATERIAL_FLOOR));
     
     // Draw triangles forming flat hexagon plane (render unconditionally)
-    // Triangle 1: vertices 0, 1, 2
-    {
-        float v1[2] = { screen_pos[0].x, screen_pos[0].y };
-        float v2[2] = { screen_pos[1].x, screen_pos[1].y };
-        float v3[2] = { screen_pos[2].x, screen_pos[2].y };
-        rdpq_triangle(trifmt, v1, v2, v3);
-    }
-    
-    // Triangle 2: vertices 0, 2, 3  
-    {
-        float v4[2] = { screen_pos[0].x, screen_pos[0].y };
-        float v5[2] = { screen_pos[2].x, screen_pos[2].y };
-        float v6[2] = { screen_pos[3].x, screen_pos[3].y };
-        rdpq_triangle(trifmt, v4, v5, v6);
-    }
-    
-    // Triangle 3: vertices 0, 3, 4
-    {
-        float v7[2] = { screen_pos[0].x, screen_pos[0].y };
-        float v8[2] = { screen_pos[3].x, screen_pos[3].y };
-        float v9[2] = { screen_pos[4].x, screen_pos[4].y };
-        rdpq_triangle(trifmt, v7, v8, v9);
-    }
-    
-    // Triangle 4: vertices 0, 4, 5
-    {
-        float v10[2] = { screen_pos[0].x, screen_pos[0].y };
-        float v11[2] = { screen_pos[4].x, screen_pos[4].y };
-        float v12[2] = { screen_pos[5].x, screen_pos[5].y };
-        rdpq_triangle(trifmt, v10, v11, v12);
-    }
+    render_triangle(trifmt, &screen_pos[0], &screen_pos[1], &screen_pos[2]);  // Triangle 1: vertices 0, 1, 2
+    render_triangle(trifmt, &screen_pos[0], &screen_pos[2], &screen_pos[3]);  // Triangle 2: vertices 0, 2, 3
+    render_triangle(trifmt, &screen_pos[0], &screen_pos[3], &screen_pos[4]);  // Triangle 3: vertices 0, 3, 4
+    render_triangle(trifmt, &screen_pos[0], &screen_pos[4], &screen_pos[5]);  // Triangle 4: vertices 0, 4, 5
 }
 
 // Render hexagon ceiling
 void render_hexagon_ceiling(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt) {
-    // Project hexagon vertices to screen coordinates at ceiling height (20.0f)
+    // Project hexagon vertices to screen coordinates at ceiling height
     screen_pos_t screen_pos[6];
+    float s[6], t[6];
+    floor_texcoords(hex->vertices_x, hex->vertices_z, 6, TEXTURE_CEILING, s, t);
     for(int i = 0; i < 6; i++) {
-        screen_pos[i] = project_vertex_floor(hex->vertices_x[i], 20.0f, hex->vertices_z[i], cam);
+        float y = hexagon_corner_floor_y(hex, i) + HEXAGON_WALL_HEIGHT;
+        screen_pos[i] = project_vertex_floor(hex->vertices_x[i], y, hex->vertices_z[i], cam);
+        screen_pos[i].shade = corner_shade(hex, i);
+        screen_pos[i].s = s[i];
+        screen_pos[i].t = t[i];
     }
     
-    // Set ceiling color (darker gray than floor)
-    rdpq_set_prim_color(RGBA32(64, 64, 64, 255));
+    rdpq_set_prim_color(render_material_color(RENDER_MATERIAL_CEILING));
     
     // Draw triangles forming flat hexagon plane (render unconditionally)
     // Note: Reverse winding order for ceiling so triangles face downward
-    // Triangle 1: vertices 2, 1, 0 (reversed from floor)
-    {
-        float v1[2] = { screen_pos[2].x, screen_pos[2].y };
-        float v2[2] = { screen_pos[1].x, screen_pos[1].y };
-        float v3[2] = { screen_pos[0].x, screen_pos[0].y };
-        rdpq_triangle(trifmt, v1, v2, v3);
-    }
-    
-    // Triangle 2: vertices 3, 2, 0 (reversed from floor)
-    {
-        float v4[2] = { screen_pos[3].x, screen_pos[3].y };
-        float v5[2] = { screen_pos[2].x, screen_pos[2].y };
-        float v6[2] = { screen_pos[0].x, screen_pos[0].y };
-        rdpq_triangle(trifmt, v4, v5, v6);
-    }
-    
-    // Triangle 3: vertices 4, 3, 0 (reversed from floor)
-    {
-        float v7[2] = { screen_pos[4].x, screen_pos[4].y };
-        float v8[2] = { screen_pos[3].x, screen_pos[3].y };
-        float v9[2] = { screen_pos[0].x, screen_pos[0].y };
-        rdpq_triangle(trifmt, v7, v8, v9);
-    }
-    
-    // Triangle 4: vertices 5, 4, 0 (reversed from floor)
-    {
-        float v10[2] = { screen_pos[5].x, screen_pos[5].y };
-        float v11[2] = { screen_pos[4].x, screen_pos[4].y };
-        float v12[2] = { screen_pos[0].x, screen_pos[0].y };
-        rdpq_triangle(trifmt, v10, v11, v12);
-    }
+    render_triangle(trifmt, &screen_pos[2], &screen_pos[1], &screen_pos[0]);  // Triangle 1: vertices 2, 1, 0
+    render_triangle(trifmt, &screen_pos[3], &screen_pos[2], &screen_pos[0]);  // Triangle 2: vertices 3, 2, 0
+    render_triangle(trifmt, &screen_pos[4], &screen_pos[3], &screen_pos[0]);  // Triangle 3: vertices 4, 3, 0
+    render_triangle(trifmt, &screen_pos[5], &screen_pos[4], &screen_pos[0]);  // Triangle 4: vertices 5, 4, 0
 }
 
 // Render pillars at hexagon vertices
@@ -175,6 +342,7 @@ void render_hexagon_pillars(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt
         float pillar_center_x = hex->vertices_x[i];
         float pillar_center_z = hex->vertices_z[i];
         float pillar_size = 1.0f;  // Half-size for square
+        float floor_y = hexagon_corner_floor_y(hex, i);
         
         // Four corners of the pillar base
         float corners_x[4] = {
@@ -190,53 +358,30 @@ void render_hexagon_pillars(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt
             pillar_center_z + pillar_size   // Top-left
         };
         
-        // Project each corner for bottom (Y=0) and top (Y=20)
+        // Project each corner for bottom (floor) and top (ceiling)
         screen_pos_t bottom_screen[4], top_screen[4];
         
         for(int j = 0; j < 4; j++) {
-            bottom_screen[j] = project_vertex(corners_x[j], 0.0f, corners_z[j], cam);
-            top_screen[j] = project_vertex(corners_x[j], 20.0f, corners_z[j], cam);
+            bottom_screen[j] = project_vertex(corners_x[j], floor_y, corners_z[j], cam);
+            top_screen[j] = project_vertex(corners_x[j], floor_y + HEXAGON_WALL_HEIGHT, corners_z[j], cam);
         }
         
         // Draw pillar faces as triangles (simplified - just front face)
         if(bottom_screen[0].valid && bottom_screen[1].valid && top_screen[0].valid && top_screen[1].valid) {
-            // Triangle 1: bottom-left, bottom-right, top-left
-            float v1[2] = { bottom_screen[0].x, bottom_screen[0].y };
-            float v2[2] = { bottom_screen[1].x, bottom_screen[1].y };
-            float v3[2] = { top_screen[0].x, top_screen[0].y };
-            rdpq_triangle(trifmt, v1, v2, v3);
-            
-            // Triangle 2: bottom-right, top-right, top-left
-            float v4[2] = { bottom_screen[1].x, bottom_screen[1].y };
-            float v5[2] = { top_screen[1].x, top_screen[1].y };
-            float v6[2] = { top_screen[0].x, top_screen[0].y };
-            rdpq_triangle(trifmt, v4, v5, v6);
+            render_triangle(trifmt, &bottom_screen[0], &bottom_screen[1], &top_screen[0]);  // bottom-left, bottom-right, top-left
+            render_triangle(trifmt, &bottom_screen[1], &top_screen[1], &top_screen[0]);     // bottom-right, top-right, top-left
         }
     }
 }
 
 // Helper function to render a full wall between two vertices
 static void render_wall_segment(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt, int v1_idx, int v2_idx) {
-    screen_pos_t wall_bottom[2], wall_top[2];
-    wall_bottom[0] = project_vertex(hex->vertices_x[v1_idx], 0.0f, hex->vertices_z[v1_idx], cam);
-    wall_bottom[1] = project_vertex(hex->vertices_x[v2_idx], 0.0f, hex->vertices_z[v2_idx], cam);
-    wall_top[0] = project_vertex(hex->vertices_x[v1_idx], 20.0f, hex->vertices_z[v1_idx], cam);
-    wall_top[1] = project_vertex(hex->vertices_x[v2_idx], 20.0f, hex->vertices_z[v2_idx], cam);
-    
-    // Draw wall as 2 triangles if all vertices are valid
-    if(wall_bottom[0].valid && wall_bottom[1].valid && wall_top[0].valid && wall_top[1].valid) {
-        // Triangle 1: bottom-left, bottom-right, top-left
-        float n1[2] = { wall_bottom[0].x, wall_bottom[0].y };
-        float n2[2] = { wall_bottom[1].x, wall_bottom[1].y };
-        float n3[2] = { wall_top[0].x, wall_top[0].y };
-        rdpq_triangle(trifmt, n1, n2, n3);
-        
-        // Triangle 2: bottom-right, top-right, top-left
-        float n4[2] = { wall_bottom[1].x, wall_bottom[1].y };
-        float n5[2] = { wall_top[1].x, wall_top[1].y };
-        float n6[2] = { wall_top[0].x, wall_top[0].y };
-        rdpq_triangle(trifmt, n4, n5, n6);
-    }
+    // One texture repeat spans the wall, top row at the top
+    const texture_info_t* tex = &texture_info[TEXTURE_WALL];
+    render_wall_quad(cam, trifmt, hex->vertices_x[v1_idx], hex->vertices_z[v1_idx],
+                     hex->vertices_x[v2_idx], hex->vertices_z[v2_idx],
+                     hexagon_corner_floor_y(hex, v1_idx), hexagon_corner_floor_y(hex, v2_idx),
+                     corner_shade(hex, v1_idx), corner_shade(hex, v2_idx), 0.0f, tex->width, tex->height);
 }
 
 // Helper function to render doorway (partial walls from pillars with center gap)
@@ -246,176 +391,106 @@ static void render_doorway_segment(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t*
     float dz = hex->center_z - cam->z;
     float dist_sq = dx*dx + dz*dz;
     int skip_doorframes = (dist_sq > 40000.0f); // Skip doorframes beyond 200 units
-    screen_pos_t wall_bottom[2], wall_top[2];
-    wall_bottom[0] = project_vertex(hex->vertices_x[v1_idx], 0.0f, hex->vertices_z[v1_idx], cam);
-    wall_bottom[1] = project_vertex(hex->vertices_x[v2_idx], 0.0f, hex->vertices_z[v2_idx], cam);
-    wall_top[0] = project_vertex(hex->vertices_x[v1_idx], 20.0f, hex->vertices_z[v1_idx], cam);
-    wall_top[1] = project_vertex(hex->vertices_x[v2_idx], 20.0f, hex->vertices_z[v2_idx], cam);
-    
-    if(wall_bottom[0].valid && wall_bottom[1].valid && wall_top[0].valid && wall_top[1].valid) {
-        // Calculate doorway dimensions (leave 1/3 gap in center, 1/3 wall on each side)
-        float door_gap = 0.33f;
-        float wall_portion = (1.0f - door_gap) / 2.0f;
-        
-        // Left wall segment (interpolate in world space, then project)
-        float left_end_world_x = hex->vertices_x[v1_idx] + wall_portion * (hex->vertices_x[v2_idx] - hex->vertices_x[v1_idx]);
-        float left_end_world_z = hex->vertices_z[v1_idx] + wall_portion * (hex->vertices_z[v2_idx] - hex->vertices_z[v1_idx]);
-        
-        screen_pos_t left_end_bottom = project_vertex(left_end_world_x, 0.0f, left_end_world_z, cam);
-        screen_pos_t left_end_top = project_vertex(left_end_world_x, 20.0f, left_end_world_z, cam);
-        
-        if(wall_bottom[0].valid && wall_top[0].valid && left_end_bottom.valid && left_end_top.valid) {
-            // Left wall triangles
-            float l1[2] = { wall_bottom[0].x, wall_bottom[0].y };
-            float l2[2] = { left_end_bottom.x, left_end_bottom.y };
-            float l3[2] = { wall_top[0].x, wall_top[0].y };
-            rdpq_triangle(trifmt, l1, l2, l3);
-            
-            float l4[2] = { left_end_bottom.x, left_end_bottom.y };
-            float l5[2] = { left_end_top.x, left_end_top.y };
-            float l6[2] = { wall_top[0].x, wall_top[0].y };
-            rdpq_triangle(trifmt, l4, l5, l6);
-        }
-        
-        // Right wall segment (interpolate in world space, then project)
-        float right_wall_start = 1.0f - wall_portion;
-        float right_start_world_x = hex->vertices_x[v1_idx] + right_wall_start * (hex->vertices_x[v2_idx] - hex->vertices_x[v1_idx]);
-        float right_start_world_z = hex->vertices_z[v1_idx] + right_wall_start * (hex->vertices_z[v2_idx] - hex->vertices_z[v1_idx]);
-        
-        screen_pos_t right_start_bottom = project_vertex(right_start_world_x, 0.0f, right_start_world_z, cam);
-        screen_pos_t right_start_top = project_vertex(right_start_world_x, 20.0f, right_start_world_z, cam);
-        
-        if(wall_bottom[1].valid && wall_top[1].valid && right_start_bottom.valid && right_start_top.valid) {
-            // Right wall triangles
-            float r1[2] = { right_start_bottom.x, right_start_bottom.y };
-            float r2[2] = { wall_bottom[1].x, wall_bottom[1].y };
-            float r3[2] = { right_start_top.x, right_start_top.y };
-            rdpq_triangle(trifmt, r1, r2, r3);
-            
-            float r4[2] = { wall_bottom[1].x, wall_bottom[1].y };
-            float r5[2] = { wall_top[1].x, wall_top[1].y };
-            float r6[2] = { right_start_top.x, right_start_top.y };
-            rdpq_triangle(trifmt, r4, r5, r6);
-        }
-        
-        // Skip doorframes for distant hexagons to save triangles
-        if(skip_doorframes) return;
-        
-        // Set doorframe color to black
-        rdpq_set_prim_color(RGBA32(0, 0, 0, 255));
-        
-        // Use the already calculated door edge positions
-        // (left_end_world_x/z and right_start_world_x/z are already calculated above)
-        
-        // Calculate wall direction and parallel offset for doorframe thickness
-        float wall_dx = hex->vertices_x[v2_idx] - hex->vertices_x[v1_idx];
-        float wall_dz = hex->vertices_z[v2_idx] - hex->vertices_z[v1_idx];
-        float wall_length = sqrtf(wall_dx * wall_dx + wall_dz * wall_dz);
-        
-        // Doorframe thickness parallel to wall direction (thinner)
-        float frame_thickness = 1.5f;
-        float frame_dx = (wall_dx / wall_length) * frame_thickness;
-        float frame_dz = (wall_dz / wall_length) * frame_thickness;
-        
-        // Left doorframe (at end of left wall segment)
-        // Full height of door segment
-        float frame_height_start = 0.0f;
-        float frame_height_end = 20.0f;
-        
-        // Position doorframes directly at wall surface (no offset)
-        screen_pos_t left_frame_1 = project_vertex(left_end_world_x, frame_height_start, left_end_world_z, cam);
-        screen_pos_t left_frame_2 = project_vertex(left_end_world_x + frame_dx, frame_height_start, left_end_world_z + frame_dz, cam);
-        screen_pos_t left_frame_3 = project_vertex(left_end_world_x, frame_height_end, left_end_world_z, cam);
-        screen_pos_t left_frame_4 = project_vertex(left_end_world_x + frame_dx, frame_height_end, left_end_world_z + frame_dz, cam);
-        
-        if(left_frame_1.valid && left_frame_2.valid && left_frame_3.valid && left_frame_4.valid) {
-            float lf1[2] = { left_frame_1.x, left_frame_1.y };
-            float lf2[2] = { left_frame_2.x, left_frame_2.y };
-            float lf3[2] = { left_frame_3.x, left_frame_3.y };
-            rdpq_triangle(trifmt, lf1, lf2, lf3);
-            
-            float lf4[2] = { left_frame_2.x, left_frame_2.y };
-            float lf5[2] = { left_frame_4.x, left_frame_4.y };
-            float lf6[2] = { left_frame_3.x, left_frame_3.y };
-            rdpq_triangle(trifmt, lf4, lf5, lf6);
-        }
-        
-        // Right doorframe (at end of right wall segment)
-        screen_pos_t right_frame_1 = project_vertex(right_start_world_x, frame_height_start, right_start_world_z, cam);
-        screen_pos_t right_frame_2 = project_vertex(right_start_world_x - frame_dx, frame_height_start, right_start_world_z - frame_dz, cam);
-        screen_pos_t right_frame_3 = project_vertex(right_start_world_x, frame_height_end, right_start_world_z, cam);
-        screen_pos_t right_frame_4 = project_vertex(right_start_world_x - frame_dx, frame_height_end, right_start_world_z - frame_dz, cam);
-        
-        if(right_frame_1.valid && right_frame_2.valid && right_frame_3.valid && right_frame_4.valid) {
-            float rf1[2] = { right_frame_1.x, right_frame_1.y };
-            float rf2[2] = { right_frame_2.x, right_frame_2.y };
-            float rf3[2] = { right_frame_3.x, right_frame_3.y };
-            rdpq_triangle(trifmt, rf1, rf2, rf3);
-            
-            float rf4[2] = { right_frame_2.x, right_frame_2.y };
-            float rf5[2] = { right_frame_4.x, right_frame_4.y };
-            float rf6[2] = { right_frame_3.x, right_frame_3.y };
-            rdpq_triangle(trifmt, rf4, rf5, rf6);
-        }
-        
-        // Reset wall color back to green
-        rdpq_set_prim_color(RGBA32(0, 255, 0, 255));
-    }
-}
-
-// Render walls for a hexagon with doorway logic
-void render_hexagon_walls(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt) {
-    rdpq_set_prim_color(RGBA32(0, 255, 0, 255));  // Green wall
-    
-    // North wall (vertices 1->2)
-    if(!(hex->connections & CONN_NORTH)) {
-        // No connection: full wall
-        render_wall_segment(hex, cam, trifmt, 1, 2);
-    } else if(hex->type == HEX_TYPE_CORRIDOR) {
-        // Corridor connection: doorway
-        render_doorway_segment(hex, cam, trifmt, 1, 2);
-    }
-    // Room connection: no wall at all
-    
-    // South wall (vertices 4->5)
-    if(!(hex->connections & CONN_SOUTH)) {
-        render_wall_segment(hex, cam, trifmt, 4, 5);
-    } else if(hex->type == HEX_TYPE_CORRIDOR) {
-        render_doorway_segment(hex, cam, trifmt, 4, 5);
-    }
-    
-    // Southeast wall (vertices 5->0)
-    if(!(hex->connections & CONN_SOUTHEAST)) {
-        render_wall_segment(hex, cam, trifmt, 5, 0);
-    } else if(hex->type == HEX_TYPE_CORRIDOR) {
-        render_doorway_segment(hex, cam, trifmt, 5, 0);
+    float v1_x = hex->vertices_x[v1_idx], v1_z = hex->vertices_z[v1_idx];
+    float v2_x = hex->vertices_x[v2_idx], v2_z = hex->vertices_z[v2_idx];
+    float shade_1 = corner_shade(hex, v1_idx), shade_2 = corner_shade(hex, v2_idx);
+    float y_1 = hexagon_corner_floor_y(hex, v1_idx), y_2 = hexagon_corner_floor_y(hex, v2_idx);
+    const texture_info_t* tex = &texture_info[TEXTURE_WALL];
+    
+    // Painter's order skips the whole doorway once a pillar is behind the
+    // eye; Z-buffered, each piece is clipped on its own
+    if(!render_zbuffer && (!project_vertex(v1_x, y_1, v1_z, cam).valid || !project_vertex(v2_x, y_2, v2_z, cam).valid)) {
+        return;
     }
     
-    // Northeast wall (vertices 0->1)
-    if(!(hex->connections & CONN_NORTHEAST)) {
-        render_wall_segment(hex, cam, trifmt, 0, 1);
-    } else if(hex->type == HEX_TYPE_CORRIDOR) {
-        render_doorway_segment(hex, cam, trifmt, 0, 1);
-    }
+    // Calculate doorway dimensions (leave 1/3 gap in center, 1/3 wall on each side)
+    float door_gap = 0.33f;
+    float wall_portion = (1.0f - door_gap) / 2.0f;
     
-    // Northwest wall (vertices 2->3)
-    if(!(hex->connections & CONN_NORTHWEST)) {
-        render_wall_segment(hex, cam, trifmt, 2, 3);
-    } else if(hex->type == HEX_TYPE_CORRIDOR) {
-        render_doorway_segment(hex, cam, trifmt, 2, 3);
-    }
+    // Left wall segment (interpolate in world space, then project)
+    float left_end_world_x = v1_x + wall_portion * (v2_x - v1_x);
+    float left_end_world_z = v1_z + wall_portion * (v2_z - v1_z);
+    float left_end_y = y_1 + wall_portion * (y_2 - y_1);
+    render_wall_quad(cam, trifmt, v1_x, v1_z, left_end_world_x, left_end_world_z, y_1, left_end_y,
+                     shade_1, shade_1 + wall_portion * (shade_2 - shade_1),
+                     0.0f, wall_portion * tex->width, tex->height);
     
-    // Southwest wall (vertices 3->4)
-    if(!(hex->connections & CONN_SOUTHWEST)) {
-        render_wall_segment(hex, cam, trifmt, 3, 4);
-    } else if(hex->type == HEX_TYPE_CORRIDOR) {
-        render_doorway_segment(hex, cam, trifmt, 3, 4);
+    // Right wall segment (interpolate in world space, then project)
+    float right_wall_start = 1.0f - wall_portion;
+    float right_start_world_x = v1_x + right_wall_start * (v2_x - v1_x);
+    float right_start_world_z = v1_z + right_wall_start * (v2_z - v1_z);
+    float right_start_y = y_1 + right_wall_start * (y_2 - y_1);
+    render_wall_quad(cam, trifmt, right_start_world_x, right_start_world_z, v2_x, v2_z, right_start_y, y_2,
+                     shade_1 + right_wall_start * (shade_2 - shade_1), shade_2,
+                     right_wall_start * tex->width, tex->width, tex->height);
+    
+    // Skip doorframes for distant hexagons to save triangles
+    if(skip_doorframes) return;
+    
+    // Doorframes are black
+    rdpq_set_prim_color(render_material_color(RENDER_MATERIAL_FRAME));
+    
+    // Calculate wall direction and parallel offset for doorframe thickness
+    float wall_dx = v2_x - v1_x;
+    float wall_dz = v2_z - v1_z;
+    float wall_length = sqrtf(wall_dx * wall_dx + wall_dz * wall_dz);
+    
+    // Doorframe thickness parallel to wall direction (thinner)
+    float frame_thickness = 1.5f;
+    float frame_dx = (wall_dx / wall_length) * frame_thickness;
+    float frame_dz = (wall_dz / wall_length) * frame_thickness;
+    float frame_dy = (y_2 - y_1) * (frame_thickness / wall_length);
+    
+    // Left doorframe (at end of left wall segment), right doorframe (at the
+    // start of the right wall segment), full height, directly at the wall
+    // surface and unlit
+    render_wall_quad(cam, trifmt, left_end_world_x, left_end_world_z,
+                     left_end_world_x + frame_dx, left_end_world_z + frame_dz,
+                     left_end_y, left_end_y + frame_dy, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f);
+    render_wall_quad(cam, trifmt, right_start_world_x, right_start_world_z,
+                     right_start_world_x - frame_dx, right_start_world_z - frame_dz,
+                     right_start_y, right_start_y - frame_dy, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f);
+    
+    // Reset to the wall colour
+    rdpq_set_prim_color(render_material_color(RENDER_MATERIAL_WALL));
+}
+
+// Centre of projection: project_vertex offsets view depth by 10, which puts
+// the eye 10 units behind the camera position
+static void camera_eye(const camera_t* cam, float* x, float* z) {
+    *x = cam->x - 10.0f * sinf(-cam->yaw_rad);
+    *z = cam->z - 10.0f * cosf(-cam->yaw_rad);
+}
+
+// Wall side submitted for an eye position: back faces are skipped before
+// any projection, except sides that must stay two-sided
+static int render_wall_faces(hexagon_t* hex, int wall_dir, float eye_x, float eye_z) {
+    if(!render_backface_cull) return 1;
+    if(geometry_two_sided_walls[hex - hexagons] & (1 << wall_dir)) return 1;
+    return geometry_wall_faces(hex, wall_dir, eye_x, eye_z);
+}
+
+// Render walls for a hexagon with doorway logic (front faces only)
+void render_hexagon_walls(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt) {
+    float eye_x, eye_z;
+    camera_eye(cam, &eye_x, &eye_z);
+    for(int wall_dir = 0; wall_dir < 6; wall_dir++) {
+        if(render_wall_faces(hex, wall_dir, eye_x, eye_z)) {
+            render_single_wall(hex, wall_dir, cam, trifmt);
+        }
     }
 }
 
-// Render a single wall direction for depth sorting
+static void render_ramp_surfaces(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt);
+
+// Render a single wall direction for depth sorting (RENDER_WALL_RAMP: the
+// ramp's floor and ceiling)
 void render_single_wall(hexagon_t* hex, int wall_dir, camera_t* cam, rdpq_trifmt_t* trifmt) {
-    rdpq_set_prim_color(RGBA32(0, 255, 0, 255));  // Green wall
+    if(wall_dir == RENDER_WALL_RAMP) {
+        render_ramp_surfaces(hex, cam, trifmt);
+        return;
+    }
+    rdpq_set_prim_color(render_material_color(RENDER_MATERIAL_WALL));
     
     switch(wall_dir) {
         case 2: // North wall (vertices 1->2)
@@ -463,289 +538,6 @@ void render_single_wall(hexagon_t* hex, int wall_dir, camera_t* cam, rdpq_trifmt
     }
 }
 
-// Check collision with walls - returns 1 if collision detected, 0 if safe
-int check_collision(float new_x, float new_z, float player_radius) {
-    // Quick optimization: only check nearby hexagons for collision
-    // (collision radius + hex size + some margin)
-    float max_collision_dist_sq = (player_radius + 50.0f) * (player_radius + 50.0f);
-    
-    // Check against all hexagons and their walls
-    for(int hex_i = 0; hex_i < MAP_HEX_COUNT; hex_i++) {
-        hexagon_t* hex = &hexagons[hex_i];
-        
-        // Skip hexagons too far away for collision
-        float dx = hex->center_x - new_x;
-        float dz = hex->center_z - new_z;
-        if(dx*dx + dz*dz > max_collision_dist_sq) continue;
-        
-        // Check each wall direction for this hexagon
-        for(int wall_dir = 0; wall_dir < 6; wall_dir++) {
-            // Only check walls that actually exist (no connections)
-            int has_wall = 0;
-            switch(wall_dir) {
-                case 2: // North
-                    has_wall = !(hex->connections & CONN_NORTH);
-                    break;
-                case 5: // South  
-                    has_wall = !(hex->connections & CONN_SOUTH);
-                    break;
-                case 0: // Southeast
-                    has_wall = !(hex->connections & CONN_SOUTHEAST);
-                    break;
-                case 1: // Northeast
-                    has_wall = !(hex->connections & CONN_NORTHEAST);
-                    break;
-                case 3: // Northwest
-                    has_wall = !(hex->connections & CONN_NORTHWEST);
-                    break;
-                case 4: // Southwest
-                    has_wall = !(hex->connections & CONN_SOUTHWEST);
-                    break;
-            }
-            
-            // Check for doorway segments (corridors with connections)
-            int has_doorway = 0;
-            switch(wall_dir) {
-                case 2: has_doorway = (hex->connections & CONN_NORTH) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 5: has_doorway = (hex->connections & CONN_SOUTH) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 0: has_doorway = (hex->connections & CONN_SOUTHEAST) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 1: has_doorway = (hex->connections & CONN_NORTHEAST) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 3: has_doorway = (hex->connections & CONN_NORTHWEST) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 4: has_doorway = (hex->connections & CONN_SOUTHWEST) && (hex->type == HEX_TYPE_CORRIDOR); break;
-            }
-            
-            if(has_wall || has_doorway) {
-                // Get wall endpoints based on direction
-                int start_vert, end_vert;
-                switch(wall_dir) {
-                    case 2: start_vert = 1; end_vert = 2; break; // North
-                    case 5: start_vert = 4; end_vert = 5; break; // South
-                    case 0: start_vert = 5; end_vert = 0; break; // Southeast
-                    case 1: start_vert = 0; end_vert = 1; break; // Northeast
-                    case 3: start_vert = 2; end_vert = 3; break; // Northwest
-                    case 4: start_vert = 3; end_vert = 4; break; // Southwest
-                }
-                
-                if(has_wall) {
-                    // Full wall collision
-                    float wall_x1 = hex->vertices_x[start_vert];
-                    float wall_z1 = hex->vertices_z[start_vert];
-                    float wall_x2 = hex->vertices_x[end_vert];
-                    float wall_z2 = hex->vertices_z[end_vert];
-                    
-                    if(point_to_line_distance(new_x, new_z, wall_x1, wall_z1, wall_x2, wall_z2) < player_radius) {
-                        return 1; // Collision detected
-                    }
-                } else if(has_doorway) {
-                    // Doorway collision - check doorframe segments only
-                    if(check_doorframe_collision(hex, wall_dir, start_vert, end_vert, new_x, new_z, player_radius)) {
-                        return 1; // Doorframe collision detected
-                    }
-                }
-            }
-        }
-    }
-    
-    return 0; // No collision
-}
-
-// Advanced collision with wall sliding
-int check_collision_with_slide(float old_x, float old_z, float *new_x, float *new_z, float player_radius) {
-    // If no collision at target position, allow movement
-    if(!check_collision(*new_x, *new_z, player_radius)) {
-        return 0; // No collision, movement allowed
-    }
-    
-    // Find the closest wall that's blocking us
-    float closest_dist = 1000000.0f;
-    float wall_x1, wall_z1, wall_x2, wall_z2;
-    int found_wall = 0;
-    
-    float max_collision_dist_sq = (player_radius + 50.0f) * (player_radius + 50.0f);
-    
-    for(int hex_i = 0; hex_i < MAP_HEX_COUNT; hex_i++) {
-        hexagon_t* hex = &hexagons[hex_i];
-        
-        // Skip hexagons too far away
-        float dx = hex->center_x - *new_x;
-        float dz = hex->center_z - *new_z;
-        if(dx*dx + dz*dz > max_collision_dist_sq) continue;
-        
-        for(int wall_dir = 0; wall_dir < 6; wall_dir++) {
-            // Check if this wall exists and is blocking
-            int has_wall = 0;
-            int has_doorway = 0;
-            
-            switch(wall_dir) {
-                case 2: has_wall = !(hex->connections & CONN_NORTH); has_doorway = (hex->connections & CONN_NORTH) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 5: has_wall = !(hex->connections & CONN_SOUTH); has_doorway = (hex->connections & CONN_SOUTH) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 0: has_wall = !(hex->connections & CONN_SOUTHEAST); has_doorway = (hex->connections & CONN_SOUTHEAST) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 1: has_wall = !(hex->connections & CONN_NORTHEAST); has_doorway = (hex->connections & CONN_NORTHEAST) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 3: has_wall = !(hex->connections & CONN_NORTHWEST); has_doorway = (hex->connections & CONN_NORTHWEST) && (hex->type == HEX_TYPE_CORRIDOR); break;
-                case 4: has_wall = !(hex->connections & CONN_SOUTHWEST); has_doorway = (hex->connections & CONN_SOUTHWEST) && (hex->type == HEX_TYPE_CORRIDOR); break;
-            }
-            
-            if(has_wall || has_doorway) {
-                int start_vert, end_vert;
-                switch(wall_dir) {
-                    case 2: start_vert = 1; end_vert = 2; break;
-                    case 5: start_vert = 4; end_vert = 5; break;
-                    case 0: start_vert = 5; end_vert = 0; break;
-                    case 1: start_vert = 0; end_vert = 1; break;
-                    case 3: start_vert = 2; end_vert = 3; break;
-                    case 4: start_vert = 3; end_vert = 4; break;
-                }
-                
-                float w_x1 = hex->vertices_x[start_vert];
-                float w_z1 = hex->vertices_z[start_vert];
-                float w_x2 = hex->vertices_x[end_vert];
-                float w_z2 = hex->vertices_z[end_vert];
-                
-                // For doorways, check wall segments but NOT doorframes
-                if(has_doorway) {
-                    // Check left wall segment (first 33% - the actual wall)
-                    float door_gap = 0.33f;
-                    float wall_portion = (1.0f - door_gap) / 2.0f;
-                    float left_end_x = w_x1 + wall_portion * (w_x2 - w_x1);
-                    float left_end_z = w_z1 + wall_portion * (w_z2 - w_z1);
-                    
-                    float dist = point_to_line_distance(*new_x, *new_z, w_x1, w_z1, left_end_x, left_end_z);
-                    if(dist < player_radius && dist < closest_dist) {
-                        closest_dist = dist;
-                        wall_x1 = w_x1; wall_z1 = w_z1; wall_x2 = left_end_x; wall_z2 = left_end_z;
-                        found_wall = 1;
-                    }
-                    
-                    // Check right wall segment (last 33% - the actual wall)
-                    float right_wall_start = 1.0f - wall_portion;
-                    float right_start_x = w_x1 + right_wall_start * (w_x2 - w_x1);
-                    float right_start_z = w_z1 + right_wall_start * (w_z2 - w_z1);
-                    
-                    dist = point_to_line_distance(*new_x, *new_z, right_start_x, right_start_z, w_x2, w_z2);
-                    if(dist < player_radius && dist < closest_dist) {
-                        closest_dist = dist;
-                        wall_x1 = right_start_x; wall_z1 = right_start_z; wall_x2 = w_x2; wall_z2 = w_z2;
-                        found_wall = 1;
-                    }
-                    
-                    // Skip the middle doorframe section - no collision there
-                } else if(has_wall) {
-                    // Check full wall for solid walls
-                    float dist = point_to_line_distance(*new_x, *new_z, w_x1, w_z1, w_x2, w_z2);
-                    if(dist < player_radius && dist < closest_dist) {
-                        closest_dist = dist;
-                        wall_x1 = w_x1; wall_z1 = w_z1; wall_x2 = w_x2; wall_z2 = w_z2;
-                        found_wall = 1;
-                    }
-                }
-            }
-        }
-    }
-    
-    if(!found_wall) {
-        return 1; // Collision but no clear wall found, stop movement
-    }
-    
-    // Calculate wall direction vector
-    float wall_dx = wall_x2 - wall_x1;
-    float wall_dz = wall_z2 - wall_z1;
-    float wall_len = sqrtf(wall_dx*wall_dx + wall_dz*wall_dz);
-    
-    if(wall_len < 0.001f) {
-        return 1; // Degenerate wall, stop movement
-    }
-    
-    // Normalize wall direction
-    wall_dx /= wall_len;
-    wall_dz /= wall_len;
-    
-    // Movement vector
-    float move_dx = *new_x - old_x;
-    float move_dz = *new_z - old_z;
-    
-    // Project movement onto wall direction (slide component)
-    float slide_amount = move_dx * wall_dx + move_dz * wall_dz;
-    
-    // Calculate slide position
-    float slide_x = old_x + wall_dx * slide_amount;
-    float slide_z = old_z + wall_dz * slide_amount;
-    
-    // Check if slide position is valid
-    if(!check_collision(slide_x, slide_z, player_radius)) {
-        *new_x = slide_x;
-        *new_z = slide_z;
-        return 0; // Sliding movement allowed
-    }
-    
-    return 1; // Can't slide, stop movement
-}
-
-// Helper function: distance from point to line segment
-float point_to_line_distance(float px, float pz, float x1, float z1, float x2, float z2) {
-    // Vector from line start to end
-    float line_dx = x2 - x1;
-    float line_dz = z2 - z1;
-    
-    // Vector from line start to point
-    float point_dx = px - x1;
-    float point_dz = pz - z1;
-    
-    // Project point onto line
-    float line_length_sq = line_dx * line_dx + line_dz * line_dz;
-    
-    if(line_length_sq < 0.001f) {
-        // Line is actually a point, return distance to that point
-        return sqrtf(point_dx * point_dx + point_dz * point_dz);
-    }
-    
-    float t = (point_dx * line_dx + point_dz * line_dz) / line_length_sq;
-    
-    // Clamp t to [0,1] to stay on line segment
-    if(t < 0.0f) t = 0.0f;
-    if(t > 1.0f) t = 1.0f;
-    
-    // Find closest point on line segment
-    float closest_x = x1 + t * line_dx;
-    float closest_z = z1 + t * line_dz;
-    
-    // Return distance from point to closest point on line
-    float dist_x = px - closest_x;
-    float dist_z = pz - closest_z;
-    return sqrtf(dist_x * dist_x + dist_z * dist_z);
-}
-
-// Check collision with doorframe segments
-int check_doorframe_collision(hexagon_t* hex, int wall_dir, int v1_idx, int v2_idx, float new_x, float new_z, float player_radius) {
-    // Calculate doorway dimensions (same as rendering logic)
-    float door_gap = 0.33f;
-    float wall_portion = (1.0f - door_gap) / 2.0f;
-    
-    // Left wall segment endpoints
-    float left_end_world_x = hex->vertices_x[v1_idx] + wall_portion * (hex->vertices_x[v2_idx] - hex->vertices_x[v1_idx]);
-    float left_end_world_z = hex->vertices_z[v1_idx] + wall_portion * (hex->vertices_z[v2_idx] - hex->vertices_z[v1_idx]);
-    
-    // Right wall segment endpoints  
-    float right_wall_start = 1.0f - wall_portion;
-    float right_start_world_x = hex->vertices_x[v1_idx] + right_wall_start * (hex->vertices_x[v2_idx] - hex->vertices_x[v1_idx]);
-    float right_start_world_z = hex->vertices_z[v1_idx] + right_wall_start * (hex->vertices_z[v2_idx] - hex->vertices_z[v1_idx]);
-    
-    // Check collision with left wall segment
-    if(point_to_line_distance(new_x, new_z, hex->vertices_x[v1_idx], hex->vertices_z[v1_idx], 
-                             left_end_world_x, left_end_world_z) < player_radius) {
-        return 1;
-    }
-    
-    // Check collision with right wall segment
-    if(point_to_line_distance(new_x, new_z, right_start_world_x, right_start_world_z,
-                             hex->vertices_x[v2_idx], hex->vertices_z[v2_idx]) < player_radius) {
-        return 1;
-    }
-    
-    // Skip doorframe collision - only check wall segments, not the frame pieces
-    
-    return 0; // No doorframe collision
-}
-
 // Check if hexagon is within camera frustum (field of view)
 int is_hexagon_in_frustum(hexagon_t* hex, camera_t* cam) {
     // Simple frustum culling based on angle from camera direction
@@ -774,19 +566,33 @@ int is_hexagon_in_frustum(hexagon_t* hex, camera_t* cam) {
     return cos_angle > -0.7f; // ~135 degree FOV (very wide)
 }
 
-// Combined visibility check: frustum + distance culling
-int should_render_hexagon(hexagon_t* hex, camera_t* cam) {
-    // Distance culling first (cheaper)
+// Check if the whole hexagon is past the fog end (fully fogged, so invisible)
+int is_hexagon_beyond_fog(hexagon_t* hex, camera_t* cam) {
     float dx = hex->center_x - cam->x;
     float dz = hex->center_z - cam->z;
-    float dist_sq = dx*dx + dz*dz;
     
-    if(dist_sq > 160000.0f) return 0; // Too far (~400 units)
+    // View depth of the center, as in project_vertex()
+    float depth = dx * sinf(-cam->yaw_rad) + dz * cosf(-cam->yaw_rad) + 10.0f;
+    return depth - RENDER_HEX_RADIUS > RENDER_FOG_END;
+}
+
+// Frustum, fog and distance tests of should_render_hexagon, given the
+// camera's forward vector and the squared distance to the hexagon centre
+static int hexagon_visible(const hexagon_t* hex, const camera_t* cam, float fwd_x, float fwd_z, float dist_sq) {
+    if(dist_sq > RENDER_CULL_DIST_SQ) return 0;
     
-    // Frustum culling
-    if(!is_hexagon_in_frustum(hex, cam)) return 0;
+    float along = (hex->center_x - cam->x) * fwd_x + (hex->center_z - cam->z) * fwd_z;
+    if(along + 10.0f - RENDER_HEX_RADIUS > RENDER_FOG_END) return 0;
     
-    return 1; // Passed all tests
+    if(dist_sq < 2500.0f) return 1;
+    return along > -0.7f * sqrtf(dist_sq);
+}
+
+// Combined visibility check: frustum + distance culling
+int should_render_hexagon(hexagon_t* hex, camera_t* cam) {
+    float dx = hex->center_x - cam->x;
+    float dz = hex->center_z - cam->z;
+    return hexagon_visible(hex, cam, sinf(-cam->yaw_rad), cosf(-cam->yaw_rad), dx*dx + dz*dz);
 }
 
 // Get LOD level based on distance (0 = highest detail, 2 = lowest detail)
@@ -804,44 +610,890 @@ int get_hexagon_lod_level(hexagon_t* hex, camera_t* cam) {
 void render_hexagon_floor_lod(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt, int lod_level) {
     // Project hexagon vertices to screen coordinates using floor projection
     screen_pos_t screen_pos[6];
+    float s[6], t[6];
+    floor_texcoords(hex->vertices_x, hex->vertices_z, 6, TEXTURE_FLOOR, s, t);
     for(int i = 0; i < 6; i++) {
-        screen_pos[i] = project_vertex_floor(hex->vertices_x[i], 0.0f, hex->vertices_z[i], cam);
+        screen_pos[i] = project_vertex_floor(hex->vertices_x[i], hexagon_corner_floor_y(hex, i), hex->vertices_z[i], cam);
+        screen_pos[i].shade = corner_shade(hex, i);
+        screen_pos[i].s = s[i];
+        screen_pos[i].t = t[i];
     }
     
-    // Set floor color (gray)
-    rdpq_set_prim_color(RGBA32(128, 128, 128, 255));
+    rdpq_set_prim_color(render_material_color(RENDER_MATERIAL_FLOOR));
     
     if(lod_level >= 2) {
         // LOD 2: Single quad (2 triangles) - very distant
-        float v1[2] = { screen_pos[0].x, screen_pos[0].y };
-        float v2[2] = { screen_pos[2].x, screen_pos[2].y };
-        float v3[2] = { screen_pos[4].x, screen_pos[4].y };
-        rdpq_triangle(trifmt, v1, v2, v3);
-        
-        float v4[2] = { screen_pos[0].x, screen_pos[0].y };
-        float v5[2] = { screen_pos[3].x, screen_pos[3].y };
-        float v6[2] = { screen_pos[4].x, screen_pos[4].y };
-        rdpq_triangle(trifmt, v4, v5, v6);
+        render_triangle(trifmt, &screen_pos[0], &screen_pos[2], &screen_pos[4]);
+        render_triangle(trifmt, &screen_pos[0], &screen_pos[3], &screen_pos[4]);
     } else if(lod_level == 1) {
         // LOD 1: Reduced triangles (3 triangles) - medium distance
-        float v1[2] = { screen_pos[0].x, screen_pos[0].y };
-        float v2[2] = { screen_pos[2].x, screen_pos[2].y };
-        float v3[2] = { screen_pos[4].x, screen_pos[4].y };
-        rdpq_triangle(trifmt, v1, v2, v3);
-        
-        float v4[2] = { screen_pos[0].x, screen_pos[0].y };
-        float v5[2] = { screen_pos[1].x, screen_pos[1].y };
-        float v6[2] = { screen_pos[2].x, screen_pos[2].y };
-        rdpq_triangle(trifmt, v4, v5, v6);
-        
-        float v7[2] = { screen_pos[0].x, screen_pos[0].y };
-        float v8[2] = { screen_pos[4].x, screen_pos[4].y };
-        float v9[2] = { screen_pos[5].x, screen_pos[5].y };
-        rdpq_triangle(trifmt, v7, v8, v9);
+        render_triangle(trifmt, &screen_pos[0], &screen_pos[2], &screen_pos[4]);
+        render_triangle(trifmt, &screen_pos[0], &screen_pos[1], &screen_pos[2]);
+        render_triangle(trifmt, &screen_pos[0], &screen_pos[4], &screen_pos[5]);
     } else {
         // LOD 0: Full detail (4 triangles) - close distance
         // Use the original rendering code
         render_hexagon_floor(hex, cam, trifmt);
         return;
     }
-}
\ No newline at end of file
+}
+
+// Visibility caches of recently visited cells: candidates within reach of
+// the cell, kept in the last frame's draw order (far to near) with the yaw
+// buckets each can be visible in - the portal layer's first, then the
+// level's own. Entries come from a fixed pool shared by all views; the least
+// recently used one is regathered when it runs out.
+typedef struct {
+    int q, r, level;                            // Camera cell gathered for
+    uint32_t last_used;                         // LRU stamp
+    int count;
+    int portal_count;                           // Leading entries in the portal layer
+    int32_t hex_index[RENDER_VIEW_CANDIDATES];
+    uint16_t bucket_mask[RENDER_VIEW_CANDIDATES];
+} view_cache_t;
+
+static arena_pool_t view_cache_pool;
+static view_cache_t** view_cache_live;          // Gathered entries (view_cache_live_count)
+static int view_cache_live_count;
+static uint32_t view_cache_version;             // render_world_version they were gathered at
+static uint32_t view_cache_clock;
+static view_cache_t* view_cache[RENDER_MAX_VIEWS];  // Entry of each view's current cell
+render_cache_stats_t render_cache_stats;
+
+// Per-hexagon stamps of the render_build_lists call that last emitted its
+// walls: an edge shared with a nearer hexagon is already in the list
+static uint16_t wall_emit_stamp[MAP_HEX_COUNT];
+static uint16_t wall_emit_call;
+
+// Advance a stamp counter; stamps are cleared when the counter wraps, so a
+// stale stamp never matches
+static uint16_t advance_stamp(uint16_t* counter, uint16_t* stamps, size_t bytes) {
+    if(++*counter == 0) {
+        memset(stamps, 0, bytes);
+        *counter = 1;
+    }
+    return *counter;
+}
+
+// Level a camera's eye is on: the one whose floor is nearest below the eye
+// height, changing halfway up a ramp as hexagon_level_at does
+int render_camera_level(const camera_t* cam) {
+    float floor_y = cam->y - HEXAGON_EYE_HEIGHT;
+    int level = (int)ceilf(floor_y / HEXAGON_LEVEL_HEIGHT - 0.5f);
+    return level < 0 ? 0 : (level >= HEXAGON_MAX_LEVELS ? HEXAGON_MAX_LEVELS - 1 : level);
+}
+
+// Axial cell a camera stands in on a level (nearest cell by plain rounding
+// when off the map, which keeps the camera within RENDER_CACHE_SLACK of its
+// centre)
+static void camera_cell(const camera_t* cam, int level, int* q, int* r) {
+    int center = hexagon_at_position(cam->x, cam->z, level);
+    if(center >= 0) {
+        *q = hexagons[center].q;
+        *r = hexagons[center].r;
+    } else {
+        *q = (int)floorf(cam->x / 75.0f + 0.5f);
+        *r = (int)floorf(-cam->z / 86.6f - *q * 0.5f + 0.5f);
+    }
+}
+
+// Forward bearing (atan2 of the forward vector, -yaw) wrapped to [0, 2pi)
+// and divided into RENDER_YAW_BUCKETS sectors
+static int yaw_bucket(const camera_t* cam) {
+    float bearing = fmodf(-cam->yaw_rad, 2.0f * 3.14159f);
+    if(bearing < 0.0f) bearing += 2.0f * 3.14159f;
+    int bucket = (int)(bearing * (RENDER_YAW_BUCKETS / (2.0f * 3.14159f)));
+    return bucket < RENDER_YAW_BUCKETS ? bucket : RENDER_YAW_BUCKETS - 1;
+}
+
+// Yaw buckets in which a hexagon at (dx, dz) from the cell centre can pass
+// hexagon_visible for some camera within RENDER_CACHE_SLACK of that centre
+static uint16_t visible_buckets(float dx, float dz) {
+    float dist = sqrtf(dx*dx + dz*dz);
+    if(dist - RENDER_CACHE_SLACK > RENDER_CULL_DISTANCE) return 0;
+    if(dist < 50.0f + RENDER_CACHE_SLACK) return 0xFFFF;
+    
+    // Moving the camera within the slack turns the bearing to the hexagon by
+    // up to the spread, and shortens its view depth by up to the slack
+    const float sector = 2.0f * 3.14159f / RENDER_YAW_BUCKETS;
+    float bearing = atan2f(dx, dz);
+    float spread = asinf(RENDER_CACHE_SLACK / dist);
+    uint16_t mask = 0;
+    for(int b = 0; b < RENDER_YAW_BUCKETS; b++) {
+        float off = fabsf(remainderf(bearing - (b + 0.5f) * sector, 2.0f * 3.14159f));
+        float off_max = fminf(off + 0.5f * sector, 3.14159f);
+        int in_frustum = off - 0.5f * sector - spread < RENDER_FRUSTUM_HALF_ANGLE + 0.01f;
+        int before_fog = dist * cosf(off_max) - RENDER_CACHE_SLACK + 10.0f - RENDER_HEX_RADIUS <= RENDER_FOG_END + 1.0f;
+        if(in_frustum && before_fog) mask |= 1 << b;
+    }
+    return mask;
+}
+
+// Insert a candidate into a cache's layer starting at first, far to near
+// from the cell centre
+static void view_cache_insert(view_cache_t* cache, float* distance, int first, int h, uint16_t mask, float dist_sq) {
+    int j = cache->count++;
+    while(j > first && distance[j - 1] < dist_sq) {
+        cache->hex_index[j] = cache->hex_index[j - 1];
+        cache->bucket_mask[j] = cache->bucket_mask[j - 1];
+        distance[j] = distance[j - 1];
+        j--;
+    }
+    cache->hex_index[j] = h;
+    cache->bucket_mask[j] = mask;
+    distance[j] = dist_sq;
+}
+
+// Add a portal layer candidate unless it is on the cache's level, already
+// listed, outside the disk or invisible from the cell; returns whether added
+static int view_cache_add_portal(view_cache_t* cache, float* distance, int first, int h, float center_x, float center_z) {
+    const hexagon_t* hex = &hexagons[h];
+    if(cache->count == RENDER_VIEW_CANDIDATES || hexagon_on_level(hex, cache->level)) return 0;
+    for(int i = first; i < cache->count; i++) {
+        if(cache->hex_index[i] == h) return 0;
+    }
+    
+    int dq = hex->q - cache->q, dr = hex->r - cache->r;
+    if(abs(dq) + abs(dr) + abs(dq + dr) > 2 * RENDER_CANDIDATE_RADIUS) return 0;
+    float dx = hex->center_x - center_x;
+    float dz = hex->center_z - center_z;
+    uint16_t mask = visible_buckets(dx, dz);
+    if(!mask) return 0;
+    
+    view_cache_insert(cache, distance, first, h, mask, dx*dx + dz*dz);
+    return 1;
+}
+
+// Regather a view's cache around a cell on a level: the axial disk from the
+// lookup, less hexagons that no pose within the cell can see. The portal
+// layer is what the disk's ramps lead to on the levels above and below:
+// flooded through open edges from the far end of each ramp, staying on that
+// level and within the disk.
+static void view_cache_rebuild(view_cache_t* cache, int cell_q, int cell_r, int level) {
+    float center_x = 75.0f * cell_q;
+    float center_z = -86.6f * (cell_r + cell_q * 0.5f);
+    float distance[RENDER_VIEW_CANDIDATES];
+    int32_t ramps[RENDER_DISK_CELLS];
+    int ramp_count = 0;
+    
+    cache->q = cell_q;
+    cache->r = cell_r;
+    cache->level = level;
+    cache->count = 0;
+    for(int dq = -RENDER_CANDIDATE_RADIUS; dq <= RENDER_CANDIDATE_RADIUS; dq++) {
+        int r_min = dq < 0 ? -RENDER_CANDIDATE_RADIUS - dq : -RENDER_CANDIDATE_RADIUS;
+        int r_max = dq < 0 ? RENDER_CANDIDATE_RADIUS : RENDER_CANDIDATE_RADIUS - dq;
+        for(int dr = r_min; dr <= r_max; dr++) {
+            int h = hexagon_lookup(cell_q + dq, cell_r + dr, level);
+            if(h < 0 && level > 0) {
+                h = hexagon_lookup(cell_q + dq, cell_r + dr, level - 1);
+                if(h >= 0 && hexagons[h].ramp_dir == HEXAGON_FLAT) h = -1;
+            }
+            if(h < 0) continue;
+            if(hexagons[h].ramp_dir != HEXAGON_FLAT) ramps[ramp_count++] = h;
+            
+            float dx = hexagons[h].center_x - center_x;
+            float dz = hexagons[h].center_z - center_z;
+            uint16_t mask = visible_buckets(dx, dz);
+            if(!mask) continue;
+            
+            // Initial order: far to near from the cell centre
+            view_cache_insert(cache, distance, 0, h, mask, dx*dx + dz*dz);
+        }
+    }
+    
+    // Portal layer: gathered after the level's own hexagons (flooding from
+    // each far end breadth first), then moved in front of them
+    int own_count = cache->count;
+    int32_t queue[RENDER_VIEW_CANDIDATES];
+    for(int i = 0; i < ramp_count; i++) {
+        const hexagon_t* ramp = &hexagons[ramps[i]];
+        int up = ramp->level == level;
+        int far = hexagon_neighbor(ramps[i], up ? ramp->ramp_dir : (ramp->ramp_dir + 3) % 6);
+        int far_level = up ? level + 1 : level - 1;
+        if(far < 0 || hexagons[far].level != far_level) continue;
+        
+        int head = 0, tail = 0;
+        if(view_cache_add_portal(cache, distance, own_count, far, center_x, center_z)) queue[tail++] = far;
+        while(head < tail) {
+            int h = queue[head++];
+            const hexagon_t* hex = &hexagons[h];
+            for(int dir = 0; dir < 6; dir++) {
+                if(!(hex->connections & (1 << dir))) continue;
+                int next = hexagon_neighbor(h, dir);
+                if(next < 0 || hexagons[next].level != far_level ||
+                   !(hexagons[next].connections & (1 << ((dir + 3) % 6)))) continue;
+                if(view_cache_add_portal(cache, distance, own_count, next, center_x, center_z)) queue[tail++] = next;
+            }
+        }
+    }
+    
+    int32_t portal_index[RENDER_VIEW_CANDIDATES];
+    uint16_t portal_mask[RENDER_VIEW_CANDIDATES];
+    cache->portal_count = cache->count - own_count;
+    memcpy(portal_index, &cache->hex_index[own_count], cache->portal_count * sizeof(int32_t));
+    memcpy(portal_mask, &cache->bucket_mask[own_count], cache->portal_count * sizeof(uint16_t));
+    memmove(&cache->hex_index[cache->portal_count], cache->hex_index, own_count * sizeof(int32_t));
+    memmove(&cache->bucket_mask[cache->portal_count], cache->bucket_mask, own_count * sizeof(uint16_t));
+    memcpy(cache->hex_index, portal_index, cache->portal_count * sizeof(int32_t));
+    memcpy(cache->bucket_mask, portal_mask, cache->portal_count * sizeof(uint16_t));
+    
+}
+
+// Gathered entry for a cell on a level, or NULL
+static view_cache_t* view_cache_find(int q, int r, int level) {
+    for(int i = 0; i < view_cache_live_count; i++) {
+        const view_cache_t* cache = view_cache_live[i];
+        if(cache->q == q && cache->r == r && cache->level == level) return view_cache_live[i];
+    }
+    return NULL;
+}
+
+// Entry to gather another cell into: a free one, else the least recently
+// used (never one already picked for this frame, those are the most recent)
+static view_cache_t* view_cache_acquire(void) {
+    view_cache_t* cache = arena_pool_get(&view_cache_pool);
+    if(cache) {
+        view_cache_live[view_cache_live_count++] = cache;
+        return cache;
+    }
+    
+    cache = view_cache_live[0];
+    for(int i = 1; i < view_cache_live_count; i++) {
+        if(view_cache_live[i]->last_used < cache->last_used) cache = view_cache_live[i];
+    }
+    return cache;
+}
+
+// Per-frame world work for a set of views (call once per frame, before
+// render_build_lists for any of them): point each view at its camera
+// cell's cache, gathering the cell if it has none
+void render_prepare_views(camera_t* cams, int count) {
+    if(view_cache_version != render_world_version) {
+        render_invalidate_views();
+        view_cache_version = render_world_version;
+    }
+    
+    for(int v = 0; v < count; v++) {
+        int q, r;
+        int level = render_camera_level(&cams[v]);
+        camera_cell(&cams[v], level, &q, &r);
+        
+        render_cache_stats.lookups++;
+        view_cache_t* cache = view_cache_find(q, r, level);
+        if(!cache) {
+            render_cache_stats.rebuilds++;
+            cache = view_cache_acquire();
+            view_cache_rebuild(cache, q, r, level);
+        }
+        cache->last_used = ++view_cache_clock;
+        view_cache[v] = cache;
+    }
+}
+
+// Drop every cached cell (the next render_prepare_views regathers)
+void render_invalidate_views(void) {
+    for(int i = 0; i < view_cache_live_count; i++) {
+        arena_pool_put(&view_cache_pool, view_cache_live[i]);
+    }
+    view_cache_live_count = 0;
+}
+
+// Lists for one view, valid until the next arena_frame_reset
+render_lists_t* render_lists_alloc(void) {
+    render_lists_t* lists = arena_frame_alloc(ARENA_RENDER, sizeof(render_lists_t));
+    lists->walls = arena_frame_alloc(ARENA_RENDER, render_wall_capacity * sizeof(wall_segment_t));
+    lists->wall_capacity = render_wall_capacity;
+    lists->hex_count = 0;
+    lists->wall_count = 0;
+    return lists;
+}
+
+// Build the visible hexagon and wall lists for one camera, far to near
+// within each layer, from its view's cache as of the last
+// render_prepare_views()
+void render_build_lists(camera_t* cam, int view, render_lists_t* lists) {
+    view_cache_t* cache = view_cache[view];
+    float distance[RENDER_VIEW_CANDIDATES];
+    float hex_distance[RENDER_VIEW_CANDIDATES];
+    
+    // Re-sort each layer of the cached hexagons by squared distance (far to
+    // near). The kept order is last frame's, so this is about one compare
+    // per entry unless the camera jumped.
+    for(int i = 0; i < cache->count; i++) {
+        int h = cache->hex_index[i];
+        uint16_t mask = cache->bucket_mask[i];
+        float dx = hexagons[h].center_x - cam->x;
+        float dz = hexagons[h].center_z - cam->z;
+        float dist_sq = dx*dx + dz*dz;
+        int first = i < cache->portal_count ? 0 : cache->portal_count;
+        
+        int j = i;
+        while(j > first && distance[j - 1] < dist_sq) {
+            cache->hex_index[j] = cache->hex_index[j - 1];
+            cache->bucket_mask[j] = cache->bucket_mask[j - 1];
+            distance[j] = distance[j - 1];
+            j--;
+        }
+        cache->hex_index[j] = h;
+        cache->bucket_mask[j] = mask;
+        distance[j] = dist_sq;
+    }
+    
+    // Visible set: the exact tests only run on the current yaw bucket's
+    // hexagons, with the trigonometry done once
+    float fwd_x = sinf(-cam->yaw_rad), fwd_z = cosf(-cam->yaw_rad);
+    uint16_t bucket = 1 << yaw_bucket(cam);
+    
+    lists->hex_count = 0;
+    lists->portal_hex_count = 0;
+    for(int i = 0; i < cache->count; i++) {
+        if(i == cache->portal_count) lists->portal_hex_count = lists->hex_count;
+        if(!(cache->bucket_mask[i] & bucket)) continue;
+        
+        int h = cache->hex_index[i];
+        if(!hexagon_visible(&hexagons[h], cam, fwd_x, fwd_z, distance[i])) continue;
+        
+        hex_distance[lists->hex_count] = distance[i];
+        lists->hex_index[lists->hex_count++] = h;
+    }
+    if(cache->portal_count == cache->count) lists->portal_hex_count = lists->hex_count;
+    
+    // Walls of the visible hexagons, and each ramp's floor and ceiling as one
+    // more, nearest hexagons first (the camera level before the portal
+    // layer) so the segment cap drops the farthest walls, then reversed into
+    // painter's order
+    wall_segment_t* wall_segments = lists->walls;
+    int wall_count = 0;
+    int level_wall_count = 0;
+    
+    uint16_t stamp = advance_stamp(&wall_emit_call, wall_emit_stamp, sizeof(wall_emit_stamp));
+    float eye_x = cam->x - 10.0f * fwd_x;
+    float eye_z = cam->z - 10.0f * fwd_z;
+    
+    for(int i = lists->hex_count - 1; i >= 0 && wall_count < lists->wall_capacity; i--) {
+        int h = lists->hex_index[i];
+        hexagon_t* hex = &hexagons[h];
+        for(int wall_dir = 0; wall_dir < 6 && wall_count < lists->wall_capacity; wall_dir++) {
+            if(!(geometry_wall_mask[h] & (1 << wall_dir))) continue;
+            if(!render_wall_faces(hex, wall_dir, eye_x, eye_z)) continue;
+            // Edge drawn identically from both sides: keep the nearer copy
+            // (with culling, only the copy facing the eye is left anyway)
+            if(!render_backface_cull && (geometry_shared_walls[h] & (1 << wall_dir)) &&
+               wall_emit_stamp[hexagon_neighbor(h, wall_dir)] == stamp) continue;
+            
+            wall_segments[wall_count].distance = hex_distance[i];
+            wall_segments[wall_count].hex = hex;
+            wall_segments[wall_count].wall_dir = wall_dir;
+            wall_count++;
+        }
+        // Painter's order draws a ramp's surfaces before its walls
+        if(hex->ramp_dir != HEXAGON_FLAT && wall_count < lists->wall_capacity) {
+            wall_segments[wall_count].distance = hex_distance[i];
+            wall_segments[wall_count].hex = hex;
+            wall_segments[wall_count].wall_dir = RENDER_WALL_RAMP;
+            wall_count++;
+        }
+        wall_emit_stamp[h] = stamp;
+        if(i >= lists->portal_hex_count) level_wall_count = wall_count;
+    }
+    for(int i = 0, j = wall_count - 1; i < j; i++, j--) {
+        wall_segment_t temp = wall_segments[i];
+        wall_segments[i] = wall_segments[j];
+        wall_segments[j] = temp;
+    }
+    
+    lists->wall_count = wall_count;
+    lists->portal_wall_count = wall_count - level_wall_count;
+}
+
+// Split the target into 1, 2 (stacked) or 4 (quadrant) viewports. Focal
+// length scales with viewport width, so every view keeps the full-screen
+// horizontal field of view.
+void render_split_viewports(camera_t* cams, int count, int width, int height) {
+    for(int v = 0; v < count; v++) {
+        camera_t* cam = &cams[v];
+        if(count == 1) {
+            cam->vp_x = 0;
+            cam->vp_y = 0;
+            cam->vp_width = width;
+            cam->vp_height = height;
+        } else if(count == 2) {
+            cam->vp_x = 0;
+            cam->vp_y = v * (height / 2);
+            cam->vp_width = width;
+            cam->vp_height = height / 2;
+        } else {
+            cam->vp_x = (v % 2) * (width / 2);
+            cam->vp_y = (v / 2) * (height / 2);
+            cam->vp_width = width / 2;
+            cam->vp_height = height / 2;
+        }
+        cam->focal_length = RENDER_FOCAL_LENGTH * cam->vp_width / 320.0f;
+    }
+}
+
+// Merged floor/ceiling pieces: stamp of the pass that last drew each piece,
+// on the piece's anchor part
+static uint16_t floor_piece_stamp[GEOMETRY_PIECE_KINDS][MAP_HEX_COUNT];
+static uint16_t floor_piece_pass;
+
+// Draw a convex floor or ceiling polygon over corners with floor heights y
+// (a ceiling is HEXAGON_WALL_HEIGHT above). Merged pieces reach well behind
+// and beside the camera, where project_vertex_floor's near-plane and clamp
+// approximations would distort them, so the polygon is clipped in view space
+// (render_view_polygon) before projection
+static void render_floor_polygon(const float* x, const float* z, const float* y, const uint8_t* light, int count, int ceiling, camera_t* cam, rdpq_trifmt_t* trifmt) {
+    float sin_yaw = sinf(-cam->yaw_rad), cos_yaw = cosf(-cam->yaw_rad);
+    float rel_y = (ceiling ? HEXAGON_WALL_HEIGHT : 0.0f) - cam->y;
+    float s[RENDER_FLOOR_MAX_CORNERS], t[RENDER_FLOOR_MAX_CORNERS];
+    floor_texcoords(x, z, count, ceiling ? TEXTURE_CEILING : TEXTURE_FLOOR, s, t);
+    
+    // View space corners with their shade and texture coordinates
+    float poly[2][RENDER_FLOOR_MAX_CORNERS][CLIP_FLOATS];
+    for(int i = 0; i < count; i++) {
+        float rel_x = x[i] - cam->x, rel_z = z[i] - cam->z;
+        poly[0][i][CLIP_X] = rel_x * cos_yaw - rel_z * sin_yaw;
+        poly[0][i][CLIP_Y] = y[i] + rel_y;
+        poly[0][i][CLIP_DEPTH] = rel_x * sin_yaw + rel_z * cos_yaw + 10.0f;
+        poly[0][i][CLIP_SHADE] = light[i] * (1.0f / 255.0f);
+        poly[0][i][CLIP_S] = s[i];
+        poly[0][i][CLIP_T] = t[i];
+    }
+    
+    // Ceilings use reversed winding so their triangles face downward
+    render_view_polygon(poly, count, RENDER_FLOOR_NEAR, ceiling, cam, trifmt);
+}
+
+// Floor/ceiling pass entry: a merged piece, or a hexagon with no merged
+// parts drawn whole, with the mip level chosen for it
+typedef struct {
+    int32_t hex;                     // Hexagon, or -1 for a piece
+    uint32_t ref;                    // Piece reference
+    int level;
+} floor_item_t;
+
+static floor_item_t floor_items[GEOMETRY_PIECE_KINDS * RENDER_VIEW_CANDIDATES];
+
+// Mip level for a floor or ceiling polygon from its nearest view depth d: a
+// level-0 texel there covers texels_per_unit * d / focal pixels across and
+// is foreshortened by a further d / eye height along the view
+static int floor_level(const float* x, const float* z, int count, texture_id_t texture, float eye_height, camera_t* cam) {
+    float sin_yaw = sinf(-cam->yaw_rad), cos_yaw = cosf(-cam->yaw_rad);
+    float near = INFINITY;
+    for(int i = 0; i < count; i++) {
+        near = fminf(near, (x[i] - cam->x) * sin_yaw + (z[i] - cam->z) * cos_yaw + 10.0f);
+    }
+    near = fmaxf(near, RENDER_FLOOR_NEAR);
+    
+    const texture_info_t* info = &texture_info[texture];
+    float across = (info->width / info->span_s) * near / cam->focal_length;
+    return texture_level(across * fmaxf(1.0f, near / eye_height));
+}
+
+static void render_floor_item(const floor_item_t* item, int ceiling, camera_t* cam, rdpq_trifmt_t* trifmt) {
+    float y[RENDER_FLOOR_MAX_CORNERS];
+    if(item->hex >= 0) {
+        hexagon_t* hex = &hexagons[item->hex];
+        if(render_textures || render_zbuffer) {
+            // Textures and Z need the clipped polygon (the fans' near-plane
+            // approximation and clamping would bend them)
+            for(int i = 0; i < 6; i++) y[i] = hexagon_level_floor(hex->level);
+            render_floor_polygon(hex->vertices_x, hex->vertices_z, y, map_corner_light[item->hex], 6, ceiling, cam, trifmt);
+        } else if(ceiling) {
+            render_hexagon_ceiling(hex, cam, trifmt);
+        } else {
+            render_hexagon_floor_lod(hex, cam, trifmt, get_hexagon_lod_level(hex, cam));
+        }
+        return;
+    }
+    
+    float x[4], z[4];
+    uint8_t light[4];
+    int anchor = GEOMETRY_PIECE_ANCHOR(item->ref);
+    int corners = geometry_piece_corners(anchor, GEOMETRY_PIECE_KIND(item->ref),
+                                         GEOMETRY_PIECE_LENGTH(item->ref), x, z, light);
+    for(int i = 0; i < corners; i++) y[i] = hexagon_level_floor(hexagons[anchor].level);
+    render_floor_polygon(x, z, y, light, corners, ceiling, cam, trifmt);
+}
+
+// Floors or ceilings of the visible hexagons [first, end): merged pieces
+// once each, hexagons with no merged parts as before (fans, with floor LOD,
+// untextured). Ramps are drawn with the walls, and surfaces the eye is on
+// the back of (another level's) are skipped. Nothing in a pass overlaps, so
+// it is drawn grouped by mip level, levels already in TMEM first.
+static void render_floor_pass(render_lists_t* lists, int first, int end, camera_t* cam, rdpq_trifmt_t* trifmt, int ceiling) {
+    uint16_t stamp = advance_stamp(&floor_piece_pass, &floor_piece_stamp[0][0], sizeof(floor_piece_stamp));
+    texture_id_t texture = ceiling ? TEXTURE_CEILING : TEXTURE_FLOOR;
+    int level_items[TEXTURE_LEVELS] = { 0 };
+    int count = 0;
+    
+    for(int i = first; i < end; i++) {
+        int h = lists->hex_index[i];
+        hexagon_t* hex = &hexagons[h];
+        if(hex->ramp_dir != HEXAGON_FLAT) continue;
+        
+        float plane_y = hexagon_level_floor(hex->level) + (ceiling ? HEXAGON_WALL_HEIGHT : 0.0f);
+        if(ceiling ? cam->y >= plane_y : cam->y <= plane_y) continue;
+        float eye_height = fmaxf(fabsf(plane_y - cam->y), 1.0f);
+        
+        if(GEOMETRY_PIECE_LENGTH(geometry_floor_piece[GEOMETRY_PIECE_COLUMN][h]) == 1 &&
+           GEOMETRY_PIECE_LENGTH(geometry_floor_piece[GEOMETRY_PIECE_LEFT][h]) == 1 &&
+           GEOMETRY_PIECE_LENGTH(geometry_floor_piece[GEOMETRY_PIECE_RIGHT][h]) == 1) {
+            int level = render_textures ? floor_level(hex->vertices_x, hex->vertices_z, 6, texture, eye_height, cam) : 0;
+            floor_items[count++] = (floor_item_t){ h, 0, level };
+            level_items[level]++;
+            continue;
+        }
+        
+        for(int kind = 0; kind < GEOMETRY_PIECE_KINDS; kind++) {
+            uint32_t ref = geometry_floor_piece[kind][h];
+            int anchor = GEOMETRY_PIECE_ANCHOR(ref), anchor_kind = GEOMETRY_PIECE_KIND(ref);
+            uint16_t* piece = &floor_piece_stamp[anchor_kind][anchor];
+            if(*piece == stamp) continue;  // Already drawn from another hexagon
+            *piece = stamp;
+            
+            int level = 0;
+            if(render_textures) {
+                float x[4], z[4];
+                uint8_t light[4];
+                int corners = geometry_piece_corners(anchor, anchor_kind, GEOMETRY_PIECE_LENGTH(ref), x, z, light);
+                level = floor_level(x, z, corners, texture, eye_height, cam);
+            }
+            floor_items[count++] = (floor_item_t){ -1, ref, level };
+            level_items[level]++;
+        }
+    }
+    
+    rdpq_set_prim_color(render_material_color(ceiling ? RENDER_MATERIAL_CEILING : RENDER_MATERIAL_FLOOR));
+    for(int resident_pass = 1; resident_pass >= 0; resident_pass--) {
+        for(int level = 0; level < TEXTURE_LEVELS; level++) {
+            if(!level_items[level]) continue;
+            int resident = !render_textures || texture_resident(texture, level);
+            if(resident != resident_pass) continue;
+            
+            render_bind_texture(trifmt, texture, level);
+            for(int i = 0; i < count; i++) {
+                if(floor_items[i].level == level) render_floor_item(&floor_items[i], ceiling, cam, trifmt);
+            }
+        }
+    }
+}
+
+// A ramp's sloped floor and ceiling, sorted with the walls: the floor if the
+// eye is above its plane, the ceiling if below the ceiling's, each bound at
+// its own mip level (the caller rebinds the wall texture after)
+static void render_ramp_surfaces(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt) {
+    int h = hex - hexagons;
+    float eye_x, eye_z;
+    camera_eye(cam, &eye_x, &eye_z);
+    float plane_y = hexagon_floor_y(hex, eye_x, eye_z);
+    
+    float y[6];
+    for(int i = 0; i < 6; i++) y[i] = hexagon_corner_floor_y(hex, i);
+    
+    for(int ceiling = 0; ceiling < 2; ceiling++) {
+        float eye_height = cam->y - plane_y - (ceiling ? HEXAGON_WALL_HEIGHT : 0.0f);
+        if(ceiling ? eye_height >= 0.0f : eye_height <= 0.0f) continue;
+        
+        texture_id_t texture = ceiling ? TEXTURE_CEILING : TEXTURE_FLOOR;
+        int level = render_textures ? floor_level(hex->vertices_x, hex->vertices_z, 6, texture,
+                                                  fmaxf(fabsf(eye_height), 1.0f), cam) : 0;
+        render_bind_texture(trifmt, texture, level);
+        rdpq_set_prim_color(render_material_color(ceiling ? RENDER_MATERIAL_CEILING : RENDER_MATERIAL_FLOOR));
+        render_floor_polygon(hex->vertices_x, hex->vertices_z, y, map_corner_light[h], 6, ceiling, cam, trifmt);
+    }
+}
+
+// Wall being ordered by the wall pass: screen x extent and mip level
+typedef struct {
+    float min_x, max_x;
+    int8_t level;
+    uint8_t drawn;
+} wall_order_t;
+
+// Screen x extent of a wall side as project_vertex places its corners
+// (every part of it, doorway pieces included, lies within), and the mip
+// level for its projected size: the wall texture's width over its on-screen
+// width and its height over the nearer end's height, whichever is more
+// minified
+static void wall_extent(const wall_segment_t* wall, camera_t* cam, float sin_yaw, float cos_yaw, wall_order_t* order) {
+    const hexagon_t* hex = wall->hex;
+    const texture_info_t* info = &texture_info[TEXTURE_WALL];
+    float min_x = cam->vp_x - 200.0f, max_x = cam->vp_x + cam->vp_width + 200.0f;
+    float screen_x[2], depth[2];
+    
+    // A ramp's surfaces bind their own levels: kept in place, overlapping all
+    if(wall->wall_dir == RENDER_WALL_RAMP) {
+        *order = (wall_order_t){ min_x, max_x, -1, 0 };
+        return;
+    }
+    
+    for(int k = 0; k < 2; k++) {
+        int v = k ? wall->wall_dir : (wall->wall_dir + 5) % 6;
+        float rel_x = hex->vertices_x[v] - cam->x, rel_z = hex->vertices_z[v] - cam->z;
+        depth[k] = rel_x * sin_yaw + rel_z * cos_yaw + 10.0f;
+        if(depth[k] <= 0.001f) {
+            // Not drawn (project_vertex rejects it): no level, kept in place
+            *order = (wall_order_t){ min_x, max_x, -1, 0 };
+            return;
+        }
+        screen_x[k] = RENDER_CENTER_X(cam) + ((rel_x * cos_yaw - rel_z * sin_yaw) * cam->focal_length) / depth[k];
+    }
+    
+    float width = fmaxf(fabsf(screen_x[1] - screen_x[0]), 0.01f);
+    float height = cam->focal_length * HEXAGON_WALL_HEIGHT / fminf(depth[0], depth[1]);
+    order->level = texture_level(fmaxf(info->width / width, info->height / height));
+    order->min_x = fminf(fmaxf(fminf(screen_x[0], screen_x[1]), min_x), max_x);
+    order->max_x = fminf(fmaxf(fmaxf(screen_x[0], screen_x[1]), min_x), max_x);
+    order->drawn = 0;
+}
+
+// Two walls can be drawn in either order if no pixel column is shared
+// (with a pixel of margin)
+static int walls_overlap(const wall_order_t* a, const wall_order_t* b) {
+    return a->min_x <= b->max_x + 1.0f && b->min_x <= a->max_x + 1.0f;
+}
+
+// Depth-sorted walls [first, end). Textured, a wall at another mip level
+// than the one bound is held back while one of the next
+// RENDER_WALL_SORT_WINDOW walls is at the bound level and overlaps none of
+// the walls it would overtake, so painter's order is kept wherever walls
+// cover each other.
+static void render_wall_pass(render_lists_t* lists, int first_wall, int end, camera_t* cam, rdpq_trifmt_t* trifmt) {
+    wall_segment_t* walls = lists->walls + first_wall;
+    int count = end - first_wall;
+    if(!render_textures) {
+        for(int i = 0; i < count; i++) {
+            render_single_wall(walls[i].hex, walls[i].wall_dir, cam, trifmt);
+        }
+        return;
+    }
+    
+    float sin_yaw = sinf(-cam->yaw_rad), cos_yaw = cosf(-cam->yaw_rad);
+    wall_order_t* order = arena_frame_alloc(ARENA_RENDER, count * sizeof(wall_order_t));
+    for(int i = 0; i < count; i++) {
+        wall_extent(&walls[i], cam, sin_yaw, cos_yaw, &order[i]);
+    }
+    
+    int first = 0, level = -1;
+    for(int n = 0; n < count; n++) {
+        while(order[first].drawn) first++;
+        
+        int pick = first;
+        if(level >= 0 && order[first].level >= 0 && order[first].level != level) {
+            for(int j = first + 1; j < count && j < first + RENDER_WALL_SORT_WINDOW; j++) {
+                if(order[j].drawn || order[j].level != level) continue;
+                int k = first;
+                while(k < j && (order[k].drawn || !walls_overlap(&order[k], &order[j]))) k++;
+                if(k == j) {
+                    pick = j;
+                    break;
+                }
+            }
+        }
+        
+        order[pick].drawn = 1;
+        if(order[pick].level >= 0 && order[pick].level != level) {
+            level = order[pick].level;
+            render_bind_texture(trifmt, TEXTURE_WALL, level);
+        }
+        render_single_wall(walls[pick].hex, walls[pick].wall_dir, cam, trifmt);
+        if(walls[pick].wall_dir == RENDER_WALL_RAMP) level = -1;  // Bound a floor texture
+    }
+}
+
+// Z-buffered walls: near to far, so nearer walls reject the pixels of the
+// ones behind instead of being drawn over them. Textured, ramps (which bind
+// their own levels) go first, then the walls one mip level at a time;
+// levels rise with distance, so that order stays roughly near to far. Walls
+// with an end behind the eye are clipped rather than skipped here, and take
+// the finest level.
+static void render_wall_pass_zbuf(render_lists_t* lists, camera_t* cam, rdpq_trifmt_t* trifmt) {
+    int count = lists->wall_count;
+    if(!render_textures) {
+        for(int i = count - 1; i >= 0; i--) {
+            render_single_wall(lists->walls[i].hex, lists->walls[i].wall_dir, cam, trifmt);
+        }
+        return;
+    }
+    
+    float sin_yaw = sinf(-cam->yaw_rad), cos_yaw = cosf(-cam->yaw_rad);
+    wall_order_t* order = arena_frame_alloc(ARENA_RENDER, count * sizeof(wall_order_t));
+    int level_walls[TEXTURE_LEVELS] = { 0 };
+    for(int i = count - 1; i >= 0; i--) {
+        if(lists->walls[i].wall_dir == RENDER_WALL_RAMP) {
+            render_single_wall(lists->walls[i].hex, RENDER_WALL_RAMP, cam, trifmt);
+            order[i].level = -1;
+            continue;
+        }
+        wall_extent(&lists->walls[i], cam, sin_yaw, cos_yaw, &order[i]);
+        if(order[i].level < 0) order[i].level = 0;
+        level_walls[order[i].level]++;
+    }
+    
+    for(int level = 0; level < TEXTURE_LEVELS; level++) {
+        if(!level_walls[level]) continue;
+        render_bind_texture(trifmt, TEXTURE_WALL, level);
+        for(int i = count - 1; i >= 0; i--) {
+            if(order[i].level == level) render_single_wall(lists->walls[i].hex, lists->walls[i].wall_dir, cam, trifmt);
+        }
+    }
+}
+
+// Allocate the visibility cache pool and size the render queue by the
+// memory installed (call once, after arena_init)
+void render_init(void) {
+    if(view_cache_pool.base) return;
+    
+    int entries = arena_scaled(RENDER_VIEW_CACHES, RENDER_VIEW_CACHES_EXPANDED);
+    arena_pool_init(&view_cache_pool, ARENA_VISIBILITY, sizeof(view_cache_t), entries);
+    view_cache_live = arena_alloc(ARENA_VISIBILITY, entries * sizeof(view_cache_t*));
+    render_wall_capacity = arena_scaled(RENDER_WALL_CAPACITY, RENDER_WALL_CAPACITY_EXPANDED);
+    arena_static(ARENA_RENDER, sizeof(wall_emit_stamp) + sizeof(floor_piece_stamp) + sizeof(floor_items));
+}
+
+// Scissor to a rectangle of the target, keeping only render_field's lines
+static void render_set_scissor(int x0, int y0, int x1, int y1) {
+    if(render_field == RENDER_FIELD_NONE) {
+        rdpq_set_scissor(x0, y0, x1, y1);
+    } else {
+        interlace_set_scissor(x0, y0, x1, y1, render_field == RENDER_FIELD_ODD);
+    }
+}
+
+// Layers of a view's lists drawn by render_pass_views
+#define RENDER_LAYER_PORTAL 0        // The levels beyond the ramps
+#define RENDER_LAYER_LEVEL 1         // The camera's level
+#define RENDER_LAYER_ALL 2           // Both (Z-buffered)
+
+// Run one pass over every view, each under its viewport's scissor. Views
+// never overlap on screen, so running a pass across all of them before the
+// next one keeps painter's order within each view while the pass's texture
+// levels stay resident across views.
+static void render_pass_views(camera_t* cams, render_lists_t** lists, int count, render_pass_t pass, int layer,
+                              rdpq_trifmt_t* trifmt) {
+    render_current_pass = pass;
+    for(int v = 0; v < count; v++) {
+        camera_t* cam = &cams[v];
+        if(count > 1) {
+            render_set_scissor(cam->vp_x, cam->vp_y, cam->vp_x + cam->vp_width, cam->vp_y + cam->vp_height);
+        }
+        int first_hex = layer == RENDER_LAYER_LEVEL ? lists[v]->portal_hex_count : 0;
+        int end_hex = layer == RENDER_LAYER_PORTAL ? lists[v]->portal_hex_count : lists[v]->hex_count;
+        if(pass == RENDER_PASS_WALL && render_zbuffer) {
+            render_wall_pass_zbuf(lists[v], cam, trifmt);
+        } else if(pass == RENDER_PASS_WALL) {
+            int first_wall = layer == RENDER_LAYER_LEVEL ? lists[v]->portal_wall_count : 0;
+            int end_wall = layer == RENDER_LAYER_PORTAL ? lists[v]->portal_wall_count : lists[v]->wall_count;
+            render_wall_pass(lists[v], first_wall, end_wall, cam, trifmt);
+        } else {
+            render_floor_pass(lists[v], first_hex, end_hex, cam, trifmt, pass == RENDER_PASS_CEILING);
+        }
+    }
+}
+
+// Render several views (split-screen) into the attached surface: one clear
+// pass and one mode setup for all views, per-view cached culling and
+// sorting, then each pass across all views under their scissors. The
+// lists live in the frame arena, so the caller resets it once per frame.
+// With render_zbuffer the attached Z surface is cleared and tested, and
+// walls are drawn before floors and ceilings; with render_field only that
+// field's lines are cleared and drawn.
+void render_world_views(camera_t* cams, int count) {
+    render_prepare_views(cams, count);
+    
+    // Background is the fog colour, so geometry fades out instead of popping
+    color_t fog_color = render_fog_color();
+    
+    render_current_pass = RENDER_PASS_CLEAR;
+    int right = 0, bottom = 0;
+    for(int v = 0; v < count; v++) {
+        if(cams[v].vp_x + cams[v].vp_width > right) right = cams[v].vp_x + cams[v].vp_width;
+        if(cams[v].vp_y + cams[v].vp_height > bottom) bottom = cams[v].vp_y + cams[v].vp_height;
+    }
+    if(render_field != RENDER_FIELD_NONE) render_set_scissor(0, 0, right, bottom);
+    rdpq_set_mode_fill(fog_color);
+    for(int v = 0; v < count; v++) {
+        rdpq_fill_rectangle(cams[v].vp_x, cams[v].vp_y,
+                            cams[v].vp_x + cams[v].vp_width, cams[v].vp_y + cams[v].vp_height);
+    }
+    
+    // Material colour (textured: tinting the texel) lit by the baked shade,
+    // blended toward the fog colour by shade alpha
+    if(render_zbuffer) rdpq_clear_z(RENDER_ZBUF_CLEAR);
+    
+    texture_begin_frame();
+    rdpq_set_mode_standard();
+    if(render_textures) {
+        rdpq_mode_combiner(RENDER_COMBINER_TEXTURED);
+        rdpq_mode_filter(FILTER_BILINEAR);
+        rdpq_mode_persp(true);
+    } else {
+        rdpq_mode_combiner(RENDER_COMBINER_LIT);
+    }
+    rdpq_mode_fog(RDPQ_FOG_STANDARD);
+    rdpq_set_fog_color(fog_color);
+    rdpq_mode_zbuf(render_zbuffer, render_zbuffer);
+    
+    // Define triangle format for Gouraud shading with per-vertex fog
+    rdpq_trifmt_t trifmt = (rdpq_trifmt_t){
+        .pos_offset = RENDER_VTX_POS,
+        .shade_offset = RENDER_VTX_SHADE,  // Baked light in RGB, fog factor in alpha
+        .tex_offset = render_textures ? RENDER_VTX_TEX : -1,  // Perspective-correct S, T
+        .tex_tile = TILE0,   // Set by each texture bind
+        .z_offset = render_zbuffer ? RENDER_VTX_Z : -1
+    };
+    
+    render_lists_t* lists[RENDER_MAX_VIEWS];
+    for(int v = 0; v < count; v++) {
+        lists[v] = render_lists_alloc();
+        render_build_lists(&cams[v], v, lists[v]);
+    }
+    if(count == 1) {
+        render_set_scissor(cams[0].vp_x, cams[0].vp_y,
+                           cams[0].vp_x + cams[0].vp_width, cams[0].vp_y + cams[0].vp_height);
+    }
+    
+    if(render_zbuffer) {
+        // Walls first: they hide most of the floors and ceilings behind them
+        render_pass_views(cams, lists, count, RENDER_PASS_WALL, RENDER_LAYER_ALL, &trifmt);
+        render_pass_views(cams, lists, count, RENDER_PASS_FLOOR, RENDER_LAYER_ALL, &trifmt);
+        render_pass_views(cams, lists, count, RENDER_PASS_CEILING, RENDER_LAYER_ALL, &trifmt);
+    } else {
+        // Per layer, the other levels seen through the ramps first: ceilings
+        // (farthest geometry), then floors, both as merged room pieces, then
+        // walls in depth order
+        for(int layer = RENDER_LAYER_PORTAL; layer <= RENDER_LAYER_LEVEL; layer++) {
+            int empty = 1;
+            for(int v = 0; v < count; v++) {
+                if(layer == RENDER_LAYER_LEVEL || lists[v]->portal_hex_count) empty = 0;
+            }
+            if(empty) continue;
+            render_pass_views(cams, lists, count, RENDER_PASS_CEILING, layer, &trifmt);
+            render_pass_views(cams, lists, count, RENDER_PASS_FLOOR, layer, &trifmt);
+            render_pass_views(cams, lists, count, RENDER_PASS_WALL, layer, &trifmt);
+        }
+    }
+    
+    // Overlays drawn afterwards span all viewports (and both fields)
+    rdpq_set_scissor(0, 0, right, bottom);
+}
+
+// Render the whole world from one camera into the attached surface:
+// clear, then ceilings, floors and depth-sorted walls (painter's order,
+// unless render_zbuffer)
+void render_world(camera_t* cam) {
+    render_world_views(cam, 1);
+}
+
+// Compare two scene keys - equal keys produce identical frames
+int scene_key_equal(const scene_key_t* a, const scene_key_t* b) {
+    if(a->view_count != b->view_count) return 0;
+    for(int v = 0; v < a->view_count; v++) {
+        if(a->x[v] != b->x[v] || a->y[v] != b->y[v] || a->z[v] != b->z[v] || a->yaw_rad[v] != b->yaw_rad[v]) return 0;
+    }
+    return a->world_version == b->world_version &&
+           a->width == b->width && a->height == b->height && a->bitdepth == b->bitdepth &&
+           memcmp(a->overlay, b->overlay, sizeof(a->overlay)) == 0;
+}
@@ -4,47 +4,219 @@
 #include <libdragon.h>
 #include <rdpq_tri.h>
 #include "hexagon.h"
+#include "texture.h"
 #include "../generated/map_data.h"
 
-// External declarations
-extern hexagon_t hexagons[MAP_HEX_COUNT];
-
 // Camera parameters structure
 typedef struct {
     float x, y, z;           // Camera position
     float yaw_rad;           // Camera rotation in radians
     float focal_length;      // FOV focal length
+    int vp_x, vp_y;          // Viewport origin on the target (pixels)
+    int vp_width, vp_height; // Viewport size; projection is centred in it
 } camera_t;
 
+// Split-screen: up to four views per frame (see render_split_viewports)
+#define RENDER_MAX_VIEWS 4
+#define RENDER_FOCAL_LENGTH 277.0f   // 60 degree FOV across a 320-pixel-wide view
+#define RENDER_CENTER_X(cam) ((cam)->vp_x + (cam)->vp_width * 0.5f)
+#define RENDER_CENTER_Y(cam) ((cam)->vp_y + (cam)->vp_height * 0.5f)
+
 // Screen coordinates
 typedef struct {
     float x, y;
+    float depth;             // View depth (drives fog)
+    float shade;             // Baked light (0-1), scales the material colour
+    float s, t;              // Texture coordinates (level-0 texels)
     int valid;
 } screen_pos_t;
 
-// Wall segment for depth sorting
+// Distance fog: geometry fades to the palette dark colour between these view depths
+#define RENDER_FOG_START 90.0f
+#define RENDER_FOG_END 220.0f
+
+// Far plane derived from the fog end: a hexagon is culled once its nearest point
+// is past the fog end in depth, or radially past where the screen corners reach
+// that depth (|x| / depth <= 160 / 277)
+#define RENDER_HEX_RADIUS 50.0f
+#define RENDER_CULL_DISTANCE (1.16f * (RENDER_FOG_END + RENDER_HEX_RADIUS))
+#define RENDER_CULL_DIST_SQ (RENDER_CULL_DISTANCE * RENDER_CULL_DISTANCE)
+
+// Candidate hexagons per view: an axial disk covering the cull distance from
+// anywhere in the camera's hexagon (centres of hexagons n steps apart are at
+// least 75n units apart): ceil((RENDER_CULL_DISTANCE + RENDER_HEX_RADIUS) / 75)
+#define RENDER_CANDIDATE_RADIUS 5
+#define RENDER_DISK_CELLS (3 * RENDER_CANDIDATE_RADIUS * (RENDER_CANDIDATE_RADIUS + 1) + 1)
+
+// Levels: a view draws its camera's level (the hexagons on it, ramps
+// included) and, as a portal layer drawn first, the hexagons of the levels
+// next to it that are reachable within the disk through the ramps it can
+// see - one disk of each at most
+#define RENDER_VIEW_CANDIDATES (2 * RENDER_DISK_CELLS)
+
+// Temporal visibility cache (per cell and level, shared by the views): the
+// candidates that can be visible from anywhere within RENDER_CACHE_SLACK of
+// the camera cell's centre (the cell itself, or the rounding cell when off
+// the map), each tagged with the yaw buckets it can be visible in. Only
+// entering a cell (or level) with no cache entry regathers them; turning
+// selects another bucket bit. The most recently visited cells keep
+// their entries (more with the Expansion Pak), so walking back into one
+// is free as well.
+#define RENDER_VIEW_CACHES 8
+#define RENDER_VIEW_CACHES_EXPANDED 48
+#define RENDER_YAW_BUCKETS 16
+#define RENDER_CACHE_SLACK 60.0f
+#define RENDER_FRUSTUM_HALF_ANGLE 2.3462f    // acos(-0.7), see is_hexagon_in_frustum
+
+// Floor/ceiling projections are clamped this far outside the viewport
+// (pixels); merged floor pieces are clipped to it instead, and to a near
+// plane at this view depth (the floor and ceiling stay within 277 pixels of
+// the centre line there)
+#define RENDER_FLOOR_GUARD 500.0f
+#define RENDER_FLOOR_NEAR 10.0f
+#define RENDER_FLOOR_MAX_CORNERS 11  // A hexagon clipped by five planes
+
+// Z-buffer mode: vertex Z is affine in 1 / depth between these view depths
+// (so it is linear on screen and the RDP interpolates it exactly), clamped
+// to 0-1. Walls are clipped to the near plane and the guard band instead of
+// clamped, which would bend their depth; the near plane is the floors' (the
+// camera position), so nothing between the eye and the player is drawn.
+#define RENDER_ZBUF_NEAR RENDER_FLOOR_NEAR
+#define RENDER_ZBUF_FAR (RENDER_CULL_DISTANCE + RENDER_HEX_RADIUS)
+#define RENDER_ZBUF_CLEAR 0xFFFC     // Farthest Z (rdpq_clear_z)
+
+// Triangle vertex layout passed to rdpq_triangle (floats)
+#define RENDER_VTX_POS 0         // Screen x, y
+#define RENDER_VTX_SHADE 2       // RGBA shade: RGB = baked light, alpha = 1 - fog
+#define RENDER_VTX_TEX 6         // S, T (texels at the bound level), 1 / depth
+#define RENDER_VTX_Z 9           // Z (Z-buffer mode only)
+#define RENDER_VTX_FLOATS 10
+
+// Material colour (prim) times the Gouraud-interpolated baked light (shade);
+// the fog blender reads shade alpha directly
+#define RENDER_COMBINER_LIT RDPQ_COMBINER1((PRIM, 0, SHADE, 0), (0, 0, 0, PRIM))
+
+// Textured: the intensity texel tints the material colour, then the light
+// scales it (fog already runs the pipeline in two cycles)
+#define RENDER_COMBINER_TEXTURED RDPQ_COMBINER2((TEX0, 0, PRIM, 0), (0, 0, 0, PRIM), \
+                                                (COMBINED, 0, SHADE, 0), (0, 0, 0, COMBINED))
+
+// Walls may be drawn ahead of up to this many earlier walls in painter's
+// order to keep a texture level bound, if they overlap none of them on screen
+#define RENDER_WALL_SORT_WINDOW 16
+
+// Surface materials, tinted by the seed palette (see render_material_color)
+typedef enum {
+    RENDER_MATERIAL_FLOOR = 0,
+    RENDER_MATERIAL_CEILING,
+    RENDER_MATERIAL_WALL,
+    RENDER_MATERIAL_FRAME,
+    RENDER_MATERIAL_COUNT
+} render_material_t;
+
+// Wall segment for depth sorting; a ramp's sloped floor and ceiling are
+// sorted with the walls as one more side (RENDER_WALL_RAMP)
+#define RENDER_WALL_RAMP 6
 typedef struct {
     float distance;
     hexagon_t* hex;
     int wall_dir;
 } wall_segment_t;
 
+// Render queue: visible walls kept per view (the farthest are dropped past
+// it), sized by the memory installed; MAX_WALL_SEGMENTS bounds either size
+#define RENDER_WALL_CAPACITY 100
+#define RENDER_WALL_CAPACITY_EXPANDED 256
+#define MAX_WALL_SEGMENTS RENDER_WALL_CAPACITY_EXPANDED
+extern int render_wall_capacity;
+
+// Per-frame visible set in painter's order (shared by all render backends),
+// allocated from the frame arena by render_lists_alloc: the portal layer's
+// hexagons and walls come first, then the camera level's, each far to near
+typedef struct {
+    int hex_count;
+    int portal_hex_count;                     // Leading hexagons in the portal layer
+    int32_t hex_index[RENDER_VIEW_CANDIDATES];  // Visible hexagons
+    int wall_count;
+    int portal_wall_count;                    // Leading walls in the portal layer
+    int wall_capacity;
+    wall_segment_t* walls;                    // Visible walls
+} render_lists_t;
+
+// Scene-change tracking: everything that affects a rendered frame
+#define SCENE_OVERLAY_LINES 5
+typedef struct {
+    int view_count;                  // Split-screen views
+    float x[RENDER_MAX_VIEWS], y[RENDER_MAX_VIEWS], z[RENDER_MAX_VIEWS];  // Camera positions
+    float yaw_rad[RENDER_MAX_VIEWS];
+    uint32_t world_version;          // render_world_version when captured
+    int width, height, bitdepth;     // Display mode
+    char overlay[SCENE_OVERLAY_LINES][64];  // Debug text lines
+} scene_key_t;
+
+// Bump whenever map geometry or anything drawn in the world changes
+extern uint32_t render_world_version;
+
+// Visibility cache counters since boot
+typedef struct {
+    uint32_t lookups;                // Views prepared
+    uint32_t rebuilds;               // Of which regathered (camera changed cell)
+} render_cache_stats_t;
+extern render_cache_stats_t render_cache_stats;
+
+// Pass currently being submitted by render_world() (host tools attribute fill cost by it)
+typedef enum {
+    RENDER_PASS_CLEAR = 0,
+    RENDER_PASS_CEILING,
+    RENDER_PASS_FLOOR,
+    RENDER_PASS_WALL,
+    RENDER_PASS_COUNT
+} render_pass_t;
+extern render_pass_t render_current_pass;
+
+// Skip wall sides facing away from the camera (default on); sides listed in
+// geometry_two_sided_walls are always drawn
+extern int render_backface_cull;
+
+// Texture walls, floors and ceilings (default on; see texture.h)
+extern int render_textures;
+
+// Hidden surfaces by the RDP's Z-buffer instead of painter's order (default
+// off): walls go first, near to far and grouped by mip level, then floors
+// and ceilings. The caller attaches a Z surface the size of the target.
+extern int render_zbuffer;
+
+// Interlaced field drawn (default none): render_world_views writes only the
+// even or odd lines of the attached surface, projected at its full height,
+// and leaves the other field's lines for interlace_reconstruct
+#define RENDER_FIELD_NONE 0
+#define RENDER_FIELD_EVEN 1
+#define RENDER_FIELD_ODD 2
+extern int render_field;
+
 // Function prototypes
 screen_pos_t project_vertex(float world_x, float world_y, float world_z, camera_t* cam);
+color_t render_fog_color(void);
+color_t render_material_color(render_material_t material);
 void render_hexagon_floor(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt);
 void render_hexagon_ceiling(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt);
 void render_hexagon_pillars(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt);
 void render_hexagon_walls(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt);
 void render_single_wall(hexagon_t* hex, int wall_dir, camera_t* cam, rdpq_trifmt_t* trifmt);
-
-// Collision detection
-int check_collision(float new_x, float new_z, float player_radius);
-int check_collision_with_slide(float old_x, float old_z, float *new_x, float *new_z, float player_radius);
-float point_to_line_distance(float px, float pz, float x1, float z1, float x2, float z2);
-int check_doorframe_collision(hexagon_t* hex, int wall_dir, int v1_idx, int v2_idx, float new_x, float new_z, float player_radius);
+void render_init(void);
+render_lists_t* render_lists_alloc(void);
+void render_prepare_views(camera_t* cams, int count);
+void render_build_lists(camera_t* cam, int view, render_lists_t* lists);
+void render_invalidate_views(void);
+void render_split_viewports(camera_t* cams, int count, int width, int height);
+void render_world_views(camera_t* cams, int count);
+void render_world(camera_t* cam);
+int scene_key_equal(const scene_key_t* a, const scene_key_t* b);
+int render_camera_level(const camera_t* cam);
 
 // Performance optimizations
 int is_hexagon_in_frustum(hexagon_t* hex, camera_t* cam);
+int is_hexagon_beyond_fog(hexagon_t* hex, camera_t* cam);
 int should_render_hexagon(hexagon_t* hex, camera_t* cam);
 int get_hexagon_lod_level(hexagon_t* hex, camera_t* cam);
 void render_hexagon_floor_lod(hexagon_t* hex, camera_t* cam, rdpq_trifmt_t* trifmt, int lod_level);
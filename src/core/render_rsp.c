@@ -0,0 +1,364 @@
+#include "render_rsp.h"
+#include <math.h>
+#include <string.h>
+#include <GL/gl.h>
+#include <GL/gl_integration.h>
+#include "../generated/map_data.h"
+#include "arena.h"
+
+// World vertex as consumed by the GL vertex/color arrays
+typedef struct {
+    float pos[3];
+    uint8_t color[4];
+} rsp_vertex_t;
+
+// Per-hexagon vertex block layout (world space, built once)
+#define RSP_FLOOR 0                  // 6 floor corners (at the corner's floor height)
+#define RSP_CEILING 6                // 6 ceiling corners (HEXAGON_WALL_HEIGHT above)
+#define RSP_WALL_BOTTOM 12           // 6 wall corners at the floor
+#define RSP_WALL_TOP 18              // 6 wall corners at the ceiling
+#define RSP_BASE_VERTS 24
+#define RSP_DOOR_VERTS 12            // Per doorway edge: 4 wall + 8 doorframe vertices
+
+// Doorway geometry shared with the CPU path
+#define DOOR_GAP 0.33f
+#define DOOR_FRAME_THICKNESS 1.5f
+
+// Per-frame upload limits (the CPU path is used when a frame exceeds them)
+#define RSP_FRAME_MAX_VERTS 4096
+#define RSP_MAX_INDICES (MAX_WALL_SEGMENTS * 24)
+
+static rsp_vertex_t world_verts[MAP_HEX_COUNT * (RSP_BASE_VERTS + 6 * RSP_DOOR_VERTS)];
+static int32_t hex_block_start[MAP_HEX_COUNT];
+static uint8_t hex_block_size[MAP_HEX_COUNT];
+static int8_t hex_door_slot[MAP_HEX_COUNT][6];
+
+static rsp_vertex_t frame_verts[RSP_FRAME_MAX_VERTS];
+static int32_t hex_frame_base[MAP_HEX_COUNT];
+static uint16_t ceiling_indices[RSP_MAX_INDICES];
+static uint16_t floor_indices[RSP_MAX_INDICES];
+static uint16_t wall_indices[RSP_MAX_INDICES];
+
+// Vertex colour is the material colour times the baked light (0-255), as
+// the CPU path's prim * shade combiner
+static void set_vertex(rsp_vertex_t* v, float x, float y, float z, color_t material, int light) {
+    v->pos[0] = x; v->pos[1] = y; v->pos[2] = z;
+    v->color[0] = material.r * light / 255;
+    v->color[1] = material.g * light / 255;
+    v->color[2] = material.b * light / 255;
+    v->color[3] = 255;
+}
+
+// Build the static world vertex blocks for every hexagon
+void render_rsp_init(void) {
+    int next = 0;
+    color_t floor = render_material_color(RENDER_MATERIAL_FLOOR);
+    color_t ceiling = render_material_color(RENDER_MATERIAL_CEILING);
+    color_t wall = render_material_color(RENDER_MATERIAL_WALL);
+    color_t frame = render_material_color(RENDER_MATERIAL_FRAME);
+    
+    for(int h = 0; h < MAP_HEX_COUNT; h++) {
+        hexagon_t* hex = &hexagons[h];
+        rsp_vertex_t* block = &world_verts[next];
+        hex_block_start[h] = next;
+        
+        const uint8_t* light = map_corner_light[h];
+        for(int i = 0; i < 6; i++) {
+            float y = hexagon_corner_floor_y(hex, i), top = y + HEXAGON_WALL_HEIGHT;
+            set_vertex(&block[RSP_FLOOR + i], hex->vertices_x[i], y, hex->vertices_z[i], floor, light[i]);
+            set_vertex(&block[RSP_CEILING + i], hex->vertices_x[i], top, hex->vertices_z[i], ceiling, light[i]);
+            set_vertex(&block[RSP_WALL_BOTTOM + i], hex->vertices_x[i], y, hex->vertices_z[i], wall, light[i]);
+            set_vertex(&block[RSP_WALL_TOP + i], hex->vertices_x[i], top, hex->vertices_z[i], wall, light[i]);
+        }
+        
+        // Doorway edges: wall pieces either side of the gap plus doorframes
+        int size = RSP_BASE_VERTS;
+        for(int dir = 0; dir < 6; dir++) {
+            hex_door_slot[h][dir] = -1;
+            if(!(hex->connections & (1 << dir)) || hex->type != HEX_TYPE_CORRIDOR) continue;
+            
+            int v1 = (dir + 5) % 6, v2 = dir;
+            float wall_dx = hex->vertices_x[v2] - hex->vertices_x[v1];
+            float wall_dz = hex->vertices_z[v2] - hex->vertices_z[v1];
+            float wall_length = sqrtf(wall_dx * wall_dx + wall_dz * wall_dz);
+            float frame_dx = (wall_dx / wall_length) * DOOR_FRAME_THICKNESS;
+            float frame_dz = (wall_dz / wall_length) * DOOR_FRAME_THICKNESS;
+            float wall_portion = (1.0f - DOOR_GAP) / 2.0f;
+            float left_x = hex->vertices_x[v1] + wall_portion * wall_dx;
+            float left_z = hex->vertices_z[v1] + wall_portion * wall_dz;
+            float right_x = hex->vertices_x[v1] + (1.0f - wall_portion) * wall_dx;
+            float right_z = hex->vertices_z[v1] + (1.0f - wall_portion) * wall_dz;
+            
+            int left_light = light[v1] + wall_portion * (light[v2] - light[v1]);
+            int right_light = light[v1] + (1.0f - wall_portion) * (light[v2] - light[v1]);
+            
+            // Floor heights along the edge (a ramp's side edges slope)
+            float y1 = hexagon_corner_floor_y(hex, v1), y2 = hexagon_corner_floor_y(hex, v2);
+            float left_y = y1 + wall_portion * (y2 - y1);
+            float right_y = y1 + (1.0f - wall_portion) * (y2 - y1);
+            float frame_dy = (y2 - y1) * (DOOR_FRAME_THICKNESS / wall_length);
+            const float top = HEXAGON_WALL_HEIGHT;
+            
+            rsp_vertex_t* door = &block[size];
+            hex_door_slot[h][dir] = size;
+            set_vertex(&door[0], left_x, left_y, left_z, wall, left_light);
+            set_vertex(&door[1], left_x, left_y + top, left_z, wall, left_light);
+            set_vertex(&door[2], right_x, right_y, right_z, wall, right_light);
+            set_vertex(&door[3], right_x, right_y + top, right_z, wall, right_light);
+            set_vertex(&door[4], left_x, left_y, left_z, frame, 255);
+            set_vertex(&door[5], left_x + frame_dx, left_y + frame_dy, left_z + frame_dz, frame, 255);
+            set_vertex(&door[6], left_x, left_y + top, left_z, frame, 255);
+            set_vertex(&door[7], left_x + frame_dx, left_y + frame_dy + top, left_z + frame_dz, frame, 255);
+            set_vertex(&door[8], right_x, right_y, right_z, frame, 255);
+            set_vertex(&door[9], right_x - frame_dx, right_y - frame_dy, right_z - frame_dz, frame, 255);
+            set_vertex(&door[10], right_x, right_y + top, right_z, frame, 255);
+            set_vertex(&door[11], right_x - frame_dx, right_y - frame_dy + top, right_z - frame_dz, frame, 255);
+            size += RSP_DOOR_VERTS;
+        }
+        
+        hex_block_size[h] = size;
+        next += size;
+    }
+}
+
+// Camera as GL matrices reproducing project_vertex():
+// screen = centre + view * focal / (view_z + 10), with y up in world space
+static void load_camera_matrices(camera_t* cam) {
+    float c = cosf(-cam->yaw_rad);
+    float s = sinf(-cam->yaw_rad);
+    
+    // Eye space: x = view_x, y = rel_y, z = -(view_z + 10) (GL looks down -Z)
+    float modelview[16] = {
+        c,    0.0f, -s,   0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        -s,   0.0f, -c,   0.0f,
+        -(c * cam->x - s * cam->z),
+        -cam->y,
+        (s * cam->x + c * cam->z) - 10.0f,
+        1.0f
+    };
+    
+    // Perspective with the focal length in pixels of the camera's viewport
+    float near_z = 1.0f, far_z = 1000.0f;
+    float projection[16] = {
+        cam->focal_length / (cam->vp_width * 0.5f), 0.0f, 0.0f, 0.0f,
+        0.0f, cam->focal_length / (cam->vp_height * 0.5f), 0.0f, 0.0f,
+        0.0f, 0.0f, -(far_z + near_z) / (far_z - near_z), -1.0f,
+        0.0f, 0.0f, -2.0f * far_z * near_z / (far_z - near_z), 0.0f
+    };
+    
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(projection);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(modelview);
+}
+
+static int push_quad(uint16_t* indices, int count, int bl, int br, int tl, int tr) {
+    // Same split as the CPU path: (bl, br, tl) and (br, tr, tl)
+    indices[count++] = bl; indices[count++] = br; indices[count++] = tl;
+    indices[count++] = br; indices[count++] = tr; indices[count++] = tl;
+    return count;
+}
+
+// Render the world through the RSP: same visible lists and painter's order as
+// render_world(), but the CPU only uploads world vertices and builds indices
+void render_world_rsp(camera_t* cam) {
+    render_lists_t* lists = render_lists_alloc();
+    render_prepare_views(cam, 1);
+    render_build_lists(cam, 0, lists);
+    
+    // Upload this frame's world corners (visible hexagons only)
+    int vert_count = 0;
+    for(int i = 0; i < lists->hex_count; i++) {
+        int h = lists->hex_index[i];
+        if(vert_count + hex_block_size[h] > RSP_FRAME_MAX_VERTS) {
+            render_world(cam);  // Too much for one upload - use the CPU path
+            return;
+        }
+        memcpy(&frame_verts[vert_count], &world_verts[hex_block_start[h]], hex_block_size[h] * sizeof(rsp_vertex_t));
+        hex_frame_base[h] = vert_count;
+        vert_count += hex_block_size[h];
+    }
+    
+    // Ceilings (reversed winding) and floors with the CPU path's LOD fans,
+    // skipping ramps (drawn with the walls) and surfaces seen from behind;
+    // the portal layer's indices come first in each list
+    static const uint8_t lod_fans[3][12] = {
+        { 0, 1, 2,  0, 2, 3,  0, 3, 4,  0, 4, 5 },
+        { 0, 2, 4,  0, 1, 2,  0, 4, 5,  0, 0, 0 },
+        { 0, 2, 4,  0, 3, 4,  0, 0, 0,  0, 0, 0 }
+    };
+    static const uint8_t lod_tris[3] = { 4, 3, 2 };
+    int ceiling_count = 0, floor_count = 0;
+    int ceiling_split = 0, floor_split = 0;
+    
+    for(int i = 0; i < lists->hex_count; i++) {
+        if(i == lists->portal_hex_count) {
+            ceiling_split = ceiling_count;
+            floor_split = floor_count;
+        }
+        int h = lists->hex_index[i];
+        int base = hex_frame_base[h];
+        if(hexagons[h].ramp_dir != HEXAGON_FLAT) continue;
+        
+        float floor_y = hexagon_level_floor(hexagons[h].level);
+        if(cam->y < floor_y + HEXAGON_WALL_HEIGHT) {
+            for(int t = 1; t < 5; t++) {
+                ceiling_indices[ceiling_count++] = base + RSP_CEILING + t + 1;
+                ceiling_indices[ceiling_count++] = base + RSP_CEILING + t;
+                ceiling_indices[ceiling_count++] = base + RSP_CEILING;
+            }
+        }
+        
+        if(cam->y > floor_y) {
+            int lod = get_hexagon_lod_level(&hexagons[h], cam);
+            for(int t = 0; t < lod_tris[lod] * 3; t++) {
+                floor_indices[floor_count++] = base + RSP_FLOOR + lod_fans[lod][t];
+            }
+        }
+    }
+    if(lists->portal_hex_count == lists->hex_count) {
+        ceiling_split = ceiling_count;
+        floor_split = floor_count;
+    }
+    
+    // Walls in depth order (wall pieces and black doorframes interleaved),
+    // with each ramp's floor or ceiling fan in its place
+    int wall_count = 0, wall_split = 0;
+    for(int i = 0; i < lists->wall_count; i++) {
+        if(i == lists->portal_wall_count) wall_split = wall_count;
+        hexagon_t* hex = lists->walls[i].hex;
+        int h = hex - hexagons;
+        int dir = lists->walls[i].wall_dir;
+        int base = hex_frame_base[h];
+        int v1 = (dir + 5) % 6, v2 = dir;
+        
+        if(dir == RENDER_WALL_RAMP) {
+            float eye_x = cam->x - 10.0f * sinf(-cam->yaw_rad);
+            float eye_z = cam->z - 10.0f * cosf(-cam->yaw_rad);
+            float plane_y = hexagon_floor_y(hex, eye_x, eye_z);
+            for(int t = 1; t < 5 && cam->y > plane_y; t++) {
+                wall_indices[wall_count++] = base + RSP_FLOOR;
+                wall_indices[wall_count++] = base + RSP_FLOOR + t;
+                wall_indices[wall_count++] = base + RSP_FLOOR + t + 1;
+            }
+            for(int t = 1; t < 5 && cam->y < plane_y + HEXAGON_WALL_HEIGHT; t++) {
+                wall_indices[wall_count++] = base + RSP_CEILING + t + 1;
+                wall_indices[wall_count++] = base + RSP_CEILING + t;
+                wall_indices[wall_count++] = base + RSP_CEILING;
+            }
+            continue;
+        }
+        
+        if(hex_door_slot[h][dir] < 0) {
+            wall_count = push_quad(wall_indices, wall_count,
+                                   base + RSP_WALL_BOTTOM + v1, base + RSP_WALL_BOTTOM + v2,
+                                   base + RSP_WALL_TOP + v1, base + RSP_WALL_TOP + v2);
+            continue;
+        }
+        
+        int door = base + hex_door_slot[h][dir];
+        wall_count = push_quad(wall_indices, wall_count,
+                               base + RSP_WALL_BOTTOM + v1, door + 0, base + RSP_WALL_TOP + v1, door + 1);
+        wall_count = push_quad(wall_indices, wall_count,
+                               door + 2, base + RSP_WALL_BOTTOM + v2, door + 3, base + RSP_WALL_TOP + v2);
+        
+        // Doorframes are skipped beyond 200 units, as on the CPU path
+        float dx = hex->center_x - cam->x;
+        float dz = hex->center_z - cam->z;
+        if(dx*dx + dz*dz > 40000.0f) continue;
+        
+        wall_count = push_quad(wall_indices, wall_count, door + 4, door + 5, door + 6, door + 7);
+        wall_count = push_quad(wall_indices, wall_count, door + 8, door + 9, door + 10, door + 11);
+    }
+    if(lists->portal_wall_count == lists->wall_count) wall_split = wall_count;
+    
+    // Clear the viewport exactly like the CPU path, then hand the frame to the GL pipeline
+    color_t fog_color = render_fog_color();
+    rdpq_set_mode_fill(fog_color);
+    rdpq_fill_rectangle(cam->vp_x, cam->vp_y, cam->vp_x + cam->vp_width, cam->vp_y + cam->vp_height);
+    
+    gl_context_begin();
+    
+    // GL viewports are measured from the bottom of the target
+    const surface_t* target = rdpq_get_attached();
+    glViewport(cam->vp_x, target->height - cam->vp_y - cam->vp_height, cam->vp_width, cam->vp_height);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glShadeModel(GL_SMOOTH);        // Baked per-vertex light
+    
+    // Linear fog over eye depth, matching the CPU path's per-vertex fog
+    float fog_rgba[4] = { fog_color.r / 255.0f, fog_color.g / 255.0f, fog_color.b / 255.0f, 1.0f };
+    glEnable(GL_FOG);
+    glFogi(GL_FOG_MODE, GL_LINEAR);
+    glFogf(GL_FOG_START, RENDER_FOG_START);
+    glFogf(GL_FOG_END, RENDER_FOG_END);
+    glFogfv(GL_FOG_COLOR, fog_rgba);
+    load_camera_matrices(cam);
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(rsp_vertex_t), frame_verts[0].pos);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(rsp_vertex_t), frame_verts[0].color);
+    
+    // The portal layer (other levels seen through the ramps), then the
+    // camera's level
+    glDrawElements(GL_TRIANGLES, ceiling_split, GL_UNSIGNED_SHORT, ceiling_indices);
+    glDrawElements(GL_TRIANGLES, floor_split, GL_UNSIGNED_SHORT, floor_indices);
+    glDrawElements(GL_TRIANGLES, wall_split, GL_UNSIGNED_SHORT, wall_indices);
+    glDrawElements(GL_TRIANGLES, ceiling_count - ceiling_split, GL_UNSIGNED_SHORT, ceiling_indices + ceiling_split);
+    glDrawElements(GL_TRIANGLES, floor_count - floor_split, GL_UNSIGNED_SHORT, floor_indices + floor_split);
+    glDrawElements(GL_TRIANGLES, wall_count - wall_split, GL_UNSIGNED_SHORT, wall_indices + wall_split);
+    
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    gl_context_end();
+}
+
+// Render the same camera through both backends into offscreen surfaces,
+// compare the pixels and time each path (including RDP completion). The GL
+// path is untextured and painter-ordered, so the CPU path is too while
+// validating.
+void render_rsp_validate(camera_t* cam, int frames, render_rsp_report_t* report) {
+    surface_t cpu_surf = surface_alloc(FMT_RGBA16, 320, 240);
+    surface_t rsp_surf = surface_alloc(FMT_RGBA16, 320, 240);
+    int textures = render_textures, zbuffer = render_zbuffer;
+    render_textures = 0;
+    render_zbuffer = 0;
+    
+    uint32_t start = get_ticks();
+    for(int i = 0; i < frames; i++) {
+        arena_frame_reset();
+        rdpq_attach(&cpu_surf, NULL);
+        render_world(cam);
+        rdpq_detach_wait();
+    }
+    report->cpu_ticks = (get_ticks() - start) / frames;
+    render_textures = textures;
+    render_zbuffer = zbuffer;
+    
+    start = get_ticks();
+    for(int i = 0; i < frames; i++) {
+        arena_frame_reset();
+        rdpq_attach(&rsp_surf, NULL);
+        render_world_rsp(cam);
+        rdpq_detach_wait();
+    }
+    report->rsp_ticks = (get_ticks() - start) / frames;
+    
+    // Pixel comparison of the last frame from each path
+    report->mismatched_pixels = 0;
+    report->total_pixels = 320 * 240;
+    for(int y = 0; y < 240; y++) {
+        const uint16_t* cpu_row = (const uint16_t*)((const uint8_t*)cpu_surf.buffer + y * cpu_surf.stride);
+        const uint16_t* rsp_row = (const uint16_t*)((const uint8_t*)rsp_surf.buffer + y * rsp_surf.stride);
+        for(int x = 0; x < 320; x++) {
+            if(cpu_row[x] != rsp_row[x]) report->mismatched_pixels++;
+        }
+    }
+    
+    surface_free(&cpu_surf);
+    surface_free(&rsp_surf);
+}
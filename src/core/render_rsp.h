@@ -0,0 +1,28 @@
+#ifndef RENDER_RSP_H
+#define RENDER_RSP_H
+
+#include "render.h"
+
+// Optional RSP render backend (build with RSP_GL=1, needs libdragon's GL).
+// World corners are built once; each frame the visible ones are uploaded and
+// the RSP transforms, projects and emits them, so the CPU only builds indices.
+
+typedef enum {
+    RENDER_BACKEND_CPU = 0,
+    RENDER_BACKEND_RSP = 1
+} render_backend_t;
+
+// CPU vs RSP comparison over the same camera
+typedef struct {
+    int mismatched_pixels;
+    int total_pixels;
+    uint32_t cpu_ticks;          // Per frame, including RDP completion
+    uint32_t rsp_ticks;
+} render_rsp_report_t;
+
+// Function prototypes
+void render_rsp_init(void);
+void render_world_rsp(camera_t* cam);
+void render_rsp_validate(camera_t* cam, int frames, render_rsp_report_t* report);
+
+#endif // RENDER_RSP_H
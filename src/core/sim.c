@@ -0,0 +1,58 @@
+#include "sim.h"
+#include <math.h>
+#include "collision.h"
+
+// Per-tick movement tuning (previously applied once per rendered frame)
+#define SIM_MOVE_SPEED 1.25f
+#define SIM_YAW_DIVISOR 20  // Integer division: yaw turns in whole-degree steps
+#define SIM_STICK_DEADZONE 30
+#define SIM_PLAYER_RADIUS 3.0f
+
+// Advance the player by one fixed simulation tick
+void sim_tick(player_state_t* player, const sim_input_t* input) {
+    // Analog stick X controls yaw (left/right look)
+    if(input->stick_x > SIM_STICK_DEADZONE || input->stick_x < -SIM_STICK_DEADZONE) {
+        player->yaw_deg -= (float)(input->stick_x / SIM_YAW_DIVISOR);  // Right stick = clockwise
+        while(player->yaw_deg >= 360.0f) player->yaw_deg -= 360.0f;
+        while(player->yaw_deg < 0.0f) player->yaw_deg += 360.0f;
+    }
+    
+    // Analog stick Y controls forward/backward movement
+    if(input->stick_y > SIM_STICK_DEADZONE || input->stick_y < -SIM_STICK_DEADZONE) {
+        float yaw_rad = (player->yaw_deg * 3.14159f) / 180.0f;
+        
+        // Calculate proposed movement
+        float movement = (input->stick_y / 128.0f) * SIM_MOVE_SPEED;
+        float new_x = player->x + sinf(-yaw_rad) * movement;
+        float new_z = player->z + cosf(-yaw_rad) * movement;
+        
+        // Swept collision: resolves the full move, sliding along any walls hit
+        collision_move(player->x, player->z, &new_x, &new_z, SIM_PLAYER_RADIUS, player->level);
+        player->x = new_x;
+        player->z = new_z;
+        
+        // Follow the floor: ramps carry the player between levels
+        int hex = hexagon_at_position(new_x, new_z, player->level);
+        if(hex >= 0) {
+            player->floor_y = hexagon_floor_y(&hexagons[hex], new_x, new_z);
+            player->level = hexagon_level_at(&hexagons[hex], player->floor_y);
+        }
+    }
+}
+
+// Blend two simulation states for rendering (alpha in [0, 1])
+void sim_interpolate(const player_state_t* prev, const player_state_t* curr, float alpha, player_state_t* out) {
+    out->x = prev->x + (curr->x - prev->x) * alpha;
+    out->z = prev->z + (curr->z - prev->z) * alpha;
+    out->floor_y = prev->floor_y + (curr->floor_y - prev->floor_y) * alpha;
+    out->level = curr->level;
+    
+    // Take the short way around the 0/360 wrap
+    float yaw_delta = curr->yaw_deg - prev->yaw_deg;
+    if(yaw_delta > 180.0f) yaw_delta -= 360.0f;
+    if(yaw_delta < -180.0f) yaw_delta += 360.0f;
+    
+    out->yaw_deg = prev->yaw_deg + yaw_delta * alpha;
+    if(out->yaw_deg >= 360.0f) out->yaw_deg -= 360.0f;
+    if(out->yaw_deg < 0.0f) out->yaw_deg += 360.0f;
+}
@@ -0,0 +1,31 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+
+// Fixed simulation rate - matches the 30 FPS target so movement tuning
+// from the old per-frame loop carries over unchanged
+#define SIM_TICK_HZ 30
+#define SIM_TICK_TICKS (TICKS_PER_SECOND / SIM_TICK_HZ)
+
+// Upper bound on catch-up ticks per rendered frame (avoids spiral of death)
+#define SIM_MAX_TICKS_PER_FRAME 4
+
+// Player state advanced by the simulation
+typedef struct {
+    float x, z;              // World position
+    float yaw_deg;           // Horizontal rotation in degrees [0, 360)
+    float floor_y;           // Floor height under the player
+    int level;               // Level walked on (a ramp's upper half is the one above)
+} player_state_t;
+
+// Controller input sampled once per rendered frame
+typedef struct {
+    int stick_x, stick_y;
+} sim_input_t;
+
+// Function prototypes
+void sim_tick(player_state_t* player, const sim_input_t* input);
+void sim_interpolate(const player_state_t* prev, const player_state_t* curr, float alpha, player_state_t* out);
+
+#endif // SIM_H
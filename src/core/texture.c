@@ -0,0 +1,212 @@
+#include "texture.h"
+#include <string.h>
+#include <rdpq_tex.h>
+#include "arena.h"
+
+// Floors repeat every 50 units (grid lines every 25), ceilings every 25
+// (one panel with a light), walls once per edge
+const texture_info_t texture_info[TEXTURE_COUNT] = {
+    [TEXTURE_FLOOR] = { 64, 64, 50.0f, 50.0f },
+    [TEXTURE_CEILING] = { 32, 32, 25.0f, 25.0f },
+    [TEXTURE_WALL] = { 64, 32, 50.0f, 20.0f },
+};
+
+texture_stats_t texture_stats;
+
+// I4 texels of every level, packed two per byte (high nibble first); each
+// level starts 8-byte aligned for the RDP
+#define TEXTURE_POOL_BYTES 5120
+static uint8_t texture_pool[TEXTURE_POOL_BYTES] __attribute__((aligned(16)));
+static surface_t texture_levels[TEXTURE_COUNT][TEXTURE_LEVELS];
+
+// A level uploaded to TMEM, on the render tile of the same index
+typedef struct {
+    int8_t texture;                  // -1: free
+    int8_t level;
+    uint16_t tmem_addr;
+    uint16_t bytes;
+    uint32_t last_bind;
+} texture_slot_t;
+
+static texture_slot_t slots[TEXTURE_SLOTS];
+static uint32_t bind_clock;
+static int bound_slot = -1;
+
+// Level 0 patterns (8-bit intensity): bright lines on a mid-grey base
+static uint8_t pattern_texel(texture_id_t texture, int x, int y) {
+    switch(texture) {
+        case TEXTURE_FLOOR:
+            // Grid lines every 32 texels with a one-texel glow
+            if(x % 32 == 0 || y % 32 == 0) return 255;
+            if(x % 32 == 1 || x % 32 == 31 || y % 32 == 1 || y % 32 == 31) return 208;
+            return 176;
+        case TEXTURE_CEILING:
+            // Panel seams around a square light
+            if(x >= 12 && x < 20 && y >= 12 && y < 20) return 255;
+            if(x == 0 || y == 0) return 208;
+            return 150;
+        default:
+            // Top and bottom trims, an accent line and two panels per edge
+            if(y < 2 || y >= 30) return 255;
+            if(y == 22) return 224;
+            if(x % 32 == 0) return 208;
+            return 176;
+    }
+}
+
+// Generate every texture's levels into the pool: level 0 from its pattern,
+// each further level a 2x2 box filter of the previous one (8-bit scratch
+// from the frame arena, released by the first frame)
+void texture_init(void) {
+    uint8_t* texels[2];
+    texels[0] = arena_frame_alloc(ARENA_TEXTURE, 2 * 64 * 64);
+    texels[1] = texels[0] + 64 * 64;
+    int offset = 0;
+    arena_static(ARENA_TEXTURE, sizeof(texture_pool) + sizeof(texture_levels) + sizeof(slots));
+
+    for(int t = 0; t < TEXTURE_COUNT; t++) {
+        int width = texture_info[t].width, height = texture_info[t].height;
+        for(int y = 0; y < height; y++) {
+            for(int x = 0; x < width; x++) {
+                texels[0][y * width + x] = pattern_texel(t, x, y);
+            }
+        }
+
+        for(int level = 0; level < TEXTURE_LEVELS; level++) {
+            const uint8_t* src = texels[level & 1];
+            if(level > 0) {
+                const uint8_t* prev = texels[(level - 1) & 1];
+                uint8_t* dst = texels[level & 1];
+                for(int y = 0; y < height; y++) {
+                    for(int x = 0; x < width; x++) {
+                        const uint8_t* p = prev + (2 * y) * (2 * width) + 2 * x;
+                        dst[y * width + x] = (p[0] + p[1] + p[2 * width] + p[2 * width + 1] + 2) / 4;
+                    }
+                }
+            }
+
+            uint8_t* packed = texture_pool + offset;
+            for(int i = 0; i < width * height; i += 2) {
+                int hi = (src[i] * 15 + 127) / 255, lo = (src[i + 1] * 15 + 127) / 255;
+                packed[i / 2] = (uint8_t)((hi << 4) | lo);
+            }
+            texture_levels[t][level] = surface_make_linear(packed, FMT_I4, width, height);
+            offset += ((width * height / 2) + 7) & ~7;
+
+            width /= 2;
+            height /= 2;
+        }
+    }
+    assertf(offset <= TEXTURE_POOL_BYTES, "Texture pool too small: %d bytes", offset);
+
+    // The RDP reads texels from RDRAM, past the data cache
+    data_cache_hit_writeback(texture_pool, offset);
+    texture_invalidate();
+}
+
+// Reset the per-frame traffic counters (residency is kept)
+void texture_begin_frame(void) {
+    memset(&texture_stats, 0, sizeof(texture_stats));
+}
+
+// Forget every resident level (TMEM was overwritten)
+void texture_invalidate(void) {
+    for(int i = 0; i < TEXTURE_SLOTS; i++) {
+        slots[i].texture = -1;
+    }
+    bound_slot = -1;
+}
+
+// Mip level for a primitive whose level-0 texels each cover this many
+// pixels' worth of screen: the finest level with fewer than two texels per
+// pixel (or the coarsest)
+int texture_level(float texels_per_pixel) {
+    int level = 0;
+    while(level < TEXTURE_LEVELS - 1 && texels_per_pixel >= 2.0f) {
+        texels_per_pixel *= 0.5f;
+        level++;
+    }
+    return level;
+}
+
+static int find_slot(texture_id_t texture, int level) {
+    for(int i = 0; i < TEXTURE_SLOTS; i++) {
+        if(slots[i].texture == (int)texture && slots[i].level == level) return i;
+    }
+    return -1;
+}
+
+int texture_resident(texture_id_t texture, int level) {
+    return find_slot(texture, level) >= 0;
+}
+
+// TMEM footprint of an I4 level: rows padded to 8-byte TMEM words
+static int tmem_bytes(const surface_t* surface) {
+    return ((surface->width / 2 + 7) & ~7) * surface->height;
+}
+
+// Lowest TMEM address with a free range of the given size, or -1
+static int tmem_gap(int bytes) {
+    int cursor = 0;
+    for(;;) {
+        // Next resident range at or after the cursor
+        int next = -1;
+        for(int i = 0; i < TEXTURE_SLOTS; i++) {
+            if(slots[i].texture < 0 || slots[i].tmem_addr < cursor) continue;
+            if(next < 0 || slots[i].tmem_addr < slots[next].tmem_addr) next = i;
+        }
+        int end = next < 0 ? TEXTURE_TMEM_BYTES : slots[next].tmem_addr;
+        if(end - cursor >= bytes) return cursor;
+        if(next < 0) return -1;
+        cursor = slots[next].tmem_addr + slots[next].bytes;
+    }
+}
+
+static int free_slot(void) {
+    for(int i = 0; i < TEXTURE_SLOTS; i++) {
+        if(slots[i].texture < 0) return i;
+    }
+    return -1;
+}
+
+static void evict_lru(void) {
+    int lru = -1;
+    for(int i = 0; i < TEXTURE_SLOTS; i++) {
+        if(slots[i].texture < 0) continue;
+        if(lru < 0 || slots[i].last_bind < slots[lru].last_bind) lru = i;
+    }
+    slots[lru].texture = -1;
+    if(lru == bound_slot) bound_slot = -1;
+}
+
+// Make a level current for the following triangles and return the tile to
+// sample it through (pass as the trifmt's tex_tile). Resident levels cost
+// nothing; others are uploaded first.
+rdpq_tile_t texture_bind(texture_id_t texture, int level) {
+    int slot = find_slot(texture, level);
+    if(slot < 0) {
+        const surface_t* surface = &texture_levels[texture][level];
+        int bytes = tmem_bytes(surface);
+        int addr = 0;
+        while((slot = free_slot()) < 0 || (addr = tmem_gap(bytes)) < 0) {
+            evict_lru();
+        }
+
+        rdpq_texparms_t parms = {
+            .tmem_addr = addr,
+            .s.repeats = REPEAT_INFINITE,
+            .t.repeats = REPEAT_INFINITE,
+        };
+        rdpq_tex_upload(TILE0 + slot, surface, &parms);
+        slots[slot] = (texture_slot_t){ texture, level, addr, bytes, 0 };
+        texture_stats.upload_bytes += bytes;
+        texture_stats.uploads++;
+    }
+
+    if(slot != bound_slot) {
+        bound_slot = slot;
+        texture_stats.binds++;
+    }
+    slots[slot].last_bind = ++bind_clock;
+    return TILE0 + slot;
+}
@@ -0,0 +1,60 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <stdint.h>
+#include <libdragon.h>
+#include <rdpq.h>
+
+// Surface textures: 4-bit intensity (I4) patterns generated at startup with
+// box-filtered mip levels, tinted by the material colour and lit by the
+// baked shade in the combiner. Level 0 of each takes at most half of TMEM
+// (the floor's is exactly half), and all three level 0s fit together, so a
+// wall, floor and ceiling level can be resident at once.
+//
+// TMEM holds up to TEXTURE_SLOTS uploaded levels at once, each on its own
+// render tile; binding a resident level only selects its tile, a missing
+// one is loaded into the lowest free TMEM range that fits, evicting the
+// least recently bound levels until one does. Anything else that loads TMEM
+// (e.g. a texture blit) must call texture_invalidate.
+#define TEXTURE_LEVELS 4
+#define TEXTURE_TMEM_BYTES 4096
+#define TEXTURE_SLOTS 7                      // Render tiles TILE0-TILE6 (rdpq loads through TILE7)
+
+// Upload budget reported against: two full TMEM loads per frame
+#define TEXTURE_UPLOAD_BUDGET (2 * TEXTURE_TMEM_BYTES)
+
+typedef enum {
+    TEXTURE_FLOOR = 0,
+    TEXTURE_CEILING,
+    TEXTURE_WALL,
+    TEXTURE_COUNT
+} texture_id_t;
+
+// Level 0 size and the world area one repeat covers: walls map one repeat
+// to a whole edge (50 wide, 20 high); floors and ceilings repeat in world
+// space at 1.28 texels per unit
+typedef struct {
+    int width, height;               // Texels
+    float span_s, span_t;            // World units per repeat
+} texture_info_t;
+
+extern const texture_info_t texture_info[TEXTURE_COUNT];
+
+// TMEM traffic since the last texture_begin_frame
+typedef struct {
+    uint32_t upload_bytes;           // Bytes loaded into TMEM
+    uint32_t uploads;                // Levels loaded
+    uint32_t binds;                  // Level changes between draws (resident or loaded)
+} texture_stats_t;
+
+extern texture_stats_t texture_stats;
+
+// Function prototypes
+void texture_init(void);
+void texture_begin_frame(void);
+void texture_invalidate(void);
+int texture_level(float texels_per_pixel);
+int texture_resident(texture_id_t texture, int level);
+rdpq_tile_t texture_bind(texture_id_t texture, int level);
+
+#endif // TEXTURE_H
@@ -0,0 +1,141 @@
+/*
+ * ENCOM-64 host benchmark: batched entity collision
+ * Builds the core simulation sources natively and times entity_update_tick()
+ * against an unbatched tick of the same world as the entity count grows:
+ * each entity gathers and sweeps its own walls (as collision_move does,
+ * with the same wall response), then every pair of entities on a level is
+ * tested by brute force. Contact counts are printed for both, so the two
+ * can be seen to simulate the same thing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "hexagon.h"
+#include "map_loader.h"
+#include "collision.h"
+#include "entity.h"
+#include "arena.h"
+
+#define BENCH_TICKS 300
+
+hexagon_t hexagons[MAP_HEX_COUNT];
+
+static const int bench_counts[] = { 10, 50, 100, 250, 500, 1000 };
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float random_range(float lo, float hi) {
+    return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+}
+
+// Spawn entities near random hexagon centres with random velocities
+static void spawn_entities(int count) {
+    entity_init();
+    for(int i = 0; i < count; i++) {
+        const hexagon_t* hex = &hexagons[rand() % MAP_HEX_COUNT];
+        entity_spawn(ENTITY_PATROLLER,
+                     hex->center_x + random_range(-20.0f, 20.0f),
+                     hex->center_z + random_range(-20.0f, 20.0f), hex->level,
+                     random_range(-2.0f, 2.0f), random_range(-2.0f, 2.0f), 3.0f);
+    }
+}
+
+// Reference: no buckets. Every entity follows ramps and does its own
+// collision_move gather and sweep (keeping the contact for the wall
+// response), then all pairs on a level are tested.
+static void naive_update_tick(void) {
+    entity_stats = (entity_stats_t){0};
+    
+    for(int i = 0; i < entities.count; i++) {
+        int hex = hexagon_at_position(entities.pos_x[i], entities.pos_z[i], entities.level[i]);
+        if(hex >= 0) {
+            float floor_y = hexagon_floor_y(&hexagons[hex], entities.pos_x[i], entities.pos_z[i]);
+            entities.level[i] = (uint8_t)hexagon_level_at(&hexagons[hex], floor_y);
+        }
+        
+        float new_x = entities.pos_x[i] + entities.vel_x[i];
+        float new_z = entities.pos_z[i] + entities.vel_z[i];
+        float mid_x = 0.5f * (entities.pos_x[i] + new_x);
+        float mid_z = 0.5f * (entities.pos_z[i] + new_z);
+        float reach = 0.5f * hypotf(entities.vel_x[i], entities.vel_z[i]) + entities.radius[i] + COLLISION_SKIN;
+        collision_set_t walls;
+        if(hex >= 0 && 2.0f * reach < 43.0f) {
+            collision_gather_local(&walls, hex, mid_x, mid_z, reach);
+        } else {
+            collision_gather(&walls, mid_x, mid_z, reach, entities.level[i]);
+        }
+        
+        collision_hit_t hit;
+        if(collision_sweep(&walls, entities.pos_x[i], entities.pos_z[i], &new_x, &new_z, entities.radius[i], &hit)) {
+            entity_hit_wall(i, &hit);
+        }
+        entities.pos_x[i] = new_x;
+        entities.pos_z[i] = new_z;
+    }
+    
+    for(int i = 0; i < entities.count; i++) {
+        for(int j = i + 1; j < entities.count; j++) {
+            if(entities.level[i] == entities.level[j]) entity_collide_pair(i, j);
+        }
+    }
+    
+    entity_compact();
+}
+
+int main(void) {
+    arena_init();
+#ifdef MAP_BLOB_FILE
+    if(map_load("build/" MAP_BLOB_FILE, NULL) < 0) {
+        fprintf(stderr, "Cannot load map blob build/%s\n", MAP_BLOB_FILE);
+        return 1;
+    }
+#endif
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        hexagon_init(&hexagons[i], &map_hexagons[i]);
+    }
+    hexagon_build_lookup();
+    
+    printf("Map: %s (%d hexes), %d ticks per run\n", MAP_SEED, MAP_HEX_COUNT, BENCH_TICKS);
+    printf("%8s %14s %14s %8s %10s %10s %10s %12s %12s\n", "entities", "batched us/t", "naive us/t", "buckets",
+           "wall hits", "ent hits", "edge hits", "naive walls", "naive ents");
+    
+    for(unsigned c = 0; c < sizeof(bench_counts) / sizeof(bench_counts[0]); c++) {
+        int count = bench_counts[c];
+        
+        srand(1234);
+        spawn_entities(count);
+        long wall_contacts = 0, entity_contacts = 0, neighbor_contacts = 0, buckets = 0;
+        double start = now_seconds();
+        for(int t = 0; t < BENCH_TICKS; t++) {
+            entity_update_tick();
+            wall_contacts += entity_stats.wall_contacts;
+            entity_contacts += entity_stats.entity_contacts;
+            neighbor_contacts += entity_stats.neighbor_contacts;
+            buckets += entity_stats.buckets_used;
+        }
+        double batched = (now_seconds() - start) / BENCH_TICKS * 1e6;
+        
+        srand(1234);
+        spawn_entities(count);
+        long naive_walls = 0, naive_entities = 0;
+        start = now_seconds();
+        for(int t = 0; t < BENCH_TICKS; t++) {
+            naive_update_tick();
+            naive_walls += entity_stats.wall_contacts;
+            naive_entities += entity_stats.entity_contacts;
+        }
+        double naive = (now_seconds() - start) / BENCH_TICKS * 1e6;
+        
+        printf("%8d %14.2f %14.2f %8ld %10ld %10ld %10ld %12ld %12ld\n", count, batched, naive,
+               buckets / BENCH_TICKS, wall_contacts / BENCH_TICKS, entity_contacts / BENCH_TICKS,
+               neighbor_contacts / BENCH_TICKS, naive_walls / BENCH_TICKS, naive_entities / BENCH_TICKS);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,543 @@
+/*
+ * Frozen reference copies of the collision queries, for fuzz_collision.c:
+ * the brute-force map scans and the swept-circle solver of
+ * src/core/collision.c as they stood when the harness was added, renamed
+ * with a ref_ prefix. Do not optimise or fix these to follow a change to
+ * the live code - a difference is what the fuzzer is there to find. If a
+ * behaviour change is intended, update both in the same commit and say so.
+ *
+ * Since multi-level maps, the gather and move take a level: still a scan
+ * of the whole map, keeping the hexagons on that level (hexagon_on_level),
+ * where the live gather only scans the level's index range.
+ *
+ * The point tests (ref_check_collision and the wall slide built on it) are
+ * the only copies left: the game moves with collision_move, so they were
+ * removed from collision.c and serve as the old behaviour it is checked
+ * against.
+ */
+
+#include "collision_ref.h"
+#include <math.h>
+#include "../generated/map_data.h"
+
+// Doorway layout shared with rendering (1/3 gap in the center of the edge)
+#define DOOR_GAP 0.33f
+
+// Append one segment to a gathered set (silently drops overflow)
+static void ref_add_segment(ref_set_t* set, float x1, float z1, float x2, float z2) {
+    if(set->count >= REF_MAX_SEGMENTS) return;
+    ref_seg_t* seg = &set->segs[set->count++];
+    seg->x1 = x1; seg->z1 = z1;
+    seg->x2 = x2; seg->z2 = z2;
+}
+
+// Gather the blocking segments of a single hexagon
+static void ref_gather_hex(ref_set_t* set, const hexagon_t* hex) {
+    // Wall direction d spans vertices (d+5)%6 -> d and uses connection bit d
+    for(int wall_dir = 0; wall_dir < 6; wall_dir++) {
+        int v1 = (wall_dir + 5) % 6;
+        int v2 = wall_dir;
+        float x1 = hex->vertices_x[v1], z1 = hex->vertices_z[v1];
+        float x2 = hex->vertices_x[v2], z2 = hex->vertices_z[v2];
+        
+        if(!(hex->connections & (1 << wall_dir))) {
+            // No connection: full wall
+            ref_add_segment(set, x1, z1, x2, z2);
+        } else if(hex->type == HEX_TYPE_CORRIDOR) {
+            // Corridor connection: the two wall pieces either side of the doorway
+            float wall_portion = (1.0f - DOOR_GAP) / 2.0f;
+            float left_x = x1 + wall_portion * (x2 - x1);
+            float left_z = z1 + wall_portion * (z2 - z1);
+            float right_x = x1 + (1.0f - wall_portion) * (x2 - x1);
+            float right_z = z1 + (1.0f - wall_portion) * (z2 - z1);
+            ref_add_segment(set, x1, z1, left_x, left_z);
+            ref_add_segment(set, right_x, right_z, x2, z2);
+        }
+        // Room connection: no wall at all
+    }
+}
+
+// Gather every segment on a level that a circle within reach of (x, z)
+// could touch
+void ref_collision_gather(ref_set_t* set, float x, float z, float reach, int level) {
+    // Hexagon circumradius is 50 units
+    float max_dist = reach + 50.0f;
+    float max_dist_sq = max_dist * max_dist;
+    
+    set->count = 0;
+    for(int hex_i = 0; hex_i < MAP_HEX_COUNT; hex_i++) {
+        hexagon_t* hex = &hexagons[hex_i];
+        if(!hexagon_on_level(hex, level)) continue;
+        float dx = hex->center_x - x;
+        float dz = hex->center_z - z;
+        if(dx*dx + dz*dz > max_dist_sq) continue;
+        
+        ref_gather_hex(set, hex);
+    }
+}
+
+// Closest point on a segment to (px, pz)
+static void ref_closest_point(const ref_seg_t* seg, float px, float pz, float* cx, float* cz) {
+    float line_dx = seg->x2 - seg->x1;
+    float line_dz = seg->z2 - seg->z1;
+    float line_length_sq = line_dx * line_dx + line_dz * line_dz;
+    float t = 0.0f;
+    
+    if(line_length_sq > 0.001f) {
+        t = ((px - seg->x1) * line_dx + (pz - seg->z1) * line_dz) / line_length_sq;
+        if(t < 0.0f) t = 0.0f;
+        if(t > 1.0f) t = 1.0f;
+    }
+    
+    *cx = seg->x1 + t * line_dx;
+    *cz = seg->z1 + t * line_dz;
+}
+
+// Time of impact of a circle moving from (px, pz) by (dx, dz) against a round
+// endpoint - returns a value > 1 when there is no contact within the move
+static float ref_sweep_endpoint(float px, float pz, float dx, float dz, float ex, float ez, float radius) {
+    float rel_x = px - ex;
+    float rel_z = pz - ez;
+    float a = dx*dx + dz*dz;
+    float b = 2.0f * (rel_x * dx + rel_z * dz);
+    float c = rel_x*rel_x + rel_z*rel_z - radius*radius;
+    
+    if(a < 0.000001f || c < 0.0f || b >= 0.0f) return 2.0f;  // Static, overlapping or moving away
+    
+    float disc = b*b - 4.0f*a*c;
+    if(disc < 0.0f) return 2.0f;
+    
+    return (-b - sqrtf(disc)) / (2.0f * a);
+}
+
+// Time of impact of a moving circle against one segment (capsule test)
+static float ref_sweep_segment(const ref_seg_t* seg, float px, float pz, float dx, float dz, float radius, float* nx, float* nz) {
+    float best_t = 2.0f;
+    float edge_x = seg->x2 - seg->x1;
+    float edge_z = seg->z2 - seg->z1;
+    float edge_len = sqrtf(edge_x*edge_x + edge_z*edge_z);
+    
+    if(edge_len > 0.001f) {
+        // Flat side of the capsule: signed distance along the segment normal
+        float ux = edge_x / edge_len;
+        float uz = edge_z / edge_len;
+        float n_x = -uz;
+        float n_z = ux;
+        float side = (px - seg->x1) * n_x + (pz - seg->z1) * n_z;
+        float approach = dx * n_x + dz * n_z;
+        
+        if(side < 0.0f) {
+            side = -side; approach = -approach;
+            n_x = -n_x; n_z = -n_z;
+        }
+        
+        if(side >= radius && approach < -0.000001f) {
+            float t = (side - radius) / -approach;
+            float hit_x = px + dx * t;
+            float hit_z = pz + dz * t;
+            float along = (hit_x - seg->x1) * ux + (hit_z - seg->z1) * uz;
+            if(t <= 1.0f && along >= 0.0f && along <= edge_len) {
+                best_t = t;
+                *nx = n_x;
+                *nz = n_z;
+            }
+        }
+    }
+    
+    // Round caps at both endpoints (corners and doorway edges)
+    float ends_x[2] = { seg->x1, seg->x2 };
+    float ends_z[2] = { seg->z1, seg->z2 };
+    for(int i = 0; i < 2; i++) {
+        float t = ref_sweep_endpoint(px, pz, dx, dz, ends_x[i], ends_z[i], radius);
+        if(t >= 0.0f && t < best_t) {
+            best_t = t;
+            *nx = (px + dx * t - ends_x[i]) / radius;
+            *nz = (pz + dz * t - ends_z[i]) / radius;
+        }
+    }
+    
+    return best_t;
+}
+
+// Push a circle out of any segment it already overlaps
+static void ref_depenetrate(const ref_set_t* set, float* px, float* pz, float radius) {
+    for(int i = 0; i < set->count; i++) {
+        float cx, cz;
+        ref_closest_point(&set->segs[i], *px, *pz, &cx, &cz);
+        float dx = *px - cx;
+        float dz = *pz - cz;
+        float dist_sq = dx*dx + dz*dz;
+        
+        if(dist_sq < radius * radius && dist_sq > 0.000001f) {
+            float dist = sqrtf(dist_sq);
+            float push = radius + REF_SKIN - dist;
+            *px += (dx / dist) * push;
+            *pz += (dz / dist) * push;
+        }
+    }
+}
+
+// Move a circle against a pre-gathered set, sliding along walls it meets.
+// Returns the number of contacts; *new_x/*new_z receive the resolved position.
+int ref_collision_sweep(const ref_set_t* set, float old_x, float old_z, float *new_x, float *new_z, float radius, float* normal_x, float* normal_z) {
+    float px = old_x;
+    float pz = old_z;
+    float dx = *new_x - old_x;
+    float dz = *new_z - old_z;
+    int contacts = 0;
+    
+    ref_depenetrate(set, &px, &pz, radius);
+    
+    for(int iter = 0; iter < REF_MAX_ITERATIONS; iter++) {
+        if(dx*dx + dz*dz < 0.000001f) break;
+        
+        // Bounds of this sweep, used to reject far segments cheaply
+        float min_x = (dx < 0.0f ? px + dx : px) - radius;
+        float max_x = (dx < 0.0f ? px : px + dx) + radius;
+        float min_z = (dz < 0.0f ? pz + dz : pz) - radius;
+        float max_z = (dz < 0.0f ? pz : pz + dz) + radius;
+        
+        // Earliest time of impact across the gathered set
+        float toi = 2.0f;
+        float nx = 0.0f, nz = 0.0f;
+        for(int i = 0; i < set->count; i++) {
+            const ref_seg_t* seg = &set->segs[i];
+            if((seg->x1 < min_x && seg->x2 < min_x) || (seg->x1 > max_x && seg->x2 > max_x) ||
+               (seg->z1 < min_z && seg->z2 < min_z) || (seg->z1 > max_z && seg->z2 > max_z)) continue;
+            
+            float seg_nx = 0.0f, seg_nz = 0.0f;
+            float t = ref_sweep_segment(seg, px, pz, dx, dz, radius, &seg_nx, &seg_nz);
+            if(t < toi) {
+                toi = t;
+                nx = seg_nx;
+                nz = seg_nz;
+            }
+        }
+        
+        if(toi > 1.0f) {
+            // Free path for the rest of the move
+            px += dx;
+            pz += dz;
+            break;
+        }
+        
+        // Advance to the contact, keeping a small skin off the wall
+        px += dx * toi + nx * REF_SKIN;
+        pz += dz * toi + nz * REF_SKIN;
+        contacts++;
+        *normal_x = nx;
+        *normal_z = nz;
+        
+        // Slide: drop the remaining motion's component into the wall
+        float rem_x = dx * (1.0f - toi);
+        float rem_z = dz * (1.0f - toi);
+        float into = rem_x * nx + rem_z * nz;
+        if(into < 0.0f) {
+            rem_x -= nx * into;
+            rem_z -= nz * into;
+        }
+        dx = rem_x;
+        dz = rem_z;
+    }
+    
+    *new_x = px;
+    *new_z = pz;
+    return contacts;
+}
+
+// Swept move with sliding on a level, gathering by a scan of the whole map
+// (never the hexagon-neighbourhood shortcut)
+int ref_collision_move(float old_x, float old_z, float *new_x, float *new_z, float radius, int level) {
+    static ref_set_t set;
+    float dx = *new_x - old_x;
+    float dz = *new_z - old_z;
+    float half_move = 0.5f * sqrtf(dx*dx + dz*dz);
+    float reach = half_move + radius + REF_SKIN;
+    float normal_x = 0.0f, normal_z = 0.0f;
+    
+    ref_collision_gather(&set, old_x + 0.5f * dx, old_z + 0.5f * dz, reach, level);
+    return ref_collision_sweep(&set, old_x, old_z, new_x, new_z, radius, &normal_x, &normal_z);
+}
+
+// Check collision with walls - returns 1 if collision detected, 0 if safe
+int ref_check_collision(float new_x, float new_z, float player_radius) {
+    // Quick optimization: only check nearby hexagons for collision
+    // (collision radius + hex size + some margin)
+    float max_collision_dist_sq = (player_radius + 50.0f) * (player_radius + 50.0f);
+    
+    // Check against all hexagons and their walls
+    for(int hex_i = 0; hex_i < MAP_HEX_COUNT; hex_i++) {
+        hexagon_t* hex = &hexagons[hex_i];
+        
+        // Skip hexagons too far away for collision
+        float dx = hex->center_x - new_x;
+        float dz = hex->center_z - new_z;
+        if(dx*dx + dz*dz > max_collision_dist_sq) continue;
+        
+        // Check each wall direction for this hexagon
+        for(int wall_dir = 0; wall_dir < 6; wall_dir++) {
+            // Only check walls that actually exist (no connections)
+            int has_wall = 0;
+            switch(wall_dir) {
+                case 2: // North
+                    has_wall = !(hex->connections & CONN_NORTH);
+                    break;
+                case 5: // South  
+                    has_wall = !(hex->connections & CONN_SOUTH);
+                    break;
+                case 0: // Southeast
+                    has_wall = !(hex->connections & CONN_SOUTHEAST);
+                    break;
+                case 1: // Northeast
+                    has_wall = !(hex->connections & CONN_NORTHEAST);
+                    break;
+                case 3: // Northwest
+                    has_wall = !(hex->connections & CONN_NORTHWEST);
+                    break;
+                case 4: // Southwest
+                    has_wall = !(hex->connections & CONN_SOUTHWEST);
+                    break;
+            }
+            
+            // Check for doorway segments (corridors with connections)
+            int has_doorway = 0;
+            switch(wall_dir) {
+                case 2: has_doorway = (hex->connections & CONN_NORTH) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 5: has_doorway = (hex->connections & CONN_SOUTH) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 0: has_doorway = (hex->connections & CONN_SOUTHEAST) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 1: has_doorway = (hex->connections & CONN_NORTHEAST) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 3: has_doorway = (hex->connections & CONN_NORTHWEST) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 4: has_doorway = (hex->connections & CONN_SOUTHWEST) && (hex->type == HEX_TYPE_CORRIDOR); break;
+            }
+            
+            if(has_wall || has_doorway) {
+                // Get wall endpoints based on direction
+                int start_vert, end_vert;
+                switch(wall_dir) {
+                    case 2: start_vert = 1; end_vert = 2; break; // North
+                    case 5: start_vert = 4; end_vert = 5; break; // South
+                    case 0: start_vert = 5; end_vert = 0; break; // Southeast
+                    case 1: start_vert = 0; end_vert = 1; break; // Northeast
+                    case 3: start_vert = 2; end_vert = 3; break; // Northwest
+                    case 4: start_vert = 3; end_vert = 4; break; // Southwest
+                }
+                
+                if(has_wall) {
+                    // Full wall collision
+                    float wall_x1 = hex->vertices_x[start_vert];
+                    float wall_z1 = hex->vertices_z[start_vert];
+                    float wall_x2 = hex->vertices_x[end_vert];
+                    float wall_z2 = hex->vertices_z[end_vert];
+                    
+                    if(ref_point_to_line_distance(new_x, new_z, wall_x1, wall_z1, wall_x2, wall_z2) < player_radius) {
+                        return 1; // Collision detected
+                    }
+                } else if(has_doorway) {
+                    // Doorway collision - check doorframe segments only
+                    if(ref_check_doorframe_collision(hex, wall_dir, start_vert, end_vert, new_x, new_z, player_radius)) {
+                        return 1; // Doorframe collision detected
+                    }
+                }
+            }
+        }
+    }
+    
+    return 0; // No collision
+}
+
+// Advanced collision with wall sliding
+int ref_check_collision_with_slide(float old_x, float old_z, float *new_x, float *new_z, float player_radius) {
+    // If no collision at target position, allow movement
+    if(!ref_check_collision(*new_x, *new_z, player_radius)) {
+        return 0; // No collision, movement allowed
+    }
+    
+    // Find the closest wall that's blocking us
+    float closest_dist = 1000000.0f;
+    float wall_x1, wall_z1, wall_x2, wall_z2;
+    int found_wall = 0;
+    
+    float max_collision_dist_sq = (player_radius + 50.0f) * (player_radius + 50.0f);
+    
+    for(int hex_i = 0; hex_i < MAP_HEX_COUNT; hex_i++) {
+        hexagon_t* hex = &hexagons[hex_i];
+        
+        // Skip hexagons too far away
+        float dx = hex->center_x - *new_x;
+        float dz = hex->center_z - *new_z;
+        if(dx*dx + dz*dz > max_collision_dist_sq) continue;
+        
+        for(int wall_dir = 0; wall_dir < 6; wall_dir++) {
+            // Check if this wall exists and is blocking
+            int has_wall = 0;
+            int has_doorway = 0;
+            
+            switch(wall_dir) {
+                case 2: has_wall = !(hex->connections & CONN_NORTH); has_doorway = (hex->connections & CONN_NORTH) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 5: has_wall = !(hex->connections & CONN_SOUTH); has_doorway = (hex->connections & CONN_SOUTH) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 0: has_wall = !(hex->connections & CONN_SOUTHEAST); has_doorway = (hex->connections & CONN_SOUTHEAST) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 1: has_wall = !(hex->connections & CONN_NORTHEAST); has_doorway = (hex->connections & CONN_NORTHEAST) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 3: has_wall = !(hex->connections & CONN_NORTHWEST); has_doorway = (hex->connections & CONN_NORTHWEST) && (hex->type == HEX_TYPE_CORRIDOR); break;
+                case 4: has_wall = !(hex->connections & CONN_SOUTHWEST); has_doorway = (hex->connections & CONN_SOUTHWEST) && (hex->type == HEX_TYPE_CORRIDOR); break;
+            }
+            
+            if(has_wall || has_doorway) {
+                int start_vert, end_vert;
+                switch(wall_dir) {
+                    case 2: start_vert = 1; end_vert = 2; break;
+                    case 5: start_vert = 4; end_vert = 5; break;
+                    case 0: start_vert = 5; end_vert = 0; break;
+                    case 1: start_vert = 0; end_vert = 1; break;
+                    case 3: start_vert = 2; end_vert = 3; break;
+                    case 4: start_vert = 3; end_vert = 4; break;
+                }
+                
+                float w_x1 = hex->vertices_x[start_vert];
+                float w_z1 = hex->vertices_z[start_vert];
+                float w_x2 = hex->vertices_x[end_vert];
+                float w_z2 = hex->vertices_z[end_vert];
+                
+                // For doorways, check wall segments but NOT doorframes
+                if(has_doorway) {
+                    // Check left wall segment (first 33% - the actual wall)
+                    float door_gap = 0.33f;
+                    float wall_portion = (1.0f - door_gap) / 2.0f;
+                    float left_end_x = w_x1 + wall_portion * (w_x2 - w_x1);
+                    float left_end_z = w_z1 + wall_portion * (w_z2 - w_z1);
+                    
+                    float dist = ref_point_to_line_distance(*new_x, *new_z, w_x1, w_z1, left_end_x, left_end_z);
+                    if(dist < player_radius && dist < closest_dist) {
+                        closest_dist = dist;
+                        wall_x1 = w_x1; wall_z1 = w_z1; wall_x2 = left_end_x; wall_z2 = left_end_z;
+                        found_wall = 1;
+                    }
+                    
+                    // Check right wall segment (last 33% - the actual wall)
+                    float right_wall_start = 1.0f - wall_portion;
+                    float right_start_x = w_x1 + right_wall_start * (w_x2 - w_x1);
+                    float right_start_z = w_z1 + right_wall_start * (w_z2 - w_z1);
+                    
+                    dist = ref_point_to_line_distance(*new_x, *new_z, right_start_x, right_start_z, w_x2, w_z2);
+                    if(dist < player_radius && dist < closest_dist) {
+                        closest_dist = dist;
+                        wall_x1 = right_start_x; wall_z1 = right_start_z; wall_x2 = w_x2; wall_z2 = w_z2;
+                        found_wall = 1;
+                    }
+                    
+                    // Skip the middle doorframe section - no collision there
+                } else if(has_wall) {
+                    // Check full wall for solid walls
+                    float dist = ref_point_to_line_distance(*new_x, *new_z, w_x1, w_z1, w_x2, w_z2);
+                    if(dist < player_radius && dist < closest_dist) {
+                        closest_dist = dist;
+                        wall_x1 = w_x1; wall_z1 = w_z1; wall_x2 = w_x2; wall_z2 = w_z2;
+                        found_wall = 1;
+                    }
+                }
+            }
+        }
+    }
+    
+    if(!found_wall) {
+        return 1; // Collision but no clear wall found, stop movement
+    }
+    
+    // Calculate wall direction vector
+    float wall_dx = wall_x2 - wall_x1;
+    float wall_dz = wall_z2 - wall_z1;
+    float wall_len = sqrtf(wall_dx*wall_dx + wall_dz*wall_dz);
+    
+    if(wall_len < 0.001f) {
+        return 1; // Degenerate wall, stop movement
+    }
+    
+    // Normalize wall direction
+    wall_dx /= wall_len;
+    wall_dz /= wall_len;
+    
+    // Movement vector
+    float move_dx = *new_x - old_x;
+    float move_dz = *new_z - old_z;
+    
+    // Project movement onto wall direction (slide component)
+    float slide_amount = move_dx * wall_dx + move_dz * wall_dz;
+    
+    // Calculate slide position
+    float slide_x = old_x + wall_dx * slide_amount;
+    float slide_z = old_z + wall_dz * slide_amount;
+    
+    // Check if slide position is valid
+    if(!ref_check_collision(slide_x, slide_z, player_radius)) {
+        *new_x = slide_x;
+        *new_z = slide_z;
+        return 0; // Sliding movement allowed
+    }
+    
+    return 1; // Can't slide, stop movement
+}
+
+// Helper function: distance from point to line segment
+float ref_point_to_line_distance(float px, float pz, float x1, float z1, float x2, float z2) {
+    // Vector from line start to end
+    float line_dx = x2 - x1;
+    float line_dz = z2 - z1;
+    
+    // Vector from line start to point
+    float point_dx = px - x1;
+    float point_dz = pz - z1;
+    
+    // Project point onto line
+    float line_length_sq = line_dx * line_dx + line_dz * line_dz;
+    
+    if(line_length_sq < 0.001f) {
+        // Line is actually a point, return distance to that point
+        return sqrtf(point_dx * point_dx + point_dz * point_dz);
+    }
+    
+    float t = (point_dx * line_dx + point_dz * line_dz) / line_length_sq;
+    
+    // Clamp t to [0,1] to stay on line segment
+    if(t < 0.0f) t = 0.0f;
+    if(t > 1.0f) t = 1.0f;
+    
+    // Find closest point on line segment
+    float closest_x = x1 + t * line_dx;
+    float closest_z = z1 + t * line_dz;
+    
+    // Return distance from point to closest point on line
+    float dist_x = px - closest_x;
+    float dist_z = pz - closest_z;
+    return sqrtf(dist_x * dist_x + dist_z * dist_z);
+}
+
+// Check collision with doorframe segments
+int ref_check_doorframe_collision(const hexagon_t* hex, int wall_dir, int v1_idx, int v2_idx, float new_x, float new_z, float player_radius) {
+    // Calculate doorway dimensions (same as rendering logic)
+    float door_gap = 0.33f;
+    float wall_portion = (1.0f - door_gap) / 2.0f;
+    
+    // Left wall segment endpoints
+    float left_end_world_x = hex->vertices_x[v1_idx] + wall_portion * (hex->vertices_x[v2_idx] - hex->vertices_x[v1_idx]);
+    float left_end_world_z = hex->vertices_z[v1_idx] + wall_portion * (hex->vertices_z[v2_idx] - hex->vertices_z[v1_idx]);
+    
+    // Right wall segment endpoints  
+    float right_wall_start = 1.0f - wall_portion;
+    float right_start_world_x = hex->vertices_x[v1_idx] + right_wall_start * (hex->vertices_x[v2_idx] - hex->vertices_x[v1_idx]);
+    float right_start_world_z = hex->vertices_z[v1_idx] + right_wall_start * (hex->vertices_z[v2_idx] - hex->vertices_z[v1_idx]);
+    
+    // Check collision with left wall segment
+    if(ref_point_to_line_distance(new_x, new_z, hex->vertices_x[v1_idx], hex->vertices_z[v1_idx], 
+                             left_end_world_x, left_end_world_z) < player_radius) {
+        return 1;
+    }
+    
+    // Check collision with right wall segment
+    if(ref_point_to_line_distance(new_x, new_z, right_start_world_x, right_start_world_z,
+                             hex->vertices_x[v2_idx], hex->vertices_z[v2_idx]) < player_radius) {
+        return 1;
+    }
+    
+    // Skip doorframe collision - only check wall segments, not the frame pieces
+    
+    return 0; // No doorframe collision
+}
@@ -0,0 +1,32 @@
+#ifndef COLLISION_REF_H
+#define COLLISION_REF_H
+
+#include "hexagon.h"
+
+// Frozen reference copies of the collision queries (see collision_ref.c),
+// checked against the live ones in src/core/collision.c by fuzz_collision.c.
+// Own types and constants, so changes to collision.h cannot move them.
+#define REF_MAX_SEGMENTS 1024         // Brute-force gather has no practical cap
+#define REF_MAX_ITERATIONS 4
+#define REF_SKIN 0.01f
+
+typedef struct {
+    float x1, z1;
+    float x2, z2;
+} ref_seg_t;
+
+typedef struct {
+    ref_seg_t segs[REF_MAX_SEGMENTS];
+    int count;
+} ref_set_t;
+
+// Function prototypes
+float ref_point_to_line_distance(float px, float pz, float x1, float z1, float x2, float z2);
+int ref_check_doorframe_collision(const hexagon_t* hex, int wall_dir, int v1_idx, int v2_idx, float new_x, float new_z, float player_radius);
+int ref_check_collision(float new_x, float new_z, float player_radius);
+int ref_check_collision_with_slide(float old_x, float old_z, float *new_x, float *new_z, float player_radius);
+void ref_collision_gather(ref_set_t* set, float x, float z, float reach, int level);
+int ref_collision_sweep(const ref_set_t* set, float old_x, float old_z, float *new_x, float *new_z, float radius, float* normal_x, float* normal_z);
+int ref_collision_move(float old_x, float old_z, float *new_x, float *new_z, float radius, int level);
+
+#endif // COLLISION_REF_H
@@ -0,0 +1,396 @@
+/*
+ * ENCOM-64 host collision fuzzer
+ * Differential test of the live collision queries (src/core/collision.c)
+ * against frozen brute-force copies (collision_ref.c) on the compiled map:
+ * random positions around the hexagons (including past the map edge and
+ * inside walls), random moves (mostly per-tick lengths, some long enough
+ * for collision_move's map-scan fallback) and random radii. Every query
+ * runs through both and the outcomes must agree: collide flags and contact
+ * counts exactly, distances and resolved positions within a tolerance.
+ * collision_move is only compared from starts clear of every wall, as in
+ * play: from inside walls its push-out depends on the order the segments
+ * were gathered in, which the neighbourhood gather and the map scan do not
+ * share (collision_sweep, given the same set on both sides, covers those
+ * starts). The first mismatches are printed with their inputs
+ * (reproducible from the seed), and the exit status is 1 if there were any.
+ *
+ * The last row checks collision_move against the wall slide the game used
+ * before it (ref_check_collision_with_slide), on the outcomes both must
+ * share: a move that touches no wall ends at its destination on both, and
+ * a move that slides along one wall travels as far along it (see
+ * slide_results_differ). Elsewhere they differ by design and are not
+ * compared: the old slide only tests the destination, so long moves tunnel
+ * through walls; it stops dead where the slide is blocked (corners); and it
+ * is level-blind, so queries near another level's hexagons are skipped.
+ *
+ * Each query starts in a random hexagon and runs on its level (or, for a
+ * ramp, either level it joins); the gathers and moves of both sides keep
+ * only that level's walls, so multi-level maps (MAP_LEVELS) are covered.
+ *
+ * Queries per second are reported for both sides, so a collision speed-up
+ * is measured on the same run that shows it still agrees. Map size is a
+ * compile-time constant; make fuzz-collision-scaling builds one harness
+ * per generated map size (25 to 100k hexes).
+ *
+ * Usage: fuzz_collision [-q queries] [-s seed] [-t tolerance]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <time.h>
+#include "hexagon.h"
+#include "collision.h"
+#include "arena.h"
+#include "collision_ref.h"
+
+#define FUZZ_BATCH 65536             // Queries generated, run and compared at a time
+#define FUZZ_REPORT_MISMATCHES 10    // Mismatches printed per function
+#define FUZZ_HEX_VISITS 1000000000.0 // Reference work cap (queries x hexagons scanned)
+
+hexagon_t hexagons[MAP_HEX_COUNT];
+
+// Functions under test, in report order
+typedef enum {
+    FUZZ_GATHER = 0,
+    FUZZ_SWEEP,
+    FUZZ_MOVE,
+    FUZZ_SLIDE,
+    FUZZ_FUNCTION_COUNT
+} fuzz_function_t;
+
+static const char* function_names[FUZZ_FUNCTION_COUNT] = {
+    "collision_gather", "collision_sweep", "collision_move", "collision_move vs old slide"
+};
+
+// One random query: a move from (x, z) to (to_x, to_z)
+typedef struct {
+    float x, z;
+    float to_x, to_z;
+    float radius;
+    float reach;                     // collision_gather radius
+    int hex_idx;
+    int level;                       // Level the gathers and moves run on
+    int clear;                       // Start at least radius from every wall on it
+    int one_level;                   // No other level's hexagon within reach of the move
+    int one_wall;                    // One wall near the move, met away from its ends
+    float wall_dx, wall_dz;          // Its unit direction
+} fuzz_query_t;
+
+// Outcome of one function for one query
+typedef struct {
+    int flag;                        // Collide flag, contact count or segment count
+    float x, z;                      // Distance in x, or resolved position
+} fuzz_result_t;
+
+static fuzz_query_t queries[FUZZ_BATCH];
+static fuzz_result_t live_results[FUZZ_BATCH], ref_results[FUZZ_BATCH];
+static double live_seconds[FUZZ_FUNCTION_COUNT], ref_seconds[FUZZ_FUNCTION_COUNT];
+static uint64_t mismatches[FUZZ_FUNCTION_COUNT];
+static uint64_t compared[FUZZ_FUNCTION_COUNT];
+static float tolerance = 0.001f;
+
+// xorshift32: the same stream on every host, unlike rand()
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static float rng_range(float lo, float hi) {
+    return lo + (hi - lo) * ((rng_next() >> 8) * (1.0f / 16777216.0f));
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Distance between two segments (zero if they cross)
+static float segment_distance(float ax, float az, float bx, float bz, const ref_seg_t* seg) {
+    float ux = bx - ax, uz = bz - az, vx = seg->x2 - seg->x1, vz = seg->z2 - seg->z1;
+    float wx = seg->x1 - ax, wz = seg->z1 - az;
+    float denom = ux * vz - uz * vx;
+    if(denom != 0.0f) {
+        float s = (wx * vz - wz * vx) / denom, t = (wx * uz - wz * ux) / denom;
+        if(s >= 0.0f && s <= 1.0f && t >= 0.0f && t <= 1.0f) return 0.0f;
+    }
+    float d = ref_point_to_line_distance(ax, az, seg->x1, seg->z1, seg->x2, seg->z2);
+    d = fminf(d, ref_point_to_line_distance(bx, bz, seg->x1, seg->z1, seg->x2, seg->z2));
+    d = fminf(d, ref_point_to_line_distance(seg->x1, seg->z1, ax, az, bx, bz));
+    return fminf(d, ref_point_to_line_distance(seg->x2, seg->z2, ax, az, bx, bz));
+}
+
+// Where (x, z) projects onto a segment's line, as a fraction of its length
+static float segment_fraction(const ref_seg_t* seg, float x, float z) {
+    float dx = seg->x2 - seg->x1, dz = seg->z2 - seg->z1;
+    return ((x - seg->x1) * dx + (z - seg->z1) * dz) / (dx*dx + dz*dz);
+}
+
+static void make_query(fuzz_query_t* q) {
+    // Start anywhere within a hexagon's circumradius (and a bit past it, so
+    // map edges and positions already inside walls are covered)
+    const hexagon_t* hex = &hexagons[rng_next() % MAP_HEX_COUNT];
+    float angle = rng_range(0.0f, 6.2831853f);
+    float dist = rng_range(0.0f, 55.0f);
+    q->x = hex->center_x + cosf(angle) * dist;
+    q->z = hex->center_z + sinf(angle) * dist;
+    
+    // Most moves are a tick or a few long (the player's is up to 1.25), one
+    // in five long enough to leave the hexagon's neighbourhood
+    float move = (rng_next() % 5) ? rng_range(0.0f, 8.0f) : rng_range(8.0f, 60.0f);
+    angle = rng_range(0.0f, 6.2831853f);
+    q->to_x = q->x + cosf(angle) * move;
+    q->to_z = q->z + sinf(angle) * move;
+    q->radius = (rng_next() % 2) ? 3.0f : rng_range(0.5f, 15.0f);
+    q->reach = rng_range(0.0f, 40.0f);
+    q->hex_idx = hex - hexagons;
+    q->level = hex->level + (hex->ramp_dir != HEXAGON_FLAT && (rng_next() & 1));
+    
+    // Clear start: no reference segment on the level within the radius (plus
+    // the skin the solver keeps, so a start resting on a wall counts as
+    // touching it)
+    static ref_set_t near;
+    ref_collision_gather(&near, q->x, q->z, q->radius + REF_SKIN, q->level);
+    q->clear = 1;
+    for(int i = 0; i < near.count && q->clear; i++) {
+        const ref_seg_t* seg = &near.segs[i];
+        if(ref_point_to_line_distance(q->x, q->z, seg->x1, seg->z1, seg->x2, seg->z2) < q->radius + REF_SKIN) {
+            q->clear = 0;
+        }
+    }
+    
+    // The old slide scans every level: only compare it where the move's
+    // surroundings are all on the query's level
+    float max_dist = move + q->radius + 50.0f;
+    q->one_level = 1;
+    for(int i = 0; i < MAP_HEX_COUNT && q->one_level; i++) {
+        float dx = hexagons[i].center_x - q->x;
+        float dz = hexagons[i].center_z - q->z;
+        if(dx*dx + dz*dz <= max_dist * max_dist && !hexagon_on_level(&hexagons[i], q->level)) q->one_level = 0;
+    }
+    
+    // Single-wall slide: exactly one segment within the radius of the path,
+    // and both ends of the move project inside it, so the swept circle meets
+    // its face (not an end) and the old slide picks the same wall
+    static ref_set_t path;
+    ref_collision_gather(&path, 0.5f * (q->x + q->to_x), 0.5f * (q->z + q->to_z),
+                         0.5f * move + q->radius + REF_SKIN, q->level);
+    const ref_seg_t* wall = NULL;
+    int walls = 0;
+    for(int i = 0; i < path.count; i++) {
+        if(segment_distance(q->x, q->z, q->to_x, q->to_z, &path.segs[i]) < q->radius + REF_SKIN) {
+            wall = &path.segs[i];
+            walls++;
+        }
+    }
+    q->one_wall = 0;
+    if(walls == 1) {
+        float len = hypotf(wall->x2 - wall->x1, wall->z2 - wall->z1);
+        float margin = (q->radius + REF_SKIN) / len;
+        float from = segment_fraction(wall, q->x, q->z), to = segment_fraction(wall, q->to_x, q->to_z);
+        q->one_wall = from > margin && from < 1.0f - margin && to > margin && to < 1.0f - margin;
+        q->wall_dx = (wall->x2 - wall->x1) / len;
+        q->wall_dz = (wall->z2 - wall->z1) / len;
+    }
+}
+
+static int segment_compare(const void* a, const void* b) {
+    return memcmp(a, b, sizeof(ref_seg_t));
+}
+
+// Order-independent digest of a gathered set: segment count in flag, and
+// the sums of its sorted coordinates (identical sets give identical sums)
+static void digest_segments(ref_seg_t* segs, int count, fuzz_result_t* out) {
+    qsort(segs, count, sizeof(ref_seg_t), segment_compare);
+    out->flag = count;
+    out->x = 0.0f;
+    out->z = 0.0f;
+    for(int i = 0; i < count; i++) {
+        out->x += segs[i].x1 * (i + 1) + segs[i].x2;
+        out->z += segs[i].z1 * (i + 1) + segs[i].z2;
+    }
+}
+
+// Run one function over the batch, into results (live or reference)
+static void run_function(fuzz_function_t fn, int live, int count, fuzz_result_t* results) {
+    static collision_set_t live_set;
+    static ref_set_t ref_set;
+    static ref_seg_t sorted[REF_MAX_SEGMENTS];
+    
+    for(int i = 0; i < count; i++) {
+        const fuzz_query_t* q = &queries[i];
+        fuzz_result_t* r = &results[i];
+        r->flag = 0;
+        r->x = q->to_x;
+        r->z = q->to_z;
+        
+        switch(fn) {
+            case FUZZ_GATHER:
+                // Digested here, so the timing includes the sort for both
+                if(live) {
+                    collision_gather(&live_set, q->x, q->z, q->reach, q->level);
+                    for(int s = 0; s < live_set.count; s++) {
+                        const collision_seg_t* seg = &live_set.segs[s];
+                        sorted[s] = (ref_seg_t){ seg->x1, seg->z1, seg->x2, seg->z2 };
+                    }
+                    digest_segments(sorted, live_set.count, r);
+                } else {
+                    ref_collision_gather(&ref_set, q->x, q->z, q->reach, q->level);
+                    digest_segments(ref_set.segs, ref_set.count, r);
+                }
+                break;
+            case FUZZ_SWEEP: {
+                // Both sweep the reference's gather around the move
+                float reach = 0.5f * hypotf(q->to_x - q->x, q->to_z - q->z) + q->radius + REF_SKIN;
+                ref_collision_gather(&ref_set, 0.5f * (q->x + q->to_x), 0.5f * (q->z + q->to_z), reach, q->level);
+                if(live) {
+                    live_set.count = ref_set.count < COLLISION_MAX_SEGMENTS ? ref_set.count : COLLISION_MAX_SEGMENTS;
+                    for(int s = 0; s < live_set.count; s++) {
+                        const ref_seg_t* seg = &ref_set.segs[s];
+                        live_set.segs[s] = (collision_seg_t){ seg->x1, seg->z1, seg->x2, seg->z2 };
+                    }
+                    r->flag = collision_sweep(&live_set, q->x, q->z, &r->x, &r->z, q->radius, NULL);
+                } else {
+                    float normal_x, normal_z;
+                    r->flag = ref_collision_sweep(&ref_set, q->x, q->z, &r->x, &r->z, q->radius, &normal_x, &normal_z);
+                }
+                break;
+            }
+            case FUZZ_MOVE:
+                if(!queries[i].clear) break;
+                r->flag = live ? collision_move(q->x, q->z, &r->x, &r->z, q->radius, q->level)
+                               : ref_collision_move(q->x, q->z, &r->x, &r->z, q->radius, q->level);
+                break;
+            case FUZZ_SLIDE:
+                if(!q->clear || !q->one_level) break;
+                r->flag = live ? collision_move(q->x, q->z, &r->x, &r->z, q->radius, q->level)
+                               : ref_check_collision_with_slide(q->x, q->z, &r->x, &r->z, q->radius);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static int results_differ(const fuzz_result_t* a, const fuzz_result_t* b) {
+    return a->flag != b->flag || fabsf(a->x - b->x) > tolerance || fabsf(a->z - b->z) > tolerance;
+}
+
+// collision_move (contact count) against the old slide (1 = stopped):
+// 1 if they differ, 0 if they agree, -1 if the outcome is not one both
+// must share. A move with no contact must be accepted unchanged by the old
+// slide. A one-contact move along a single wall that the old slide
+// resolved by sliding must travel as far along the wall: the old slide
+// projects the move onto the wall from the start, while the swept one
+// also closes in on the wall, which only moves it across the wall.
+static int slide_results_differ(const fuzz_query_t* q, const fuzz_result_t* live, const fuzz_result_t* ref) {
+    if(live->flag == 0) return results_differ(live, ref);
+    if(!q->one_wall || live->flag != 1 || ref->flag != 0) return -1;
+    if(fabsf(ref->x - q->to_x) <= tolerance && fabsf(ref->z - q->to_z) <= tolerance) return -1;
+    
+    // The two reach the end by different arithmetic, so allow for a few
+    // float steps at the map coordinates as well
+    float live_travel = (live->x - q->x) * q->wall_dx + (live->z - q->z) * q->wall_dz;
+    float ref_travel = (ref->x - q->x) * q->wall_dx + (ref->z - q->z) * q->wall_dz;
+    float slack = tolerance + 4.0f * FLT_EPSILON * (fabsf(q->x) + fabsf(q->z));
+    return fabsf(live_travel - ref_travel) > slack;
+}
+
+static void report_mismatch(fuzz_function_t fn, uint64_t index, const fuzz_query_t* q,
+                            const fuzz_result_t* live, const fuzz_result_t* ref) {
+    printf("MISMATCH %s, query %llu: from (%.4f, %.4f) to (%.4f, %.4f), radius %.4f, reach %.4f, "
+           "hex %d level %d\n",
+           function_names[fn], (unsigned long long)index, q->x, q->z, q->to_x, q->to_z, q->radius, q->reach,
+           q->hex_idx, q->level);
+    printf("  start %s, live %d (%.5f, %.5f), reference %d (%.5f, %.5f)\n",
+           q->clear ? "clear" : "in a wall", live->flag, live->x, live->z, ref->flag, ref->x, ref->z);
+}
+
+int main(int argc, char** argv) {
+    uint64_t total = 1000000;
+    uint32_t seed = 1;
+    
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-q") && i + 1 < argc) total = strtoull(argv[++i], NULL, 10);
+        else if(!strcmp(argv[i], "-s") && i + 1 < argc) seed = strtoul(argv[++i], NULL, 10);
+        else if(!strcmp(argv[i], "-t") && i + 1 < argc) tolerance = atof(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [-q queries] [-s seed] [-t tolerance]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    // The reference scans the whole map per query: cap its total work so
+    // the largest maps still finish in seconds
+    uint64_t cap = (uint64_t)(FUZZ_HEX_VISITS / MAP_HEX_COUNT);
+    if(total > cap) total = cap;
+    
+    arena_init();
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        hexagon_init(&hexagons[i], &map_hexagons[i]);
+    }
+    hexagon_build_lookup();
+    rng_state = seed ? seed : 1;
+    
+    printf("Collision fuzz: map %s (%d hexes), %llu queries, seed %u, tolerance %g\n",
+           MAP_SEED, MAP_HEX_COUNT, (unsigned long long)total, (unsigned)seed, tolerance);
+    
+    for(uint64_t done = 0; done < total; ) {
+        int count = (total - done < FUZZ_BATCH) ? (int)(total - done) : FUZZ_BATCH;
+        for(int i = 0; i < count; i++) {
+            make_query(&queries[i]);
+        }
+        
+        for(int fn = 0; fn < FUZZ_FUNCTION_COUNT; fn++) {
+            double t0 = now_seconds();
+            run_function(fn, 0, count, ref_results);
+            double t1 = now_seconds();
+            run_function(fn, 1, count, live_results);
+            double t2 = now_seconds();
+            ref_seconds[fn] += t1 - t0;
+            live_seconds[fn] += t2 - t1;
+            
+            for(int i = 0; i < count; i++) {
+                int differ;
+                if(fn == FUZZ_SLIDE) {
+                    if(!queries[i].clear || !queries[i].one_level) continue;
+                    differ = slide_results_differ(&queries[i], &live_results[i], &ref_results[i]);
+                    if(differ < 0) continue;
+                } else {
+                    if(fn == FUZZ_MOVE && !queries[i].clear) continue;
+                    differ = results_differ(&live_results[i], &ref_results[i]);
+                }
+                compared[fn]++;
+                if(!differ) continue;
+                if(mismatches[fn]++ < FUZZ_REPORT_MISMATCHES) {
+                    report_mismatch(fn, done + i, &queries[i], &live_results[i], &ref_results[i]);
+                }
+            }
+        }
+        done += count;
+    }
+    
+    uint64_t failed = 0;
+    printf("\n%-28s %14s %14s %8s %10s %12s\n", "function", "live q/s", "reference q/s", "speedup",
+           "compared", "mismatches");
+    for(int fn = 0; fn < FUZZ_FUNCTION_COUNT; fn++) {
+        printf("%-28s %14.0f %14.0f %7.2fx %10llu %12llu\n", function_names[fn],
+               compared[fn] / live_seconds[fn], compared[fn] / ref_seconds[fn], ref_seconds[fn] / live_seconds[fn],
+               (unsigned long long)compared[fn], (unsigned long long)mismatches[fn]);
+        failed += mismatches[fn];
+    }
+    
+    if(failed) {
+        printf("FUZZ FAILED: %llu mismatches\n", (unsigned long long)failed);
+        return 1;
+    }
+    printf("FUZZ PASSED\n");
+    return 0;
+}
@@ -0,0 +1,299 @@
+/*
+ * ENCOM-64 host overdraw report
+ * Runs render_world() against the software RDP along a camera path and
+ * reports pixels filled and overdraw per pass, plus write-count heatmaps
+ * (PPM) for the mean and the worst frame. The path is either a recorded
+ * file ("x z yaw_deg" per line) or the auto-walk tour, which can be saved
+ * with -w so later culling/occlusion changes are measured on the same path.
+ * With -v 2 or -v 4 the frame is split-screen, each view following the path
+ * from a different starting pose; host render time per frame is reported
+ * so split-screen cost can be compared with a single view. -t draws every
+ * wall two-sided (back-face culling off) for comparison. TMEM uploads per
+ * frame are reported against TEXTURE_UPLOAD_BUDGET; -f renders untextured.
+ * Memory budgets and their high-water marks are printed at the end; -x
+ * sizes them (and the caches) for an Expansion Pak. -z renders with the
+ * Z-buffer instead of painter's order. Either way the frame's RDRAM traffic
+ * (colour writes, plus Z clear, reads and writes) is estimated for 16 and
+ * 32 bpp targets, to weigh Z bandwidth against the overdraw it saves. -i
+ * draws one interlace field per frame, even and odd in turn, as the ROM
+ * does at 640x480 (reconstructing the other field is not counted).
+ *
+ * Usage: overdraw_report [-p path.txt] [-w path.txt] [-o output_dir] [-v views] [-t] [-f] [-x] [-z] [-i]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hexagon.h"
+#include "map_loader.h"
+#include "nav.h"
+#include "sim.h"
+#include "autowalk.h"
+#include "render.h"
+#include "geometry.h"
+#include "texture.h"
+#include "arena.h"
+#include "soft_rdp.h"
+
+#define PATH_MAX_POSES (SIM_TICK_HZ * 60 * 30)  // 30 simulated minutes
+#define HEATMAP_LEVELS 8
+
+hexagon_t hexagons[MAP_HEX_COUNT];
+static autowalk_t walk;
+
+static player_state_t path[PATH_MAX_POSES];
+static uint32_t mean_writes[SOFT_RDP_PIXELS];
+static uint16_t worst_writes[SOFT_RDP_PIXELS];
+
+static const char* pass_names[RENDER_PASS_COUNT] = { "clear", "ceiling", "floor", "wall" };
+
+// Writes per pixel: 0 black, 1 blue, then green, yellow, orange, red, magenta, white
+static const uint8_t heat_colors[HEATMAP_LEVELS][3] = {
+    { 0, 0, 0 }, { 0, 0, 160 }, { 0, 160, 0 }, { 200, 200, 0 },
+    { 255, 128, 0 }, { 255, 0, 0 }, { 255, 0, 255 }, { 255, 255, 255 }
+};
+
+static int load_path(const char* filename) {
+    FILE* f = fopen(filename, "r");
+    if(!f) return -1;
+    
+    // x z yaw, then the floor height (single-level paths leave it out)
+    int count = 0;
+    char line[128];
+    while(count < PATH_MAX_POSES && fgets(line, sizeof(line), f)) {
+        path[count].floor_y = 0.0f;
+        if(sscanf(line, "%f %f %f %f", &path[count].x, &path[count].z, &path[count].yaw_deg,
+                  &path[count].floor_y) < 3) break;
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+// Record the auto-walk tour from the ROM's spawn, one pose per tick
+static int record_autowalk_path(void) {
+    player_state_t player = { .x = 0.0f, .z = 0.0f, .yaw_deg = 0.0f, .floor_y = 0.0f, .level = 0 };
+    if(hexagon_at_position(player.x, player.z, player.level) < 0) {
+        player.x = hexagons[0].center_x;
+        player.z = hexagons[0].center_z;
+    }
+    
+    autowalk_start(&walk, &player);
+    int count = 0;
+    while(count < PATH_MAX_POSES) {
+        sim_input_t input;
+        if(!autowalk_input(&walk, &player, &input)) break;
+        sim_tick(&player, &input);
+        path[count++] = player;
+    }
+    return count;
+}
+
+static int save_path(const char* filename, int count) {
+    FILE* f = fopen(filename, "w");
+    if(!f) return -1;
+    for(int i = 0; i < count; i++) {
+        fprintf(f, "%.3f %.3f %.3f %.3f\n", path[i].x, path[i].z, path[i].yaw_deg, path[i].floor_y);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int write_heatmap(const char* filename, const uint32_t* writes, uint32_t divisor) {
+    FILE* f = fopen(filename, "wb");
+    if(!f) return -1;
+    
+    fprintf(f, "P6\n%d %d\n255\n", SOFT_RDP_WIDTH, SOFT_RDP_HEIGHT);
+    for(int i = 0; i < SOFT_RDP_PIXELS; i++) {
+        uint32_t level = (writes[i] + divisor / 2) / divisor;
+        if(level >= HEATMAP_LEVELS) level = HEATMAP_LEVELS - 1;
+        fwrite(heat_colors[level], 1, 3, f);
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* path_in = NULL;
+    const char* path_out = NULL;
+    const char* out_dir = ".";
+    int views = 1;
+    int fields = 0;
+    
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-p") && i + 1 < argc) path_in = argv[++i];
+        else if(!strcmp(argv[i], "-w") && i + 1 < argc) path_out = argv[++i];
+        else if(!strcmp(argv[i], "-o") && i + 1 < argc) out_dir = argv[++i];
+        else if(!strcmp(argv[i], "-v") && i + 1 < argc) views = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-t")) render_backface_cull = 0;
+        else if(!strcmp(argv[i], "-f")) render_textures = 0;
+        else if(!strcmp(argv[i], "-x")) arena_expanded = 1;
+        else if(!strcmp(argv[i], "-z")) render_zbuffer = 1;
+        else if(!strcmp(argv[i], "-i")) fields = 1;
+        else {
+            fprintf(stderr, "Usage: %s [-p path.txt] [-w path.txt] [-o output_dir] [-v 1|2|4] [-t] [-f] [-x] [-z] [-i]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(views != 1 && views != 2 && views != 4) {
+        fprintf(stderr, "Views must be 1, 2 or 4\n");
+        return 2;
+    }
+    
+    arena_init();
+#ifdef MAP_BLOB_FILE
+    if(map_load("build/" MAP_BLOB_FILE, NULL) < 0) {
+        fprintf(stderr, "Cannot load map blob build/%s\n", MAP_BLOB_FILE);
+        return 1;
+    }
+#endif
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        hexagon_init(&hexagons[i], &map_hexagons[i]);
+    }
+    hexagon_build_lookup();
+    geometry_build();
+    texture_init();
+    render_init();
+    nav_init();
+    
+    int frames = path_in ? load_path(path_in) : record_autowalk_path();
+    if(frames <= 0) {
+        fprintf(stderr, "No camera path (%s)\n", path_in ? path_in : "auto-walk");
+        return 1;
+    }
+    if(path_out && save_path(path_out, frames) < 0) {
+        fprintf(stderr, "Cannot write %s\n", path_out);
+        return 1;
+    }
+    
+    printf("Map: %s (%d hexes), %d frames (%s), %d view%s\n", MAP_SEED, MAP_HEX_COUNT, frames,
+           path_in ? path_in : "auto-walk tour", views, views > 1 ? "s" : "");
+    printf("Geometry: %d floor pieces (%d hexagon parts, %d cuts for lighting), %d shared walls, %d two-sided\n",
+           geometry_stats.floor_pieces, MAP_HEX_COUNT * GEOMETRY_PIECE_KINDS, geometry_stats.lighting_splits,
+           geometry_stats.shared_walls, geometry_stats.two_sided_walls);
+    printf("Wall back-face culling: %s\n", render_backface_cull ? "on" : "off");
+    printf("Textures: %s\n", render_textures ? "on" : "off");
+    printf("Hidden surfaces: %s\n", render_zbuffer ? "Z-buffer" : "painter's order");
+    printf("Lines drawn: %s\n", fields ? "one interlace field per frame" : "all");
+    
+    uint64_t pass_pixels[RENDER_PASS_COUNT] = { 0 };
+    uint64_t pass_triangles[RENDER_PASS_COUNT] = { 0 };
+    uint64_t z_tests = 0, z_rejects = 0, z_clears = 0;
+    uint32_t worst_total = 0;
+    int worst_frame = 0;
+    
+    double render_seconds = 0.0;
+    uint64_t upload_bytes = 0, uploads = 0, binds = 0;
+    uint32_t worst_upload = 0;
+    int over_budget = 0;
+    
+    for(int f = 0; f < frames; f++) {
+        // Same cameras as the ROM, views spread evenly along the path
+        camera_t cameras[RENDER_MAX_VIEWS];
+        for(int v = 0; v < views; v++) {
+            const player_state_t* pose = &path[(f + v * frames / views) % frames];
+            cameras[v] = (camera_t){
+                .x = pose->x,
+                .y = pose->floor_y + HEXAGON_EYE_HEIGHT,
+                .z = pose->z,
+                .yaw_rad = (pose->yaw_deg * 3.14159f) / 180.0f
+            };
+        }
+        render_split_viewports(cameras, views, SOFT_RDP_WIDTH, SOFT_RDP_HEIGHT);
+        if(fields) render_field = RENDER_FIELD_EVEN + (f & 1);
+        
+        soft_rdp_begin_frame();
+        arena_frame_reset();
+        texture_invalidate();  // The ROM's minimap blit overwrites TMEM every frame
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        render_world_views(cameras, views);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        render_seconds += (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+        
+        upload_bytes += texture_stats.upload_bytes;
+        uploads += texture_stats.uploads;
+        binds += texture_stats.binds;
+        if(texture_stats.upload_bytes > worst_upload) worst_upload = texture_stats.upload_bytes;
+        if(texture_stats.upload_bytes > TEXTURE_UPLOAD_BUDGET) over_budget++;
+        
+        uint32_t total = 0;
+        for(int p = 0; p < RENDER_PASS_COUNT; p++) {
+            pass_pixels[p] += soft_rdp_pass_pixels[p];
+            pass_triangles[p] += soft_rdp_pass_triangles[p];
+            total += soft_rdp_pass_pixels[p];
+            z_tests += soft_rdp_pass_z_tests[p];
+            z_rejects += soft_rdp_pass_z_rejects[p];
+        }
+        z_clears += soft_rdp_z_clears;
+        for(int i = 0; i < SOFT_RDP_PIXELS; i++) {
+            mean_writes[i] += soft_rdp_writes[i];
+        }
+        if(total > worst_total) {
+            worst_total = total;
+            worst_frame = f;
+            memcpy(worst_writes, soft_rdp_writes, sizeof(worst_writes));
+        }
+    }
+    
+    // Per-pass fill cost: overdraw is pixels filled per screen pixel
+    uint64_t total_pixels = 0;
+    printf("\n%-8s %12s %10s %10s\n", "pass", "pixels/frame", "overdraw", "tris/frame");
+    for(int p = 0; p < RENDER_PASS_COUNT; p++) {
+        total_pixels += pass_pixels[p];
+        printf("%-8s %12.0f %10.2f %10.1f\n", pass_names[p],
+               (double)pass_pixels[p] / frames,
+               (double)pass_pixels[p] / frames / SOFT_RDP_PIXELS,
+               (double)pass_triangles[p] / frames);
+    }
+    printf("%-8s %12.0f %10.2f\n", "total", (double)total_pixels / frames,
+           (double)total_pixels / frames / SOFT_RDP_PIXELS);
+    
+    // RDRAM traffic: every colour write, and with the Z-buffer a 16-bit
+    // clear, a read per pixel tested and a write per pixel kept
+    double z_bytes = 2.0 * (z_clears + z_tests + (z_tests - z_rejects)) / frames;
+    if(render_zbuffer) {
+        printf("Z-buffer: %.0f pixels/frame tested, %.0f hidden (%.1f%%)\n",
+               (double)z_tests / frames, (double)z_rejects / frames,
+               z_tests ? 100.0 * z_rejects / z_tests : 0.0);
+    }
+    printf("RDRAM traffic: 16 bpp %.1f KB/frame, 32 bpp %.1f KB/frame (Z %.1f KB of each)\n",
+           (2.0 * total_pixels / frames + z_bytes) / 1024.0,
+           (4.0 * total_pixels / frames + z_bytes) / 1024.0, z_bytes / 1024.0);
+    printf("\nHost render time: %.1f us/frame (CPU path plus software raster)\n",
+           render_seconds * 1e6 / frames);
+    if(render_textures) {
+        printf("TMEM uploads: %.0f bytes/frame (worst %u, budget %d, %d frames over), %.1f loads, %.1f binds/frame\n",
+               (double)upload_bytes / frames, (unsigned)worst_upload, TEXTURE_UPLOAD_BUDGET, over_budget,
+               (double)uploads / frames, (double)binds / frames);
+    }
+    printf("Visibility cache: %u regathers in %u view frames (%.1f%% hits)\n",
+           (unsigned)render_cache_stats.rebuilds, (unsigned)render_cache_stats.lookups,
+           100.0 * (render_cache_stats.lookups - render_cache_stats.rebuilds) / render_cache_stats.lookups);
+    printf("Worst frame: #%d (%.3f, %.3f, yaw %.1f), %u pixels, overdraw %.2f\n",
+           worst_frame, path[worst_frame].x, path[worst_frame].z, path[worst_frame].yaw_deg,
+           worst_total, (double)worst_total / SOFT_RDP_PIXELS);
+    printf("\n");
+    arena_report();
+    
+    // Heatmaps: mean over the path (rounded) and the worst frame
+    static uint32_t worst32[SOFT_RDP_PIXELS];
+    for(int i = 0; i < SOFT_RDP_PIXELS; i++) worst32[i] = worst_writes[i];
+    
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%s/overdraw_mean.ppm", out_dir);
+    if(write_heatmap(filename, mean_writes, frames) < 0) {
+        fprintf(stderr, "Cannot write %s\n", filename);
+        return 1;
+    }
+    printf("Heatmaps: %s", filename);
+    snprintf(filename, sizeof(filename), "%s/overdraw_worst.ppm", out_dir);
+    if(write_heatmap(filename, worst32, 1) < 0) {
+        fprintf(stderr, "Cannot write %s\n", filename);
+        return 1;
+    }
+    printf(", %s\n", filename);
+    
+    return 0;
+}
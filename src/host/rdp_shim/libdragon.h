@@ -0,0 +1,47 @@
+/*
+ * Host shim for the parts of libdragon used by the render sources.
+ * Only what render.c needs to compile natively; rdpq calls are
+ * implemented by the software rasteriser in src/host/soft_rdp.c.
+ */
+
+#ifndef HOST_SHIM_LIBDRAGON_H
+#define HOST_SHIM_LIBDRAGON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+typedef struct {
+    uint8_t r, g, b, a;
+} color_t;
+
+#define RGBA32(rx, gx, bx, ax) ((color_t){ (rx), (gx), (bx), (ax) })
+
+#define assertf(expr, ...) assert(expr)
+
+// Texture surfaces: only the intensity formats render.c uses
+typedef enum {
+    FMT_NONE = 0,
+    FMT_I4,
+    FMT_I8
+} tex_format_t;
+
+typedef struct {
+    uint16_t flags;                  // Format
+    uint16_t width, height;
+    uint16_t stride;                 // Bytes per row
+    void* buffer;
+} surface_t;
+
+static inline surface_t surface_make_linear(void* buffer, tex_format_t format, uint16_t width, uint16_t height) {
+    uint16_t stride = format == FMT_I4 ? (width + 1) / 2 : width;
+    return (surface_t){ format, width, height, stride, buffer };
+}
+
+static inline void data_cache_hit_writeback(const void* addr, unsigned long length) {
+    (void)addr;
+    (void)length;
+}
+
+#endif // HOST_SHIM_LIBDRAGON_H
@@ -0,0 +1,21 @@
+#ifndef HOST_SHIM_RDPQ_H
+#define HOST_SHIM_RDPQ_H
+
+#include "libdragon.h"
+
+typedef enum {
+    TILE0 = 0, TILE1, TILE2, TILE3, TILE4, TILE5, TILE6, TILE7
+} rdpq_tile_t;
+
+void rdpq_set_prim_color(color_t color);
+void rdpq_set_fog_color(color_t color);
+void rdpq_set_mode_fill(color_t color);
+void rdpq_set_mode_standard(void);
+void rdpq_fill_rectangle(float x0, float y0, float x1, float y1);
+void rdpq_set_scissor(int x0, int y0, int x1, int y1);
+void rdpq_clear_z(uint16_t z);
+
+#include "rdpq_tri.h"
+#include "rdpq_mode.h"
+
+#endif // HOST_SHIM_RDPQ_H
@@ -0,0 +1,27 @@
+#ifndef HOST_SHIM_RDPQ_MODE_H
+#define HOST_SHIM_RDPQ_MODE_H
+
+#include "libdragon.h"
+
+typedef uint64_t rdpq_combiner_t;
+typedef uint32_t rdpq_blender_t;
+
+#define RDPQ_COMBINER_FLAT ((rdpq_combiner_t)1)
+#define RDPQ_COMBINER1(rgb, alpha) ((rdpq_combiner_t)2)   // Taken as prim * shade
+#define RDPQ_COMBINER2(rgb0, alpha0, rgb1, alpha1) ((rdpq_combiner_t)3)   // Taken as texel * prim * shade
+#define RDPQ_BLENDER_MULTIPLY ((rdpq_blender_t)1)
+#define RDPQ_FOG_STANDARD ((rdpq_blender_t)2)
+
+typedef enum {
+    FILTER_POINT = 0,
+    FILTER_BILINEAR
+} rdpq_filter_t;
+
+void rdpq_mode_combiner(rdpq_combiner_t comb);
+void rdpq_mode_blender(rdpq_blender_t blend);
+void rdpq_mode_fog(rdpq_blender_t fog);
+void rdpq_mode_filter(rdpq_filter_t filter);
+void rdpq_mode_persp(bool perspective);
+void rdpq_mode_zbuf(bool compare, bool update);
+
+#endif // HOST_SHIM_RDPQ_MODE_H
@@ -0,0 +1,21 @@
+#ifndef HOST_SHIM_RDPQ_TEX_H
+#define HOST_SHIM_RDPQ_TEX_H
+
+#include "rdpq.h"
+
+#define REPEAT_INFINITE 2048
+
+typedef struct {
+    int tmem_addr;
+    int palette;
+    struct {
+        float translate;
+        int scale_log;
+        float repeats;
+        bool mirror;
+    } s, t;
+} rdpq_texparms_t;
+
+int rdpq_tex_upload(rdpq_tile_t tile, const surface_t* tex, const rdpq_texparms_t* parms);
+
+#endif // HOST_SHIM_RDPQ_TEX_H
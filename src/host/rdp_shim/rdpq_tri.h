@@ -0,0 +1,18 @@
+#ifndef HOST_SHIM_RDPQ_TRI_H
+#define HOST_SHIM_RDPQ_TRI_H
+
+#include "libdragon.h"
+
+typedef struct {
+    int pos_offset;
+    int shade_offset;
+    bool shade_flat;
+    int tex_offset;
+    int tex_tile;
+    int tex_mipmaps;
+    int z_offset;
+} rdpq_trifmt_t;
+
+void rdpq_triangle(const rdpq_trifmt_t* fmt, const float* v1, const float* v2, const float* v3);
+
+#endif // HOST_SHIM_RDPQ_TRI_H
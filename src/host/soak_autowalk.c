@@ -0,0 +1,231 @@
+/*
+ * ENCOM-64 host soak test: auto-walk tour
+ * Drives the real simulation (sim_tick + swept collision) with auto-walk
+ * input until every reachable hexagon has been visited, then reports
+ * simulated time and host cost per tick. Exits non-zero if the tour
+ * leaves hexagons unvisited or runs out of ticks.
+ *
+ * With -n, checks the nav cache instead: each trial closes and reopens a
+ * few random edges, reporting every change through nav_notify_hex_changed,
+ * and requires the relaxed flow field to match a freshly computed one and
+ * nav_find_path to return paths as long as the field's BFS distance.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hexagon.h"
+#include "map_loader.h"
+#include "nav.h"
+#include "sim.h"
+#include "autowalk.h"
+#include "arena.h"
+
+#define SOAK_MAX_TICKS (SIM_TICK_HZ * 60 * 60)  // One simulated hour
+#define NAV_CHECK_EDGES 4                       // Edges edited per trial (at most)
+#define NAV_CHECK_REPORTS 10                    // Mismatches printed in full
+
+hexagon_t hexagons[MAP_HEX_COUNT];
+static autowalk_t walk;
+
+// Edge between two hexagons, with each side's original connection bit
+typedef struct {
+    int hex, neighbor, dir;
+    uint8_t hex_bit, neighbor_bit;
+} nav_edge_t;
+
+static uint16_t relaxed_dist[MAP_HEX_COUNT];
+static int8_t relaxed_dir[MAP_HEX_COUNT];
+static int32_t nav_path[MAP_HEX_COUNT];
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Set one side's connection bit and report the change to nav
+static void nav_set_side(int hex, int dir, int open) {
+    uint8_t old_connections = hexagons[hex].connections;
+    if(open) hexagons[hex].connections |= 1 << dir;
+    else hexagons[hex].connections &= ~(1 << dir);
+    nav_notify_hex_changed(hex, old_connections);
+}
+
+// Pick a random edge whose two hexagons are each other's neighbours (not
+// already in edges), or return 0
+static int nav_pick_edge(nav_edge_t* edges, int count) {
+    int hex = rng_next() % MAP_HEX_COUNT, dir = rng_next() % 6;
+    int neighbor = hexagon_neighbor(hex, dir);
+    if(neighbor < 0 || hexagon_neighbor(neighbor, (dir + 3) % 6) != hex) return 0;
+    for(int i = 0; i < count; i++) {
+        if((edges[i].hex == hex && edges[i].dir == dir) ||
+           (edges[i].hex == neighbor && edges[i].dir == (dir + 3) % 6)) return 0;
+    }
+    
+    edges[count] = (nav_edge_t){
+        .hex = hex,
+        .neighbor = neighbor,
+        .dir = dir,
+        .hex_bit = (hexagons[hex].connections >> dir) & 1,
+        .neighbor_bit = (hexagons[neighbor].connections >> ((dir + 3) % 6)) & 1,
+    };
+    return 1;
+}
+
+// Compare the relaxed copy with the field towards goal (distances must
+// match; on ties the relaxed step may differ, but must lead one step closer)
+static int nav_check_field(const nav_field_t* fresh, int goal, int trial) {
+    int mismatches = 0;
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        int dist = relaxed_dist[i];
+        int step = relaxed_dir[i] < 0 ? -1 : nav_edge_open(i, relaxed_dir[i]);
+        int ok = dist == fresh->dist[i];
+        if(dist == 0 || dist == NAV_UNREACHABLE) ok = ok && relaxed_dir[i] < 0;
+        else ok = ok && step >= 0 && fresh->dist[step] == dist - 1;
+        
+        if(!ok && mismatches++ < NAV_CHECK_REPORTS) {
+            printf("Trial %d, goal %d: hex %d relaxed dist %d dir %d, fresh dist %d dir %d\n", trial, goal,
+                   i, dist, relaxed_dir[i], fresh->dist[i], fresh->next_dir[i]);
+        }
+    }
+    return mismatches;
+}
+
+// A* from start must find a path of the field's length through open edges
+static int nav_check_path(const nav_field_t* field, int start, int trial) {
+    int len = nav_find_path(start, field->goal, nav_path, MAP_HEX_COUNT);
+    int expected = field->dist[start] == NAV_UNREACHABLE ? 0 : field->dist[start] + 1;
+    int ok = len == expected && (len == 0 || (nav_path[0] == start && nav_path[len - 1] == field->goal));
+    for(int i = 1; ok && i < len; i++) {
+        int dir = 0;
+        while(dir < 6 && nav_edge_open(nav_path[i - 1], dir) != nav_path[i]) dir++;
+        ok = dir < 6;
+    }
+    
+    if(!ok) {
+        printf("Trial %d: path %d -> %d has %d hexes, field distance %d\n", trial, start, field->goal,
+               len, field->dist[start]);
+    }
+    return !ok;
+}
+
+// Edit random edges and check the nav cache against fresh searches
+static int nav_check(int trials, uint32_t seed) {
+    int field_mismatches = 0, path_mismatches = 0, edited = 0;
+    rng_state = seed ? seed : 1;
+    
+    for(int trial = 0; trial < trials; trial++) {
+        int goal = rng_next() % MAP_HEX_COUNT;
+        nav_edge_t edges[NAV_CHECK_EDGES];
+        int count = 0, target = 1 + rng_next() % NAV_CHECK_EDGES;
+        for(int attempt = 0; count < target && attempt < 100; attempt++) {
+            count += nav_pick_edge(edges, count);
+        }
+        edited += count;
+        
+        // Close the edges (the cached field goes dirty and is recomputed),
+        // then reopen them, which relaxes it in place
+        for(int i = 0; i < count; i++) {
+            nav_set_side(edges[i].hex, edges[i].dir, 0);
+            nav_set_side(edges[i].neighbor, (edges[i].dir + 3) % 6, 0);
+        }
+        nav_get_flow_field(goal);
+        for(int i = 0; i < count; i++) {
+            nav_set_side(edges[i].hex, edges[i].dir, 1);
+            nav_set_side(edges[i].neighbor, (edges[i].dir + 3) % 6, 1);
+        }
+        const nav_field_t* field = nav_get_flow_field(goal);
+        memcpy(relaxed_dist, field->dist, sizeof(relaxed_dist));
+        memcpy(relaxed_dir, field->next_dir, sizeof(relaxed_dir));
+        
+        // Emptying the cache forces a full BFS towards the goal
+        nav_init();
+        field = nav_get_flow_field(goal);
+        field_mismatches += nav_check_field(field, goal, trial) > 0;
+        path_mismatches += nav_check_path(field, rng_next() % MAP_HEX_COUNT, trial);
+        
+        // Back to the map's own connections (in reverse, as edits may share hexagons)
+        for(int i = count - 1; i >= 0; i--) {
+            nav_set_side(edges[i].neighbor, (edges[i].dir + 3) % 6, edges[i].neighbor_bit);
+            nav_set_side(edges[i].hex, edges[i].dir, edges[i].hex_bit);
+        }
+    }
+    
+    printf("Map: %s (%d hexes), %d trials, %d edges edited\n", MAP_SEED, MAP_HEX_COUNT, trials, edited);
+    printf("Relaxed fields differing from a fresh BFS: %d\n", field_mismatches);
+    printf("Paths not matching the BFS distance: %d\n", path_mismatches);
+    if(field_mismatches || path_mismatches) {
+        printf("NAV CHECK FAILED\n");
+        return 1;
+    }
+    printf("NAV CHECK PASSED\n");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int nav_trials = 0;
+    uint32_t seed = 1;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-n") && i + 1 < argc) nav_trials = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-s") && i + 1 < argc) seed = strtoul(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "Usage: %s [-n nav_check_trials] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    arena_init();
+#ifdef MAP_BLOB_FILE
+    if(map_load("build/" MAP_BLOB_FILE, NULL) < 0) {
+        fprintf(stderr, "Cannot load map blob build/%s\n", MAP_BLOB_FILE);
+        return 1;
+    }
+#endif
+    for(int i = 0; i < MAP_HEX_COUNT; i++) {
+        hexagon_init(&hexagons[i], &map_hexagons[i]);
+    }
+    hexagon_build_lookup();
+    nav_init();
+    if(nav_trials > 0) return nav_check(nav_trials, seed);
+    
+    // Same spawn as the ROM, falling back to the first hexagon
+    player_state_t player = { .x = 0.0f, .z = 0.0f, .yaw_deg = 0.0f, .floor_y = 0.0f, .level = 0 };
+    if(hexagon_at_position(player.x, player.z, player.level) < 0) {
+        player.x = hexagons[0].center_x;
+        player.z = hexagons[0].center_z;
+    }
+    
+    autowalk_start(&walk, &player);
+    printf("Map: %s (%d hexes), %d reachable from spawn\n", MAP_SEED, MAP_HEX_COUNT, walk.reachable_count);
+    
+    int ticks = 0;
+    double start = now_seconds();
+    while(ticks < SOAK_MAX_TICKS) {
+        sim_input_t input;
+        if(!autowalk_input(&walk, &player, &input)) break;
+        sim_tick(&player, &input);
+        ticks++;
+    }
+    double elapsed = now_seconds() - start;
+    
+    printf("Visited %d/%d hexes (%d skipped as stuck) in %d ticks (%.1f s simulated)\n",
+           walk.visited_count - walk.skipped, walk.reachable_count, walk.skipped, ticks, ticks / (float)SIM_TICK_HZ);
+    printf("Host cost: %.2f us per tick\n", ticks ? elapsed / ticks * 1e6 : 0.0);
+    
+    if(walk.active || walk.skipped > 0) {
+        printf("SOAK FAILED\n");
+        return 1;
+    }
+    printf("SOAK PASSED\n");
+    return 0;
+}
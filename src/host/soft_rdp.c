@@ -0,0 +1,299 @@
+/*
+ * Software stand-in for the RDP, used by host tools built on the render
+ * sources. Triangles are sampled at pixel centres with a top-left fill
+ * rule and clipped to the scissor (320x240 by default), which matches the RDP's
+ * coverage closely enough for fill-cost accounting. Texture uploads land in
+ * a 4 KB TMEM image that triangles sample from (I4, wrapping,
+ * perspective-corrected, point or bilinear), so TMEM placement mistakes
+ * show up in the output. A float Z-buffer stands in for the RDP's, tested
+ * and updated per pixel when the mode enables it. The scissor's field mode
+ * (interlace_set_scissor) skips the other field's lines.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <rdpq.h>
+#include <rdpq_tex.h>
+#include "soft_rdp.h"
+#include "interlace.h"
+
+#define SOFT_RDP_TMEM_BYTES 4096
+
+uint16_t soft_rdp_writes[SOFT_RDP_PIXELS];
+color_t soft_rdp_color[SOFT_RDP_PIXELS];
+uint32_t soft_rdp_pass_pixels[RENDER_PASS_COUNT];
+uint32_t soft_rdp_pass_triangles[RENDER_PASS_COUNT];
+uint32_t soft_rdp_pass_z_tests[RENDER_PASS_COUNT];
+uint32_t soft_rdp_pass_z_rejects[RENDER_PASS_COUNT];
+uint32_t soft_rdp_z_clears;
+
+static color_t prim_color;
+static color_t fill_color;
+static color_t fog_color;
+static int fog_enabled;
+static int shade_lit;                // Combiner multiplies prim by shade RGB
+static int textured;                 // ... and by the texel
+static int bilinear;
+static int perspective;
+static int z_compare, z_update;
+
+// Z-buffer, 0 (near) to 1 (far)
+static float zbuf[SOFT_RDP_PIXELS];
+
+// TMEM contents and the tiles describing the levels uploaded into it
+static uint8_t tmem[SOFT_RDP_TMEM_BYTES];
+static struct {
+    int addr, pitch;                 // Bytes
+    int width, height;               // Texels (powers of two, wrapping)
+} tiles[8];
+static int scissor_x0, scissor_y0, scissor_x1 = SOFT_RDP_WIDTH, scissor_y1 = SOFT_RDP_HEIGHT;
+static int scissor_field = -1;       // Lines kept: 0 even, 1 odd, -1 all
+
+void soft_rdp_begin_frame(void) {
+    memset(soft_rdp_writes, 0, sizeof(soft_rdp_writes));
+    memset(soft_rdp_color, 0, sizeof(soft_rdp_color));
+    memset(soft_rdp_pass_pixels, 0, sizeof(soft_rdp_pass_pixels));
+    memset(soft_rdp_pass_triangles, 0, sizeof(soft_rdp_pass_triangles));
+    memset(soft_rdp_pass_z_tests, 0, sizeof(soft_rdp_pass_z_tests));
+    memset(soft_rdp_pass_z_rejects, 0, sizeof(soft_rdp_pass_z_rejects));
+    soft_rdp_z_clears = 0;
+    rdpq_set_scissor(0, 0, SOFT_RDP_WIDTH, SOFT_RDP_HEIGHT);
+}
+
+static void plot(int x, int y, color_t color) {
+    int i = y * SOFT_RDP_WIDTH + x;
+    soft_rdp_writes[i]++;
+    soft_rdp_color[i] = color;
+    soft_rdp_pass_pixels[render_current_pass]++;
+}
+
+void rdpq_set_prim_color(color_t color) {
+    prim_color = color;
+}
+
+void rdpq_set_mode_fill(color_t color) {
+    fill_color = color;
+    z_compare = z_update = 0;
+}
+
+void rdpq_set_fog_color(color_t color) {
+    fog_color = color;
+}
+
+void rdpq_set_scissor(int x0, int y0, int x1, int y1) {
+    scissor_x0 = x0 < 0 ? 0 : x0;
+    scissor_y0 = y0 < 0 ? 0 : y0;
+    scissor_x1 = x1 > SOFT_RDP_WIDTH ? SOFT_RDP_WIDTH : x1;
+    scissor_y1 = y1 > SOFT_RDP_HEIGHT ? SOFT_RDP_HEIGHT : y1;
+    scissor_field = -1;
+}
+
+void interlace_set_scissor(int x0, int y0, int x1, int y1, int field) {
+    rdpq_set_scissor(x0, y0, x1, y1);
+    scissor_field = field;
+}
+
+void rdpq_set_mode_standard(void) {
+    fog_enabled = 0;
+    z_compare = z_update = 0;
+}
+
+// The whole buffer, as rdpq_clear_z fills the attached Z surface
+// (RENDER_ZBUF_CLEAR, the farthest value, clears to 1)
+void rdpq_clear_z(uint16_t z) {
+    for(int i = 0; i < SOFT_RDP_PIXELS; i++) {
+        zbuf[i] = z * (1.0f / RENDER_ZBUF_CLEAR);
+    }
+    soft_rdp_z_clears += SOFT_RDP_PIXELS;
+}
+
+void rdpq_mode_zbuf(bool compare, bool update) {
+    z_compare = compare;
+    z_update = update;
+}
+
+void rdpq_mode_combiner(rdpq_combiner_t comb) {
+    shade_lit = (comb != RDPQ_COMBINER_FLAT);
+    textured = (comb == RDPQ_COMBINER2(0, 0, 0, 0));
+}
+
+void rdpq_mode_filter(rdpq_filter_t filter) {
+    bilinear = (filter == FILTER_BILINEAR);
+}
+
+void rdpq_mode_persp(bool enable) {
+    perspective = enable;
+}
+
+// I4 upload: rows padded to 8-byte TMEM words, as the RDP loads them
+int rdpq_tex_upload(rdpq_tile_t tile, const surface_t* tex, const rdpq_texparms_t* parms) {
+    int row_bytes = (tex->width + 1) / 2;
+    int pitch = (row_bytes + 7) & ~7;
+    assert(tex->flags == FMT_I4);
+    assert(parms->tmem_addr >= 0 && parms->tmem_addr + pitch * tex->height <= SOFT_RDP_TMEM_BYTES);
+    
+    for(int y = 0; y < tex->height; y++) {
+        memcpy(tmem + parms->tmem_addr + y * pitch, (const uint8_t*)tex->buffer + y * tex->stride, row_bytes);
+    }
+    tiles[tile].addr = parms->tmem_addr;
+    tiles[tile].pitch = pitch;
+    tiles[tile].width = tex->width;
+    tiles[tile].height = tex->height;
+    return pitch * tex->height;
+}
+
+static float texel(int tile, int s, int t) {
+    s &= tiles[tile].width - 1;
+    t &= tiles[tile].height - 1;
+    uint8_t pair = tmem[tiles[tile].addr + t * tiles[tile].pitch + s / 2];
+    return ((s & 1) ? (pair & 15) : (pair >> 4)) * (1.0f / 15.0f);
+}
+
+// Intensity at (s, t) in texels; bilinear blends the 2x2 texels from the
+// one containing the point, as the RDP does
+static float sample(int tile, float s, float t) {
+    float s0 = floorf(s), t0 = floorf(t);
+    if(!bilinear) return texel(tile, (int)s0, (int)t0);
+    
+    float fs = s - s0, ft = t - t0;
+    int is = (int)s0, it = (int)t0;
+    float top = texel(tile, is, it) * (1.0f - fs) + texel(tile, is + 1, it) * fs;
+    float bottom = texel(tile, is, it + 1) * (1.0f - fs) + texel(tile, is + 1, it + 1) * fs;
+    return top * (1.0f - ft) + bottom * ft;
+}
+
+void rdpq_mode_blender(rdpq_blender_t blend) {
+    (void)blend;
+}
+
+void rdpq_mode_fog(rdpq_blender_t fog) {
+    fog_enabled = (fog == RDPQ_FOG_STANDARD);
+}
+
+// Fog blender: material * shade alpha + fog colour * (1 - shade alpha)
+static color_t fog_blend(color_t color, float alpha) {
+    color_t out;
+    out.r = (uint8_t)(color.r * alpha + fog_color.r * (1.0f - alpha) + 0.5f);
+    out.g = (uint8_t)(color.g * alpha + fog_color.g * (1.0f - alpha) + 0.5f);
+    out.b = (uint8_t)(color.b * alpha + fog_color.b * (1.0f - alpha) + 0.5f);
+    out.a = 255;
+    return out;
+}
+
+void rdpq_fill_rectangle(float x0, float y0, float x1, float y1) {
+    int xs = (int)fmaxf(scissor_x0, ceilf(x0)), xe = (int)fminf(scissor_x1, ceilf(x1));
+    int ys = (int)fmaxf(scissor_y0, ceilf(y0)), ye = (int)fminf(scissor_y1, ceilf(y1));
+    
+    for(int y = ys; y < ye; y++) {
+        if(scissor_field >= 0 && (y & 1) != scissor_field) continue;
+        for(int x = xs; x < xe; x++) {
+            plot(x, y, fill_color);
+        }
+    }
+}
+
+// Edge is "top-left" (owns pixels exactly on it) for a clockwise-normalised triangle
+static int is_top_left(float ax, float ay, float bx, float by) {
+    return (ay == by && bx > ax) || (by < ay);
+}
+
+void rdpq_triangle(const rdpq_trifmt_t* fmt, const float* v1, const float* v2, const float* v3) {
+    const float* a = v1 + fmt->pos_offset;
+    const float* b = v2 + fmt->pos_offset;
+    const float* c = v3 + fmt->pos_offset;
+    
+    // The RDP draws either winding; normalise to positive area
+    float area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+    if(area == 0.0f) return;
+    if(area < 0.0f) {
+        const float* t = b; b = c; c = t;
+        t = v2; v2 = v3; v3 = t;
+        area = -area;
+    }
+    
+    // Shade alpha (fog factor) and RGB (lit combiner) per vertex,
+    // interpolated with barycentrics
+    int fogged = fog_enabled && fmt->shade_offset >= 0;
+    int lit = shade_lit && fmt->shade_offset >= 0;
+    float alpha_a = fogged ? v1[fmt->shade_offset + 3] : 1.0f;
+    float alpha_b = fogged ? v2[fmt->shade_offset + 3] : 1.0f;
+    float alpha_c = fogged ? v3[fmt->shade_offset + 3] : 1.0f;
+    soft_rdp_pass_triangles[render_current_pass]++;
+    
+    // Texture coordinates are interpolated divided by w (1 / inv_w) and
+    // divided back per pixel
+    int mapped = textured && fmt->tex_offset >= 0;
+    float tex[3][3] = { { 0 } };
+    if(mapped) {
+        const float* vs[3] = { v1, v2, v3 };
+        for(int i = 0; i < 3; i++) {
+            float inv_w = perspective ? vs[i][fmt->tex_offset + 2] : 1.0f;
+            tex[i][0] = vs[i][fmt->tex_offset] * inv_w;
+            tex[i][1] = vs[i][fmt->tex_offset + 1] * inv_w;
+            tex[i][2] = inv_w;
+        }
+    }
+    
+    int zmapped = z_compare && fmt->z_offset >= 0;
+    
+    int xs = (int)fmaxf(scissor_x0, floorf(fminf(a[0], fminf(b[0], c[0]))));
+    int xe = (int)fminf(scissor_x1 - 1, ceilf(fmaxf(a[0], fmaxf(b[0], c[0]))));
+    int ys = (int)fmaxf(scissor_y0, floorf(fminf(a[1], fminf(b[1], c[1]))));
+    int ye = (int)fminf(scissor_y1 - 1, ceilf(fmaxf(a[1], fmaxf(b[1], c[1]))));
+    
+    int tl0 = is_top_left(b[0], b[1], c[0], c[1]);
+    int tl1 = is_top_left(c[0], c[1], a[0], a[1]);
+    int tl2 = is_top_left(a[0], a[1], b[0], b[1]);
+    
+    for(int y = ys; y <= ye; y++) {
+        if(scissor_field >= 0 && (y & 1) != scissor_field) continue;
+        float py = y + 0.5f;
+        for(int x = xs; x <= xe; x++) {
+            float px = x + 0.5f;
+            float w0 = (c[0] - b[0]) * (py - b[1]) - (c[1] - b[1]) * (px - b[0]);
+            float w1 = (a[0] - c[0]) * (py - c[1]) - (a[1] - c[1]) * (px - c[0]);
+            float w2 = (b[0] - a[0]) * (py - a[1]) - (b[1] - a[1]) * (px - a[0]);
+            
+            if(w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+            if((w0 == 0.0f && !tl0) || (w1 == 0.0f && !tl1) || (w2 == 0.0f && !tl2)) continue;
+            
+            // Z is interpolated linearly on screen; the pixel is hidden
+            // unless it is at least as near as the stored one
+            if(zmapped) {
+                int i = y * SOFT_RDP_WIDTH + x;
+                float z = (w0 * v1[fmt->z_offset] + w1 * v2[fmt->z_offset] + w2 * v3[fmt->z_offset]) / area;
+                soft_rdp_pass_z_tests[render_current_pass]++;
+                if(z > zbuf[i]) {
+                    soft_rdp_pass_z_rejects[render_current_pass]++;
+                    continue;
+                }
+                if(z_update) zbuf[i] = z;
+            }
+            
+            color_t color = prim_color;
+            if(lit) {
+                for(int ch = 0; ch < 3; ch++) {
+                    float shade = (w0 * v1[fmt->shade_offset + ch] + w1 * v2[fmt->shade_offset + ch] +
+                                   w2 * v3[fmt->shade_offset + ch]) / area;
+                    uint8_t* channel = ch == 0 ? &color.r : ch == 1 ? &color.g : &color.b;
+                    *channel = (uint8_t)(*channel * shade + 0.5f);
+                }
+            }
+            if(mapped) {
+                float inv_w = (w0 * tex[0][2] + w1 * tex[1][2] + w2 * tex[2][2]) / area;
+                float s = (w0 * tex[0][0] + w1 * tex[1][0] + w2 * tex[2][0]) / area / inv_w;
+                float t = (w0 * tex[0][1] + w1 * tex[1][1] + w2 * tex[2][1]) / area / inv_w;
+                float intensity = sample(fmt->tex_tile, s, t);
+                color.r = (uint8_t)(color.r * intensity + 0.5f);
+                color.g = (uint8_t)(color.g * intensity + 0.5f);
+                color.b = (uint8_t)(color.b * intensity + 0.5f);
+            }
+            if(fogged) {
+                float alpha = (w0 * alpha_a + w1 * alpha_b + w2 * alpha_c) / area;
+                plot(x, y, fog_blend(color, alpha));
+            } else {
+                plot(x, y, color);
+            }
+        }
+    }
+}
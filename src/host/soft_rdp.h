@@ -0,0 +1,26 @@
+#ifndef SOFT_RDP_H
+#define SOFT_RDP_H
+
+#include <stdint.h>
+#include "render.h"
+
+// Host replacement for the rdpq calls made by render.c: rasterises into an
+// off-screen 320x240 target and counts writes per pixel and per render pass.
+
+#define SOFT_RDP_WIDTH 320
+#define SOFT_RDP_HEIGHT 240
+#define SOFT_RDP_PIXELS (SOFT_RDP_WIDTH * SOFT_RDP_HEIGHT)
+
+// Per-frame results (reset by soft_rdp_begin_frame)
+extern uint16_t soft_rdp_writes[SOFT_RDP_PIXELS];         // Writes per pixel
+extern color_t soft_rdp_color[SOFT_RDP_PIXELS];           // Final colour per pixel
+extern uint32_t soft_rdp_pass_pixels[RENDER_PASS_COUNT];  // Pixels filled per pass
+extern uint32_t soft_rdp_pass_triangles[RENDER_PASS_COUNT];
+extern uint32_t soft_rdp_pass_z_tests[RENDER_PASS_COUNT];    // Pixels Z-compared (Z read)
+extern uint32_t soft_rdp_pass_z_rejects[RENDER_PASS_COUNT];  // Of which hidden (nothing written)
+extern uint32_t soft_rdp_z_clears;                            // Z pixels cleared (Z written)
+
+// Function prototypes
+void soft_rdp_begin_frame(void);
+
+#endif // SOFT_RDP_H